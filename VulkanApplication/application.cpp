@@ -13,6 +13,7 @@
 // Include modules here
 #include "include/application.hpp"
 #include "include/constants.hpp"
+#include "include/mesh.hpp"
 
 #include <vector>
 #include <iostream>
@@ -126,7 +127,9 @@ void VulkanInstance::createSurface() {
 
 VulkanApplication::VulkanApplication(GLFWwindow* window, 
                                      const std::vector<Vertex>& vertices,
-                                     const std::vector<uint16_t>& indices)
+                                     const std::vector<uint16_t>& indices,
+                                     bool depthPrepass,
+                                     VkSampleCountFlagBits msaaSamples)
     : windowInstance(std::move(window)),
       vertices(vertices),
       indices(indices){
@@ -141,11 +144,18 @@ VulkanApplication::VulkanApplication(GLFWwindow* window,
     vulkanLogicalDevice = std::make_unique<VulkanLogicalDevice>(vulkanPhysicalDevice->getDevice(),
                                                                 validationLayers->getValidationLayers(),
                                                                 vulkanInstanceCreator->getSurface(),
-                                                                deviceExtensions);
+                                                                vulkanPhysicalDevice->getEnabledExtensions());
     allocatorManager = std::make_unique<AllocatorManager>(
         vulkanPhysicalDevice->getDevice(),
         vulkanLogicalDevice->getDevice(),
-        *vulkanInstanceCreator->getInstance());
+        *vulkanInstanceCreator->getInstance(),
+        vulkanLogicalDevice->isMemoryBudgetEnabled());
+    // Warn well before a long session runs a heap out of memory
+    allocatorManager->setBudgetThresholds({0.8f, 0.95f},
+        [](uint32_t heapIndex, const HeapBudget& heap, float threshold) {
+            std::cerr << "Memory heap " << heapIndex << " passed " << threshold * 100.0f << "% of its budget: "
+                      << heap.usage / (1024 * 1024) << " of " << heap.budget / (1024 * 1024) << " MiB in use\n";
+        });
 
     swapChain = std::make_unique<SwapChain>(vulkanLogicalDevice->getDevice(),
                                             vulkanInstanceCreator->getSurface(),
@@ -160,17 +170,50 @@ VulkanApplication::VulkanApplication(GLFWwindow* window,
                                                     *allocatorManager,
                                                     *commandBufferManager.get(),
                                                     vulkanLogicalDevice->getGraphicsQueue());
-    descriptorManager = std::make_unique<DescriptorManager>(vulkanLogicalDevice->getDevice());
-    descriptorManager->createDescriptorSets(bufferManager->getUniformBuffers());
+    descriptorManager = std::make_unique<DescriptorManager>(vulkanLogicalDevice->getDevice(),
+                                                            vulkanPhysicalDevice->getDevice());
+    descriptorAllocator = std::make_unique<DescriptorAllocator>(vulkanLogicalDevice->getDevice());
+    descriptorLayoutCache = std::make_unique<DescriptorLayoutCache>(vulkanLogicalDevice->getDevice());
+    descriptorSetCache = std::make_unique<DescriptorSetCache>(vulkanLogicalDevice->getDevice(),
+                                                              *descriptorAllocator);
+    descriptorBinder = std::make_unique<DescriptorBinder>(*descriptorLayoutCache,
+                                                          *descriptorSetCache,
+                                                          vulkanLogicalDevice->getCmdPushDescriptorSet());
+    drawList = std::make_unique<IndirectDrawList>(*allocatorManager,
+                                                  vulkanLogicalDevice->isMultiDrawIndirectEnabled(),
+                                                  vulkanLogicalDevice->isDrawIndirectCountEnabled(),
+                                                  vulkanLogicalDevice->isDrawIndirectFirstInstanceEnabled());
+    cullingPass = std::make_unique<CullingPass>(vulkanLogicalDevice->getDevice(),
+                                                *allocatorManager,
+                                                *descriptorBinder,
+                                                bufferManager->getUniformBuffers(),
+                                                bufferManager->getMeshRegistry().getMeshletBuffer(),
+                                                vulkanLogicalDevice->isMultiDrawIndirectEnabled(),
+                                                vulkanLogicalDevice->isDrawIndirectCountEnabled(),
+                                                std::string("../../shaders/cull.comp.spv"),
+                                                std::string("../../shaders/cull_meshlets.comp.spv"));
+    assetStreamer = std::make_unique<AssetStreamer>(*allocatorManager,
+                                                    bufferManager->getMeshRegistry());
+    framebufferAttachments = std::make_unique<FramebufferAttachments>(vulkanPhysicalDevice->getDevice(),
+                                                                      swapChain->getSwapChainImageFormat(),
+                                                                      msaaSamples);
+    renderGraph = std::make_unique<RenderGraph>(vulkanLogicalDevice->getDevice(), *allocatorManager);
     graphicsPipeline = std::make_unique<GraphicsPipeline>(vulkanLogicalDevice->getDevice(),
                                                           *swapChain.get(),
                                                           *commandBufferManager.get(),
                                                           *bufferManager.get(),
                                                           *descriptorManager.get(),
+                                                          *drawList.get(),
+                                                          *cullingPass.get(),
+                                                          *assetStreamer.get(),
+                                                          *framebufferAttachments.get(),
+                                                          *renderGraph.get(),
                                                           indices,
                                                           vulkanPhysicalDevice->getDevice(),
                                                           std::string("../../shaders/shader.vert.spv"),
-                                                          std::string("../../shaders/shader.frag.spv"));
+                                                          std::string("../../shaders/shader.frag.spv"),
+                                                          std::string("../../shaders/shader_instanced.vert.spv"),
+                                                          depthPrepass);
     graphicsPipeline->createFrameBuffers(swapChain->getSwapChainImageViews(), 
                                          swapChain->getSwapChainExtent());
     graphicsQueue = this->vulkanLogicalDevice->getGraphicsQueue();
@@ -192,6 +235,23 @@ void VulkanApplication::scrollCallback(GLFWwindow* window, double xoffset, doubl
 }
 // --------------------------------------------------------------------------------
 
+uint32_t VulkanApplication::streamMesh(const std::string& filename) {
+    uint32_t requestId = assetStreamer->requestMesh(filename);
+    streamRequests.push_back(requestId);
+    return requestId;
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::writeMemoryStats(const std::string& filename) const {
+    allocatorManager->writeStatsJson(filename);
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::writeMemoryStatsOnExit(const std::string& filename) {
+    allocatorManager->setExitStatsFile(filename);
+}
+// --------------------------------------------------------------------------------
+
 void VulkanApplication::run() {
     glfwSetScrollCallback(windowInstance, scrollCallback);
     while (!glfwWindowShouldClose(windowInstance)) {
@@ -210,9 +270,18 @@ void VulkanApplication::run() {
 void VulkanApplication::destroyResources() {
 
     commandBufferManager.reset();
+    assetStreamer.reset();
     bufferManager.reset();
-    descriptorManager.reset();
     graphicsPipeline.reset();
+    descriptorManager.reset();
+    renderGraph.reset();
+    framebufferAttachments.reset();
+    cullingPass.reset();
+    descriptorBinder.reset();
+    descriptorSetCache.reset();
+    descriptorLayoutCache.reset();
+    descriptorAllocator.reset();
+    drawList.reset();
     allocatorManager.reset();
     swapChain.reset();
 
@@ -233,6 +302,24 @@ void VulkanApplication::drawFrame() {
     // Wait for the frame to be finished
     commandBufferManager->waitForFences(frameIndex);
     commandBufferManager->resetFences(frameIndex);
+
+    // Release meshes that no frame in flight references anymore
+    bufferManager->getMeshRegistry().processRetiredMeshes();
+
+    // Bindless slots this frame released last time around are no longer read by the GPU
+    descriptorManager->collectReleased(frameIndex);
+    descriptorSetCache->collectRetired(frameIndex);
+    allocatorManager->updateBudgets();
+
+    // Compact long sessions a few passes per frame, each pass idles the queue
+    if (++framesRendered % DEFRAG_CHECK_INTERVAL == 0 && !allocatorManager->isDefragmenting() &&
+        allocatorManager->getMovableFragmentation() > DEFRAG_FRAGMENTATION_THRESHOLD) {
+        allocatorManager->beginDefragmentation();
+    }
+    if (allocatorManager->isDefragmenting()) {
+        allocatorManager->defragment(commandBufferManager->getCommandPool(), graphicsQueue, DEFRAG_TIME_BUDGET);
+    }
+
     uint32_t imageIndex;
     VkResult result = vkAcquireNextImageKHR(device, swapChain->getSwapChain(), UINT64_MAX, 
                                             commandBufferManager->getImageAvailableSemaphore(frameIndex), 
@@ -248,6 +335,21 @@ void VulkanApplication::drawFrame() {
     // Update the uniform buffer with the current image/frame
     updateUniformBuffer(frameIndex);
 
+    // Draw every streamed mesh that has finished uploading, and report the ones that failed
+    const InstanceData streamedInstance = {glm::mat4(1.0f), glm::vec4(1.0f)};
+    for (auto it = streamRequests.begin(); it != streamRequests.end();) {
+        Residency residency = assetStreamer->getResidency(*it);
+        if (residency == Residency::Failed) {
+            std::cerr << assetStreamer->getError(*it) << "\n";
+            it = streamRequests.erase(it);
+            continue;
+        }
+        if (residency == Residency::Resident) {
+            graphicsPipeline->submitCulledInstances(frameIndex, assetStreamer->getMesh(*it), {streamedInstance});
+        }
+        ++it;
+    }
+
     VkCommandBuffer cmdBuffer = commandBufferManager->getCommandBuffer(frameIndex);
 
     vkResetCommandBuffer(cmdBuffer, 0);
@@ -352,7 +454,15 @@ void VulkanApplication::updateUniformBuffer(uint32_t currentImage) {
     ubo.proj = glm::perspective(fov, swapChain->getSwapChainExtent().width / (float)swapChain->getSwapChainExtent().height, 0.1f, 10.0f);
     ubo.proj[1][1] *= -1; // Invert Y-axis for Vulkan
 
+    // Instances submitted this frame pick their level of detail against the same camera
+    graphicsPipeline->setLodCamera(makeLodCamera(ubo.view, ubo.proj,
+                                                 static_cast<float>(swapChain->getSwapChainExtent().height)));
+    graphicsPipeline->setViewProjection(ubo.proj * ubo.view);
+
     memcpy(bufferManager->getUniformBuffersMapped()[currentImage], &ubo, sizeof(ubo));
+
+    // The rotating square is a single draw whose model matrix travels as a push constant
+    graphicsPipeline->submitDraw(currentImage, bufferManager->getInitialMesh(), ubo.model);
 }
 // ================================================================================
 // ================================================================================
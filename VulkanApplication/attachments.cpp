@@ -0,0 +1,104 @@
+// ================================================================================
+// ================================================================================
+// - File:    attachments.cpp
+// - Purpose: This file contains the implementation of the FramebufferAttachments class.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/attachments.hpp"
+
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+
+FramebufferAttachments::FramebufferAttachments(VkPhysicalDevice physicalDevice,
+                                               VkFormat colorFormat,
+                                               VkSampleCountFlagBits requestedSamples)
+    : colorFormat(colorFormat),
+      depthFormat(findDepthFormat(physicalDevice)),
+      samples(findSampleCount(physicalDevice, requestedSamples)) {}
+// --------------------------------------------------------------------------------
+
+VkFormat FramebufferAttachments::getDepthFormat() const {
+    return depthFormat;
+}
+// --------------------------------------------------------------------------------
+
+VkSampleCountFlagBits FramebufferAttachments::getSampleCount() const {
+    return samples;
+}
+// --------------------------------------------------------------------------------
+
+bool FramebufferAttachments::isMultisampled() const {
+    return samples != VK_SAMPLE_COUNT_1_BIT;
+}
+// --------------------------------------------------------------------------------
+
+TransientImageDesc FramebufferAttachments::getDepthImageDesc() const {
+    TransientImageDesc desc;
+    desc.format = depthFormat;
+    desc.samples = samples;
+    desc.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    if (depthFormat != VK_FORMAT_D32_SFLOAT) {
+        desc.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+    return desc;
+}
+// --------------------------------------------------------------------------------
+
+TransientImageDesc FramebufferAttachments::getColorImageDesc() const {
+    if (!isMultisampled()) {
+        throw std::runtime_error("There is no multisampled color image without multisampling!");
+    }
+    TransientImageDesc desc;
+    desc.format = colorFormat;
+    desc.samples = samples;
+    desc.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    return desc;
+}
+// ================================================================================
+
+VkFormat FramebufferAttachments::findDepthFormat(VkPhysicalDevice physicalDevice) {
+    const VkFormat candidates[] = {
+        VK_FORMAT_D32_SFLOAT,
+        VK_FORMAT_D32_SFLOAT_S8_UINT,
+        VK_FORMAT_D24_UNORM_S8_UINT
+    };
+
+    for (VkFormat candidate : candidates) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, candidate, &properties);
+        if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+            return candidate;
+        }
+    }
+    throw std::runtime_error("Failed to find a supported depth format!");
+}
+// --------------------------------------------------------------------------------
+
+VkSampleCountFlagBits FramebufferAttachments::findSampleCount(VkPhysicalDevice physicalDevice,
+                                                              VkSampleCountFlagBits requestedSamples) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    VkSampleCountFlags supported = properties.limits.framebufferColorSampleCounts &
+                                   properties.limits.framebufferDepthSampleCounts;
+
+    // Sample counts are single bits, so step down one power of two at a time
+    for (VkSampleCountFlags count = requestedSamples; count > VK_SAMPLE_COUNT_1_BIT; count >>= 1) {
+        if (supported & count) {
+            return static_cast<VkSampleCountFlagBits>(count);
+        }
+    }
+    return VK_SAMPLE_COUNT_1_BIT;
+}
+// ================================================================================
+// ================================================================================
+// eof
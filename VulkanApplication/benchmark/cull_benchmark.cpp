@@ -0,0 +1,113 @@
+// ================================================================================
+// ================================================================================
+// - File:    cull_benchmark.cpp
+// - Purpose: Measures CpuFrustumCuller over one million bounding spheres for every
+//            supported backend, on one thread and on every hardware thread.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "../include/cpu_culling.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+static constexpr uint32_t OBJECT_COUNT = 1000000;
+static constexpr int WARMUP_FRAMES = 10;
+static constexpr int TIMED_FRAMES = 200;
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Culls the same scene repeatedly and reports the mean time per frame.
+ *
+ * @param culler The culler holding the scene.
+ * @param viewProj The matrix the frustum is taken from.
+ * @param visible Receives the visible indices of the last frame.
+ * @return The mean time of one cull in milliseconds.
+ */
+static double timeCull(CpuFrustumCuller& culler, const glm::mat4& viewProj, std::vector<uint32_t>& visible) {
+    for (int i = 0; i < WARMUP_FRAMES; i++) {
+        culler.cull(viewProj, visible);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < TIMED_FRAMES; i++) {
+        culler.cull(viewProj, visible);
+    }
+    auto stop = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / TIMED_FRAMES;
+}
+// --------------------------------------------------------------------------------
+
+int main() {
+    // Scatter the spheres through a cube around the camera so roughly a tenth is visible
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radius(0.1f, 2.0f);
+    std::vector<glm::vec4> spheres(OBJECT_COUNT);
+    for (glm::vec4& sphere : spheres) {
+        sphere = glm::vec4(position(generator), position(generator), position(generator), radius(generator));
+    }
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f);
+    proj[1][1] *= -1;
+    glm::mat4 viewProj = proj * view;
+
+    const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    const CullBackend backends[] = {CullBackend::Scalar, CullBackend::SSE, CullBackend::AVX2};
+
+    std::cout << "Culling " << OBJECT_COUNT << " spheres, mean of " << TIMED_FRAMES << " frames\n";
+    std::vector<uint32_t> reference;
+    bool mismatch = false;
+    for (uint32_t threads : {1u, hardwareThreads}) {
+        CpuFrustumCuller culler(threads);
+        culler.reserve(OBJECT_COUNT);
+        for (const glm::vec4& sphere : spheres) {
+            culler.addObject(sphere);
+        }
+
+        for (CullBackend backend : backends) {
+            if (!CpuFrustumCuller::isBackendSupported(backend)) {
+                continue;
+            }
+            culler.setBackend(backend);
+
+            std::vector<uint32_t> visible;
+            double milliseconds = timeCull(culler, viewProj, visible);
+            std::cout << std::left << std::setw(8) << CpuFrustumCuller::getBackendName(backend)
+                      << std::right << std::setw(3) << threads << " thread(s): "
+                      << std::fixed << std::setprecision(3) << milliseconds << " ms, "
+                      << visible.size() << " visible\n";
+
+            // Every backend and thread count must agree on the exact visible set
+            if (reference.empty()) {
+                reference = visible;
+            } else if (visible != reference) {
+                std::cerr << "  visible set differs from the scalar single threaded result!\n";
+                mismatch = true;
+            }
+        }
+        if (hardwareThreads == 1) {
+            break;
+        }
+    }
+    return mismatch ? 1 : 0;
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,112 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh_load_benchmark.cpp
+// - Purpose: Measures the throughput of loading a mesh file into a staging sized
+//            buffer through MappedMeshFile, against reading it with a stream.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "../include/mesh_file.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+static constexpr int TIMED_LOADS = 50;
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Maps the file and copies both blobs into the destination, as MeshRegistry does.
+ *
+ * @return The number of bytes copied.
+ */
+static size_t loadMapped(const std::string& filename, std::vector<unsigned char>& staging) {
+    MappedMeshFile file(filename);
+    const MeshFileHeader& header = file.getHeader();
+    memcpy(staging.data(), file.getVertexData(), header.vertexSize);
+    memcpy(staging.data() + header.vertexSize, file.getIndexData(), header.indexSize);
+    return header.vertexSize + header.indexSize;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Reads the blobs into intermediate vectors before copying them into the destination.
+ *
+ * @return The number of bytes copied.
+ */
+static size_t loadStreamed(const std::string& filename, std::vector<unsigned char>& staging) {
+    std::ifstream file(filename, std::ios::binary);
+    MeshFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    std::vector<unsigned char> vertices(header.vertexSize);
+    std::vector<unsigned char> indices(header.indexSize);
+    file.seekg(static_cast<std::streamoff>(header.vertexOffset));
+    file.read(reinterpret_cast<char*>(vertices.data()), static_cast<std::streamsize>(vertices.size()));
+    file.seekg(static_cast<std::streamoff>(header.indexOffset));
+    file.read(reinterpret_cast<char*>(indices.data()), static_cast<std::streamsize>(indices.size()));
+
+    memcpy(staging.data(), vertices.data(), vertices.size());
+    memcpy(staging.data() + vertices.size(), indices.data(), indices.size());
+    return vertices.size() + indices.size();
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Loads the file repeatedly and reports the mean throughput.
+ */
+template <typename LoadFunction>
+static void timeLoads(const char* name, LoadFunction load, const std::string& filename,
+                      std::vector<unsigned char>& staging) {
+    size_t bytes = load(filename, staging);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < TIMED_LOADS; i++) {
+        load(filename, staging);
+    }
+    auto stop = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count() / TIMED_LOADS;
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+              << seconds * 1.0e3 << " ms, " << std::setprecision(1) << bytes / 1.0e6 / seconds << " MB/s\n";
+}
+// --------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <mesh.vmesh>\n";
+        return 1;
+    }
+
+    try {
+        std::vector<unsigned char> staging;
+        {
+            MappedMeshFile file(argv[1]);
+            const MeshFileHeader& header = file.getHeader();
+            staging.resize(header.vertexSize + header.indexSize);
+            std::cout << header.vertexCount << " vertices, " << header.indexCount << " indices, "
+                      << staging.size() / 1.0e6 << " MB of geometry, mean of " << TIMED_LOADS
+                      << " warm loads\n";
+        }
+        timeLoads("mmap", loadMapped, argv[1], staging);
+        timeLoads("ifstream", loadStreamed, argv[1], staging);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,401 @@
+// ================================================================================
+// ================================================================================
+// - File:    cpu_culling.cpp
+// - Purpose: This file contains the implementation of the CpuFrustumCuller class.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/cpu_culling.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CPU_CULLING_X86 1
+#include <immintrin.h>
+#endif
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Tests spheres one at a time.
+ *
+ * @return The number of visible indices written to out.
+ */
+static size_t cullScalar(const Frustum& frustum, const float* x, const float* y, const float* z,
+                         const float* r, uint32_t begin, uint32_t end, uint32_t* out) {
+    size_t count = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        bool visible = true;
+        for (const glm::vec4& plane : frustum.planes) {
+            if (plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w < -r[i]) {
+                visible = false;
+                break;
+            }
+        }
+        if (visible) {
+            out[count++] = i;
+        }
+    }
+    return count;
+}
+// --------------------------------------------------------------------------------
+
+#ifdef CPU_CULLING_X86
+
+/**
+ * @brief Tests four spheres at a time with SSE and finishes the remainder with cullScalar.
+ *
+ * @return The number of visible indices written to out.
+ */
+__attribute__((target("sse2")))
+static size_t cullSSE(const Frustum& frustum, const float* x, const float* y, const float* z,
+                      const float* r, uint32_t begin, uint32_t end, uint32_t* out) {
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++) {
+        planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    size_t count = 0;
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(x + i);
+        __m128 cy = _mm_loadu_ps(y + i);
+        __m128 cz = _mm_loadu_ps(z + i);
+        __m128 negRadius = _mm_xor_ps(_mm_loadu_ps(r + i), signMask);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], cx), _mm_mul_ps(planeY[p], cy)),
+                                         _mm_add_ps(_mm_mul_ps(planeZ[p], cz), planeW[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+
+        // Write the index of every set lane, lowest lane first to keep the output sorted
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+        while (mask != 0) {
+            out[count++] = i + static_cast<uint32_t>(__builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    return count + cullScalar(frustum, x, y, z, r, i, end, out + count);
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Tests eight spheres at a time with AVX2 and finishes the remainder with cullScalar.
+ *
+ * @return The number of visible indices written to out.
+ */
+__attribute__((target("avx2,fma")))
+static size_t cullAVX2(const Frustum& frustum, const float* x, const float* y, const float* z,
+                       const float* r, uint32_t begin, uint32_t end, uint32_t* out) {
+    __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++) {
+        planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+    }
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    size_t count = 0;
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 negRadius = _mm256_xor_ps(_mm256_loadu_ps(r + i), signMask);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            __m256 distance = _mm256_fmadd_ps(planeX[p], cx,
+                              _mm256_fmadd_ps(planeY[p], cy,
+                              _mm256_fmadd_ps(planeZ[p], cz, planeW[p])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+
+        // Write the index of every set lane, lowest lane first to keep the output sorted
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+        while (mask != 0) {
+            out[count++] = i + static_cast<uint32_t>(__builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    return count + cullScalar(frustum, x, y, z, r, i, end, out + count);
+}
+
+#endif /* CPU_CULLING_X86 */
+// ================================================================================
+// ================================================================================
+
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProj) {
+    // GLM matrices are column major, so row i is made of the i-th element of each column
+    auto row = [&viewProj](int i) {
+        return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    };
+
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0);  // Left
+    frustum.planes[1] = row(3) - row(0);  // Right
+    frustum.planes[2] = row(3) + row(1);  // Bottom
+    frustum.planes[3] = row(3) - row(1);  // Top
+    frustum.planes[4] = row(3) + row(2);  // Near
+    frustum.planes[5] = row(3) - row(2);  // Far
+
+    for (glm::vec4& plane : frustum.planes) {
+        plane = plane / glm::length(glm::vec3(plane.x, plane.y, plane.z));
+    }
+    return frustum;
+}
+// --------------------------------------------------------------------------------
+
+glm::vec4 transformSphere(const glm::vec4& sphere, const glm::mat4& transform) {
+    float scale = glm::max(glm::length(glm::vec3(transform[0])),
+                           glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+    glm::vec4 center = transform * glm::vec4(glm::vec3(sphere), 1.0f);
+    return glm::vec4(glm::vec3(center), sphere.w * scale);
+}
+// ================================================================================
+// ================================================================================
+
+
+CpuFrustumCuller::CpuFrustumCuller(uint32_t threadCount)
+    : backend(detectBackend()),
+      threadCount(threadCount) {
+    if (this->threadCount == 0) {
+        this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    chunkResults.resize(this->threadCount);
+    for (uint32_t chunk = 1; chunk < this->threadCount; chunk++) {
+        workers.emplace_back(&CpuFrustumCuller::workerLoop, this, chunk);
+    }
+}
+// --------------------------------------------------------------------------------
+
+CpuFrustumCuller::~CpuFrustumCuller() {
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CpuFrustumCuller::reserve(size_t objectCount) {
+    centerX.reserve(objectCount);
+    centerY.reserve(objectCount);
+    centerZ.reserve(objectCount);
+    radii.reserve(objectCount);
+}
+// --------------------------------------------------------------------------------
+
+uint32_t CpuFrustumCuller::addObject(const glm::vec4& sphere) {
+    centerX.push_back(sphere.x);
+    centerY.push_back(sphere.y);
+    centerZ.push_back(sphere.z);
+    radii.push_back(sphere.w);
+    return static_cast<uint32_t>(radii.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+void CpuFrustumCuller::setObject(uint32_t index, const glm::vec4& sphere) {
+    if (index >= radii.size()) {
+        throw std::out_of_range("Object " + std::to_string(index) + " does not exist!");
+    }
+    centerX[index] = sphere.x;
+    centerY[index] = sphere.y;
+    centerZ[index] = sphere.z;
+    radii[index] = sphere.w;
+}
+// --------------------------------------------------------------------------------
+
+void CpuFrustumCuller::clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radii.clear();
+}
+// --------------------------------------------------------------------------------
+
+size_t CpuFrustumCuller::getObjectCount() const {
+    return radii.size();
+}
+// --------------------------------------------------------------------------------
+
+size_t CpuFrustumCuller::cull(const glm::mat4& viewProj, std::vector<uint32_t>& visible) {
+    return cull(Frustum::fromMatrix(viewProj), visible);
+}
+// --------------------------------------------------------------------------------
+
+size_t CpuFrustumCuller::cull(const Frustum& frustum, std::vector<uint32_t>& visible) {
+    if (workers.empty() || radii.empty()) {
+        cullChunk(frustum, 0);
+        visible.swap(chunkResults[0]);
+        return visible.size();
+    }
+
+    // Release the workers, cull the first chunk on this thread and wait for the rest
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        activeFrustum = &frustum;
+        pendingWorkers = static_cast<uint32_t>(workers.size());
+        workGeneration++;
+    }
+    workReady.notify_all();
+
+    cullChunk(frustum, 0);
+
+    {
+        std::unique_lock<std::mutex> lock(workMutex);
+        workDone.wait(lock, [this] { return pendingWorkers == 0; });
+        activeFrustum = nullptr;
+    }
+
+    // The chunks are contiguous and in order, so concatenating them keeps the indices sorted
+    size_t total = 0;
+    for (const std::vector<uint32_t>& result : chunkResults) {
+        total += result.size();
+    }
+    visible.resize(total);
+    size_t offset = 0;
+    for (const std::vector<uint32_t>& result : chunkResults) {
+        std::copy(result.begin(), result.end(), visible.begin() + offset);
+        offset += result.size();
+    }
+    return total;
+}
+// --------------------------------------------------------------------------------
+
+CullBackend CpuFrustumCuller::getBackend() const {
+    return backend;
+}
+// --------------------------------------------------------------------------------
+
+void CpuFrustumCuller::setBackend(CullBackend backend) {
+    if (!isBackendSupported(backend)) {
+        throw std::invalid_argument(std::string("The ") + getBackendName(backend) +
+                                    " culling backend is not supported by this CPU!");
+    }
+    this->backend = backend;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t CpuFrustumCuller::getThreadCount() const {
+    return threadCount;
+}
+// --------------------------------------------------------------------------------
+
+bool CpuFrustumCuller::isBackendSupported(CullBackend backend) {
+    switch (backend) {
+        case CullBackend::Scalar:
+            return true;
+#ifdef CPU_CULLING_X86
+        case CullBackend::SSE:
+            return __builtin_cpu_supports("sse2");
+        case CullBackend::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+        default:
+            return false;
+    }
+}
+// --------------------------------------------------------------------------------
+
+CullBackend CpuFrustumCuller::detectBackend() {
+    if (isBackendSupported(CullBackend::AVX2)) {
+        return CullBackend::AVX2;
+    }
+    if (isBackendSupported(CullBackend::SSE)) {
+        return CullBackend::SSE;
+    }
+    return CullBackend::Scalar;
+}
+// --------------------------------------------------------------------------------
+
+const char* CpuFrustumCuller::getBackendName(CullBackend backend) {
+    switch (backend) {
+        case CullBackend::Scalar: return "Scalar";
+        case CullBackend::SSE:    return "SSE";
+        case CullBackend::AVX2:   return "AVX2";
+    }
+    return "Unknown";
+}
+// ================================================================================
+
+void CpuFrustumCuller::workerLoop(uint32_t chunk) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        const Frustum* frustum = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(workMutex);
+            workReady.wait(lock, [this, seenGeneration] { return stopping || workGeneration != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = workGeneration;
+            frustum = activeFrustum;
+        }
+
+        cullChunk(*frustum, chunk);
+
+        {
+            std::lock_guard<std::mutex> lock(workMutex);
+            pendingWorkers--;
+        }
+        workDone.notify_one();
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CpuFrustumCuller::cullChunk(const Frustum& frustum, uint32_t chunk) {
+    // Chunks are multiples of eight objects so that only the last one runs the scalar tail
+    const uint32_t objectCount = static_cast<uint32_t>(radii.size());
+    uint32_t chunkSize = (objectCount + threadCount - 1) / threadCount;
+    chunkSize = (chunkSize + 7) & ~7u;
+    uint32_t begin = std::min(objectCount, chunk * chunkSize);
+    uint32_t end = std::min(objectCount, begin + chunkSize);
+
+    // Every object of the chunk may be visible, so the output is sized for all of them
+    std::vector<uint32_t>& result = chunkResults[chunk];
+    result.resize(end - begin);
+
+    size_t count = 0;
+    switch (backend) {
+#ifdef CPU_CULLING_X86
+        case CullBackend::AVX2:
+            count = cullAVX2(frustum, centerX.data(), centerY.data(), centerZ.data(), radii.data(),
+                             begin, end, result.data());
+            break;
+        case CullBackend::SSE:
+            count = cullSSE(frustum, centerX.data(), centerY.data(), centerZ.data(), radii.data(),
+                            begin, end, result.data());
+            break;
+#endif
+        default:
+            count = cullScalar(frustum, centerX.data(), centerY.data(), centerZ.data(), radii.data(),
+                               begin, end, result.data());
+            break;
+    }
+    result.resize(count);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,421 @@
+// ================================================================================
+// ================================================================================
+// - File:    culling.cpp
+// - Purpose: This file contains the implementation of the CullingPass class.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/culling.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Reads a SPIR-V file into a vector of characters.
+ *
+ * @param filename The path to the file.
+ * @return The file content as a vector of characters.
+ */
+static std::vector<char> readShaderFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file " + filename + "!");
+    }
+
+    size_t fileSize = (size_t) file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    return buffer;
+}
+// ================================================================================
+// ================================================================================
+
+
+CullingPass::CullingPass(VkDevice device,
+                         AllocatorManager& allocatorManager,
+                         DescriptorBinder& descriptorBinder,
+                         const std::vector<VkBuffer>& uniformBuffers,
+                         VkBuffer meshletBuffer,
+                         bool multiDrawIndirect,
+                         bool drawIndirectCount,
+                         std::string compFile,
+                         std::string meshletCompFile,
+                         uint32_t maxObjects,
+                         uint32_t maxDraws)
+    : device(device),
+      allocatorManager(allocatorManager),
+      descriptorBinder(descriptorBinder),
+      multiDrawIndirect(multiDrawIndirect),
+      drawIndirectCount(drawIndirectCount),
+      compFile(compFile),
+      meshletCompFile(meshletCompFile),
+      maxObjects(maxObjects),
+      maxDraws(maxDraws) {
+    if (uniformBuffers.size() < MAX_FRAMES_IN_FLIGHT) {
+        throw std::invalid_argument("CullingPass requires one uniform buffer per frame in flight!");
+    }
+
+    try {
+        createBuffers();
+        createDescriptorSets(uniformBuffers, meshletBuffer);
+        createPipelines();
+    } catch (const std::runtime_error&) {
+        destroyResources();
+        throw;
+    }
+}
+// --------------------------------------------------------------------------------
+
+CullingPass::~CullingPass() {
+    destroyResources();
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::addObject(uint32_t frameIndex, const MeshHandle& mesh, const glm::mat4& transform,
+                            uint32_t firstInstance, uint32_t instanceCount) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    uint32_t drawSlots = std::max(mesh.meshletCount, 1u);
+    if (objectCounts[frameIndex] >= maxObjects || drawSlots > maxDraws - drawSlotCounts[frameIndex]) {
+        throw std::runtime_error(std::string("Culling input for frame ") + std::to_string(frameIndex) +
+                                 " is full!");
+    }
+
+    // A uniform scale of the largest axis keeps the sphere conservative under non-uniform scaling
+    glm::vec3 axisScales(glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])),
+                         glm::length(glm::vec3(transform[2])));
+    float scale = glm::max(axisScales.x, glm::max(axisScales.y, axisScales.z));
+    float minScale = glm::min(axisScales.x, glm::min(axisScales.y, axisScales.z));
+    glm::vec4 center = transform * glm::vec4(glm::vec3(mesh.bounds), 1.0f);
+
+    CullObject& object = mappedObjects[frameIndex][objectCounts[frameIndex]];
+    object.sphere = glm::vec4(glm::vec3(center), mesh.bounds.w * scale);
+    for (int row = 0; row < 3; row++) {
+        object.transformRows[row] = glm::vec4(transform[0][row], transform[1][row], transform[2][row],
+                                              transform[3][row]);
+    }
+    object.indexCount = mesh.indexCount;
+    object.instanceCount = instanceCount;
+    object.firstIndex = mesh.firstIndex;
+    object.vertexOffset = mesh.vertexOffset;
+    object.firstInstance = firstInstance;
+    object.firstMeshlet = mesh.firstMeshlet;
+    object.meshletCount = mesh.meshletCount;
+    object.scale = scale;
+
+    // Cones survive rotation and uniform scale, but not shear, non-uniform scale or mirroring
+    constexpr float UNIFORM_SCALE_TOLERANCE = 1.0e-3f;
+    bool uniform = scale - minScale <= UNIFORM_SCALE_TOLERANCE * scale;
+    bool mirrored = glm::dot(glm::cross(glm::vec3(transform[0]), glm::vec3(transform[1])),
+                             glm::vec3(transform[2])) < 0.0f;
+    object.coneCulling = (uniform && !mirrored) ? 1u : 0u;
+
+    objectCounts[frameIndex]++;
+    drawSlotCounts[frameIndex] += drawSlots;
+    if (mesh.meshletCount != 0) {
+        meshletObjectCounts[frameIndex]++;
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::recordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    uint32_t objectCount = getObjectCount(frameIndex);
+    if (objectCount == 0) {
+        return;
+    }
+
+    allocatorManager.flushAllocation(objectAllocations[frameIndex], 0, sizeof(CullObject) * objectCount);
+
+    // Step 1: Reset the visible count, and the commands themselves when the count cannot be read by the draw
+    vkCmdFillBuffer(commandBuffer, countBuffers[frameIndex], 0, sizeof(uint32_t), 0);
+    if (!drawIndirectCount) {
+        vkCmdFillBuffer(commandBuffer, drawBuffers[frameIndex], 0,
+                        sizeof(VkDrawIndexedIndirectCommand) * drawSlotCounts[frameIndex], 0);
+    }
+    const bool cullMeshlets = meshletObjectCounts[frameIndex] != 0;
+    if (cullMeshlets) {
+        // No workgroups until cull.comp lists an object, y and z stay at one
+        MeshletObjectList emptyList{{0, 1, 1}, 0};
+        vkCmdUpdateBuffer(commandBuffer, meshletObjectBuffers[frameIndex], 0, sizeof(emptyList), &emptyList);
+    }
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    // Step 2: Test every object against the frustum and append the survivors
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    descriptorBinder.bind(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, descriptorSetLayout,
+                          descriptorResources[frameIndex]);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &objectCount);
+    vkCmdDispatch(commandBuffer, (objectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+    // Step 3: Test the meshlets of every visible object that has them, one workgroup per object
+    if (cullMeshlets) {
+        VkMemoryBarrier listBarrier{};
+        listBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        listBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        listBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                                    VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                             0, 1, &listBarrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, meshletPipeline);
+        vkCmdDispatchIndirect(commandBuffer, meshletObjectBuffers[frameIndex], 0);
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::setMeshletBuffer(VkBuffer meshletBuffer, uint32_t frameIndex) {
+    VkBuffer current = descriptorResources[0][4].buffer;
+    if (meshletBuffer == current) {
+        return;
+    }
+
+    descriptorBinder.evict(current, frameIndex);
+    for (std::vector<DescriptorResource>& resources : descriptorResources) {
+        resources[4].buffer = meshletBuffer;
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::recordDraws(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    uint32_t drawSlotCount = getDrawSlotCount(frameIndex);
+    if (drawSlotCount == 0) {
+        return;
+    }
+
+    const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    if (drawIndirectCount) {
+        vkCmdDrawIndexedIndirectCount(commandBuffer, drawBuffers[frameIndex], 0,
+                                      countBuffers[frameIndex], 0, drawSlotCount, stride);
+    } else if (multiDrawIndirect) {
+        // Slots past the visible count were zero filled and draw nothing
+        vkCmdDrawIndexedIndirect(commandBuffer, drawBuffers[frameIndex], 0, drawSlotCount, stride);
+    } else {
+        for (uint32_t i = 0; i < drawSlotCount; i++) {
+            vkCmdDrawIndexedIndirect(commandBuffer, drawBuffers[frameIndex],
+                                     static_cast<VkDeviceSize>(i) * stride, 1, stride);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::reset(uint32_t frameIndex) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    objectCounts[frameIndex] = 0;
+    drawSlotCounts[frameIndex] = 0;
+    meshletObjectCounts[frameIndex] = 0;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t CullingPass::getObjectCount(uint32_t frameIndex) const {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    return objectCounts[frameIndex];
+}
+// --------------------------------------------------------------------------------
+
+uint32_t CullingPass::getDrawSlotCount(uint32_t frameIndex) const {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    return drawSlotCounts[frameIndex];
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer CullingPass::getDrawBuffer(uint32_t frameIndex) const {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    return drawBuffers[frameIndex];
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer CullingPass::getCountBuffer(uint32_t frameIndex) const {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    return countBuffers[frameIndex];
+}
+// ================================================================================
+
+void CullingPass::createBuffers() {
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        void* data = nullptr;
+        allocatorManager.createBuffer(sizeof(CullObject) * maxObjects,
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                      MemoryClass::HostWrite,
+                                      objectBuffers[i], objectAllocations[i]);
+        allocatorManager.mapMemory(objectAllocations[i], &data);
+        mappedObjects[i] = static_cast<CullObject*>(data);
+
+        allocatorManager.createBuffer(sizeof(VkDrawIndexedIndirectCommand) * maxDraws,
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      MemoryClass::DeviceLocal,
+                                      drawBuffers[i], drawAllocations[i]);
+
+        allocatorManager.createBuffer(sizeof(uint32_t),
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      MemoryClass::DeviceLocal,
+                                      countBuffers[i], countAllocations[i]);
+
+        allocatorManager.createBuffer(sizeof(MeshletObjectList) + sizeof(uint32_t) * maxObjects,
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      MemoryClass::DeviceLocal,
+                                      meshletObjectBuffers[i], meshletObjectAllocations[i]);
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::createDescriptorSets(const std::vector<VkBuffer>& uniformBuffers, VkBuffer meshletBuffer) {
+    // Binding 0 is the frame's UBO, bindings 1 to 5 are the objects, the commands, the count,
+    // the shared meshlets and the list of visible objects with meshlets
+    std::vector<VkDescriptorSetLayoutBinding> bindings(6);
+    for (uint32_t i = 0; i < bindings.size(); i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorCount = 1;
+        bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    descriptorSetLayout = descriptorBinder.getLayout(bindings);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        const VkBuffer buffers[] = {uniformBuffers[i], objectBuffers[i], drawBuffers[i], countBuffers[i],
+                                    meshletBuffer, meshletObjectBuffers[i]};
+        std::vector<DescriptorResource>& resources = descriptorResources[i];
+        resources.assign(bindings.size(), {});
+        for (uint32_t j = 0; j < resources.size(); j++) {
+            resources[j].binding = j;
+            resources[j].type = bindings[j].descriptorType;
+            resources[j].buffer = buffers[j];
+        }
+        resources[0].range = sizeof(UniformBufferObject);
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::createPipelines() {
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(uint32_t);  // Number of objects to cull
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling pipeline layout!");
+    }
+
+    pipeline = createComputePipeline(compFile);
+    meshletPipeline = createComputePipeline(meshletCompFile);
+}
+// --------------------------------------------------------------------------------
+
+VkPipeline CullingPass::createComputePipeline(const std::string& filename) {
+    auto compShaderCode = readShaderFile(filename);
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = compShaderCode.size();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(compShaderCode.data());
+
+    VkShaderModule compShaderModule;
+    if (vkCreateShaderModule(device, &moduleInfo, nullptr, &compShaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = compShaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+
+    VkPipeline computePipeline;
+    VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline);
+    vkDestroyShaderModule(device, compShaderModule, nullptr);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling compute pipeline from " + filename + "!");
+    }
+    return computePipeline;
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::destroyResources() {
+    if (pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        pipeline = VK_NULL_HANDLE;
+    }
+    if (meshletPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, meshletPipeline, nullptr);
+        meshletPipeline = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+    // Pushed bindings end with their command buffer, but fallback sets refer to these buffers
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (objectBuffers[i] != VK_NULL_HANDLE) {
+            descriptorBinder.evict(objectBuffers[i], static_cast<uint32_t>(i));
+        }
+        descriptorResources[i].clear();
+    }
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (objectBuffers[i] != VK_NULL_HANDLE) {
+            if (mappedObjects[i] != nullptr) {
+                allocatorManager.unmapMemory(objectAllocations[i]);
+                mappedObjects[i] = nullptr;
+            }
+            allocatorManager.destroyBuffer(objectBuffers[i], objectAllocations[i]);
+            objectBuffers[i] = VK_NULL_HANDLE;
+        }
+        if (drawBuffers[i] != VK_NULL_HANDLE) {
+            allocatorManager.destroyBuffer(drawBuffers[i], drawAllocations[i]);
+            drawBuffers[i] = VK_NULL_HANDLE;
+        }
+        if (countBuffers[i] != VK_NULL_HANDLE) {
+            allocatorManager.destroyBuffer(countBuffers[i], countAllocations[i]);
+            countBuffers[i] = VK_NULL_HANDLE;
+        }
+        if (meshletObjectBuffers[i] != VK_NULL_HANDLE) {
+            allocatorManager.destroyBuffer(meshletObjectBuffers[i], meshletObjectAllocations[i]);
+            meshletObjectBuffers[i] = VK_NULL_HANDLE;
+        }
+    }
+}
+// ================================================================================
+// ================================================================================
+// eof
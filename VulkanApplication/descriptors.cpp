@@ -0,0 +1,461 @@
+// ================================================================================
+// ================================================================================
+// - File:    descriptors.cpp
+// - Purpose: This file contains the implementation of the DescriptorAllocator,
+//            DescriptorLayoutCache, DescriptorSetCache and DescriptorBinder classes.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/descriptors.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+// ================================================================================
+// ================================================================================
+
+// Covers the culling sets of one uniform and five storage buffers, and a few images per material
+static const std::vector<DescriptorPoolRatio> DEFAULT_POOL_RATIOS = {
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4.0f},
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f},
+    {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f},
+    {VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0.5f}
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Mixes the hash of a value into a running hash.
+ *
+ * @param seed The running hash.
+ * @param value The value to mix in.
+ */
+template <typename T>
+static void hashCombine(size_t& seed, const T& value) {
+    seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+// ================================================================================
+// ================================================================================
+
+
+/**
+ * @brief Fills one descriptor write per resource, each at array element 0.
+ *
+ * The infos are sized up front so the writes can point into them, and must outlive the writes.
+ *
+ * @param set The destination set, ignored by vkCmdPushDescriptorSetKHR.
+ * @param resources The resources, one per binding.
+ * @param bufferInfos Receives the buffer infos the writes point to.
+ * @param imageInfos Receives the image infos the writes point to.
+ * @param writes Receives the descriptor writes.
+ */
+static void buildDescriptorWrites(VkDescriptorSet set, const std::vector<DescriptorResource>& resources,
+                                  std::vector<VkDescriptorBufferInfo>& bufferInfos,
+                                  std::vector<VkDescriptorImageInfo>& imageInfos,
+                                  std::vector<VkWriteDescriptorSet>& writes) {
+    bufferInfos.assign(resources.size(), {});
+    imageInfos.assign(resources.size(), {});
+    writes.assign(resources.size(), {});
+    for (size_t i = 0; i < resources.size(); i++) {
+        const DescriptorResource& resource = resources[i];
+        VkWriteDescriptorSet& write = writes[i];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = set;
+        write.dstBinding = resource.binding;
+        write.dstArrayElement = 0;
+        write.descriptorType = resource.type;
+        write.descriptorCount = 1;
+
+        if (resource.buffer != VK_NULL_HANDLE) {
+            bufferInfos[i] = {resource.buffer, resource.offset, resource.range};
+            write.pBufferInfo = &bufferInfos[i];
+        } else {
+            imageInfos[i] = {resource.sampler, resource.imageView, resource.imageLayout};
+            write.pImageInfo = &imageInfos[i];
+        }
+    }
+}
+// ================================================================================
+// ================================================================================
+
+bool DescriptorResource::operator==(const DescriptorResource& other) const {
+    return binding == other.binding && type == other.type && buffer == other.buffer &&
+           offset == other.offset && range == other.range && imageView == other.imageView &&
+           sampler == other.sampler && imageLayout == other.imageLayout;
+}
+// ================================================================================
+// ================================================================================
+
+
+DescriptorAllocator::DescriptorAllocator(VkDevice device, std::vector<DescriptorPoolRatio> ratios)
+    : device(device),
+      ratios(ratios.empty() ? DEFAULT_POOL_RATIOS : std::move(ratios)) {}
+// --------------------------------------------------------------------------------
+
+DescriptorAllocator::~DescriptorAllocator() {
+    for (VkDescriptorPool pool : allPools) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    allPools.clear();
+}
+// --------------------------------------------------------------------------------
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout) {
+    if (currentPool == VK_NULL_HANDLE) {
+        currentPool = createPool();
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = currentPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+
+    // A full pool keeps its sets, and the allocation moves on to an empty one.
+    // A set that does not fit a new pool never will, so there is only one retry.
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+        currentPool = createPool();
+        allocInfo.descriptorPool = currentPool;
+        result = vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+    }
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor set!");
+    }
+    return descriptorSet;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t DescriptorAllocator::getPoolCount() const {
+    return static_cast<uint32_t>(allPools.size());
+}
+// ================================================================================
+
+VkDescriptorPool DescriptorAllocator::createPool() {
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    poolSizes.reserve(ratios.size());
+    for (const DescriptorPoolRatio& ratio : ratios) {
+        uint32_t count = std::max(static_cast<uint32_t>(ratio.ratio * nextPoolSets), 1u);
+        poolSizes.push_back({ratio.type, count});
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = nextPoolSets;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor pool!");
+    }
+    allPools.push_back(pool);
+
+    // Workloads that outgrow a pool tend to keep growing, so fewer, larger pools follow
+    nextPoolSets = std::min(nextPoolSets * 2, DESCRIPTOR_POOL_MAX_SETS);
+    return pool;
+}
+// ================================================================================
+// ================================================================================
+
+
+DescriptorLayoutCache::DescriptorLayoutCache(VkDevice device)
+    : device(device) {}
+// --------------------------------------------------------------------------------
+
+DescriptorLayoutCache::~DescriptorLayoutCache() {
+    for (auto& [key, layout] : layouts) {
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+    }
+    layouts.clear();
+}
+// --------------------------------------------------------------------------------
+
+VkDescriptorSetLayout DescriptorLayoutCache::getLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+                                                       VkDescriptorSetLayoutCreateFlags flags,
+                                                       const std::vector<VkDescriptorBindingFlags>& bindingFlags) {
+    if (!bindingFlags.empty() && bindingFlags.size() != bindings.size()) {
+        throw std::invalid_argument("Binding flags must be empty or match the bindings!");
+    }
+
+    // Sort the bindings so that lists written in a different order share a layout
+    LayoutKey key{flags, {}};
+    key.bindings.reserve(bindings.size());
+    for (size_t i = 0; i < bindings.size(); i++) {
+        const VkDescriptorSetLayoutBinding& binding = bindings[i];
+        if (binding.pImmutableSamplers != nullptr) {
+            throw std::invalid_argument("Cached descriptor set layouts cannot use immutable samplers!");
+        }
+        key.bindings.push_back({binding.binding, binding.descriptorType, binding.descriptorCount,
+                                binding.stageFlags, bindingFlags.empty() ? 0 : bindingFlags[i]});
+    }
+    std::sort(key.bindings.begin(), key.bindings.end(),
+              [](const BindingKey& a, const BindingKey& b) { return a.binding < b.binding; });
+    for (size_t i = 1; i < key.bindings.size(); i++) {
+        if (key.bindings[i].binding == key.bindings[i - 1].binding) {
+            throw std::invalid_argument("Descriptor set layout binding " +
+                                        std::to_string(key.bindings[i].binding) + " is repeated!");
+        }
+    }
+
+    auto it = layouts.find(key);
+    if (it != layouts.end()) {
+        return it->second;
+    }
+
+    std::vector<VkDescriptorSetLayoutBinding> sortedBindings(key.bindings.size());
+    std::vector<VkDescriptorBindingFlags> sortedFlags(key.bindings.size());
+    bool anyBindingFlags = false;
+    for (size_t i = 0; i < key.bindings.size(); i++) {
+        sortedBindings[i].binding = key.bindings[i].binding;
+        sortedBindings[i].descriptorType = key.bindings[i].type;
+        sortedBindings[i].descriptorCount = key.bindings[i].count;
+        sortedBindings[i].stageFlags = key.bindings[i].stages;
+        sortedBindings[i].pImmutableSamplers = nullptr;
+        sortedFlags[i] = key.bindings[i].flags;
+        anyBindingFlags = anyBindingFlags || sortedFlags[i] != 0;
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount = static_cast<uint32_t>(sortedFlags.size());
+    flagsInfo.pBindingFlags = sortedFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = anyBindingFlags ? &flagsInfo : nullptr;
+    layoutInfo.flags = flags;
+    layoutInfo.bindingCount = static_cast<uint32_t>(sortedBindings.size());
+    layoutInfo.pBindings = sortedBindings.data();
+
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+    layouts.emplace(std::move(key), layout);
+    return layout;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t DescriptorLayoutCache::getLayoutCount() const {
+    return static_cast<uint32_t>(layouts.size());
+}
+// ================================================================================
+
+bool DescriptorLayoutCache::BindingKey::operator==(const BindingKey& other) const {
+    return binding == other.binding && type == other.type && count == other.count &&
+           stages == other.stages && flags == other.flags;
+}
+// --------------------------------------------------------------------------------
+
+bool DescriptorLayoutCache::LayoutKey::operator==(const LayoutKey& other) const {
+    return flags == other.flags && bindings == other.bindings;
+}
+// --------------------------------------------------------------------------------
+
+size_t DescriptorLayoutCache::LayoutKeyHash::operator()(const LayoutKey& key) const {
+    size_t seed = 0;
+    hashCombine(seed, key.flags);
+    for (const BindingKey& binding : key.bindings) {
+        hashCombine(seed, binding.binding);
+        hashCombine(seed, static_cast<uint32_t>(binding.type));
+        hashCombine(seed, binding.count);
+        hashCombine(seed, binding.stages);
+        hashCombine(seed, binding.flags);
+    }
+    return seed;
+}
+// ================================================================================
+// ================================================================================
+
+
+DescriptorSetCache::DescriptorSetCache(VkDevice device, DescriptorAllocator& descriptorAllocator)
+    : device(device),
+      descriptorAllocator(descriptorAllocator) {}
+// --------------------------------------------------------------------------------
+
+VkDescriptorSet DescriptorSetCache::getSet(VkDescriptorSetLayout layout,
+                                           const std::vector<DescriptorResource>& resources) {
+    SetKey key{layout, resources};
+    std::sort(key.resources.begin(), key.resources.end(),
+              [](const DescriptorResource& a, const DescriptorResource& b) { return a.binding < b.binding; });
+    for (size_t i = 1; i < key.resources.size(); i++) {
+        if (key.resources[i].binding == key.resources[i - 1].binding) {
+            throw std::invalid_argument("Descriptor set binding " + std::to_string(key.resources[i].binding) +
+                                        " is repeated!");
+        }
+    }
+
+    auto it = sets.find(key);
+    if (it != sets.end()) {
+        return it->second;
+    }
+
+    // Rewrite a set that no frame uses anymore before allocating another
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    auto freeIt = freeSets.find(layout);
+    if (freeIt != freeSets.end() && !freeIt->second.empty()) {
+        set = freeIt->second.back();
+        freeIt->second.pop_back();
+    } else {
+        set = descriptorAllocator.allocate(layout);
+    }
+
+    writeSet(set, key.resources);
+    sets.emplace(std::move(key), set);
+    return set;
+}
+// --------------------------------------------------------------------------------
+
+void DescriptorSetCache::evict(VkBuffer buffer, uint32_t frameIndex) {
+    evictIf([buffer](const DescriptorResource& resource) { return resource.buffer == buffer; }, frameIndex);
+}
+// --------------------------------------------------------------------------------
+
+void DescriptorSetCache::evict(VkImageView imageView, uint32_t frameIndex) {
+    evictIf([imageView](const DescriptorResource& resource) { return resource.imageView == imageView; },
+            frameIndex);
+}
+// --------------------------------------------------------------------------------
+
+void DescriptorSetCache::collectRetired(uint32_t frameIndex) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    for (const RetiredSet& retired : retiredSets[frameIndex]) {
+        freeSets[retired.layout].push_back(retired.set);
+    }
+    retiredSets[frameIndex].clear();
+}
+// --------------------------------------------------------------------------------
+
+uint32_t DescriptorSetCache::getSetCount() const {
+    return static_cast<uint32_t>(sets.size());
+}
+// ================================================================================
+
+bool DescriptorSetCache::SetKey::operator==(const SetKey& other) const {
+    return layout == other.layout && resources == other.resources;
+}
+// --------------------------------------------------------------------------------
+
+size_t DescriptorSetCache::SetKeyHash::operator()(const SetKey& key) const {
+    size_t seed = 0;
+    hashCombine(seed, key.layout);
+    for (const DescriptorResource& resource : key.resources) {
+        hashCombine(seed, resource.binding);
+        hashCombine(seed, static_cast<uint32_t>(resource.type));
+        hashCombine(seed, resource.buffer);
+        hashCombine(seed, resource.offset);
+        hashCombine(seed, resource.range);
+        hashCombine(seed, resource.imageView);
+        hashCombine(seed, resource.sampler);
+        hashCombine(seed, static_cast<uint32_t>(resource.imageLayout));
+    }
+    return seed;
+}
+// --------------------------------------------------------------------------------
+
+template <typename Predicate>
+void DescriptorSetCache::evictIf(Predicate refersTo, uint32_t frameIndex) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    for (auto it = sets.begin(); it != sets.end();) {
+        if (std::any_of(it->first.resources.begin(), it->first.resources.end(), refersTo)) {
+            retiredSets[frameIndex].push_back({it->first.layout, it->second});
+            it = sets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void DescriptorSetCache::writeSet(VkDescriptorSet set, const std::vector<DescriptorResource>& resources) {
+    std::vector<VkDescriptorBufferInfo> bufferInfos;
+    std::vector<VkDescriptorImageInfo> imageInfos;
+    std::vector<VkWriteDescriptorSet> descriptorWrites;
+    buildDescriptorWrites(set, resources, bufferInfos, imageInfos, descriptorWrites);
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(),
+                           0, nullptr);
+}
+// ================================================================================
+// ================================================================================
+
+DescriptorBinder::DescriptorBinder(DescriptorLayoutCache& layoutCache,
+                                   DescriptorSetCache& setCache,
+                                   PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet)
+    : layoutCache(layoutCache),
+      setCache(setCache),
+      cmdPushDescriptorSet(cmdPushDescriptorSet) {}
+// --------------------------------------------------------------------------------
+
+VkDescriptorSetLayout DescriptorBinder::getLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+    uint32_t descriptorCount = 0;
+    for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+        descriptorCount += binding.descriptorCount;
+    }
+
+    // Larger layouts could exceed maxPushDescriptors, so they keep using cached sets
+    if (cmdPushDescriptorSet == nullptr || descriptorCount > GUARANTEED_PUSH_DESCRIPTORS) {
+        return layoutCache.getLayout(bindings);
+    }
+    VkDescriptorSetLayout layout =
+        layoutCache.getLayout(bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR);
+    pushLayouts.insert(layout);
+    return layout;
+}
+// --------------------------------------------------------------------------------
+
+void DescriptorBinder::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                            VkPipelineLayout pipelineLayout, uint32_t setIndex, VkDescriptorSetLayout layout,
+                            const std::vector<DescriptorResource>& resources) {
+    if (pushLayouts.count(layout) == 0) {
+        VkDescriptorSet set = setCache.getSet(layout, resources);
+        vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, setIndex, 1, &set, 0, nullptr);
+        return;
+    }
+
+    for (size_t i = 0; i < resources.size(); i++) {
+        for (size_t j = i + 1; j < resources.size(); j++) {
+            if (resources[i].binding == resources[j].binding) {
+                throw std::invalid_argument("Descriptor set binding " + std::to_string(resources[i].binding) +
+                                            " is repeated!");
+            }
+        }
+    }
+
+    std::vector<VkDescriptorBufferInfo> bufferInfos;
+    std::vector<VkDescriptorImageInfo> imageInfos;
+    std::vector<VkWriteDescriptorSet> descriptorWrites;
+    buildDescriptorWrites(VK_NULL_HANDLE, resources, bufferInfos, imageInfos, descriptorWrites);
+    cmdPushDescriptorSet(commandBuffer, bindPoint, pipelineLayout, setIndex,
+                         static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data());
+}
+// --------------------------------------------------------------------------------
+
+void DescriptorBinder::evict(VkBuffer buffer, uint32_t frameIndex) {
+    setCache.evict(buffer, frameIndex);
+}
+// --------------------------------------------------------------------------------
+
+bool DescriptorBinder::usesPushDescriptors() const {
+    return cmdPushDescriptorSet != nullptr;
+}
+// ================================================================================
+// ================================================================================
+// eof
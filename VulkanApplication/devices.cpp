@@ -20,6 +20,7 @@
 #include <set>
 #include <limits>
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 // ================================================================================
 // ================================================================================
@@ -97,11 +98,30 @@ bool VulkanPhysicalDevice::isDeviceSuitable(const VkPhysicalDevice device) const
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
 
-    return indices.isComplete() && extensionsSupported && swapChainAdequate;
+    return indices.isComplete() && extensionsSupported && swapChainAdequate &&
+           checkDescriptorIndexingSupport(device);
+}
+// --------------------------------------------------------------------------------
+
+std::vector<const char*> VulkanPhysicalDevice::getEnabledExtensions() const {
+    VkPhysicalDevice device = getDevice();
+    std::vector<const char*> extensions = deviceExtensions;
+    for (const char* optional : optionalDeviceExtensions) {
+        if (checkDeviceExtensionSupport(device, {optional})) {
+            extensions.push_back(optional);
+        }
+    }
+    return extensions;
 }
 // --------------------------------------------------------------------------------
 
 bool VulkanPhysicalDevice::checkDeviceExtensionSupport(const VkPhysicalDevice& device) const {
+    return checkDeviceExtensionSupport(device, deviceExtensions);
+}
+// --------------------------------------------------------------------------------
+
+bool VulkanPhysicalDevice::checkDeviceExtensionSupport(const VkPhysicalDevice& device,
+                                                       const std::vector<const char*>& extensions) const {
     uint32_t extensionCount;
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 
@@ -113,7 +133,7 @@ bool VulkanPhysicalDevice::checkDeviceExtensionSupport(const VkPhysicalDevice& d
         availableExtensionSet.insert(extension.extensionName);
     }
 
-    for (const char* const& required : deviceExtensions) {  // Use const char* const& to prevent temporary construction
+    for (const char* const& required : extensions) {  // Use const char* const& to prevent temporary construction
         if (availableExtensionSet.find(required) == availableExtensionSet.end()) {
             return false;  // Missing required extension
         }
@@ -121,6 +141,31 @@ bool VulkanPhysicalDevice::checkDeviceExtensionSupport(const VkPhysicalDevice& d
 
     return true;  // All required extensions are supported
 }
+// --------------------------------------------------------------------------------
+
+bool VulkanPhysicalDevice::checkDescriptorIndexingSupport(const VkPhysicalDevice& device) const {
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(device, &deviceProperties);
+    if (deviceProperties.apiVersion < VK_API_VERSION_1_2) {
+        return false;
+    }
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    // The vertex shaders index the frame data array with a push constant
+    return features.features.shaderStorageBufferArrayDynamicIndexing &&
+           vulkan12Features.runtimeDescriptorArray &&
+           vulkan12Features.descriptorBindingPartiallyBound &&
+           vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+           vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+           vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+           vulkan12Features.shaderSampledImageArrayNonUniformIndexing;
+}
 // ================================================================================
 
 int VulkanPhysicalDevice::rateDeviceSuitability(const VkPhysicalDevice device) {
@@ -187,6 +232,34 @@ VkQueue VulkanLogicalDevice::getPresentQueue() const {
 
 // --------------------------------------------------------------------------------
 
+bool VulkanLogicalDevice::isMultiDrawIndirectEnabled() const {
+    return multiDrawIndirectEnabled;
+}
+
+// --------------------------------------------------------------------------------
+
+bool VulkanLogicalDevice::isDrawIndirectFirstInstanceEnabled() const {
+    return drawIndirectFirstInstanceEnabled;
+}
+
+// --------------------------------------------------------------------------------
+
+bool VulkanLogicalDevice::isDrawIndirectCountEnabled() const {
+    return drawIndirectCountEnabled;
+}
+// --------------------------------------------------------------------------------
+
+PFN_vkCmdPushDescriptorSetKHR VulkanLogicalDevice::getCmdPushDescriptorSet() const {
+    return cmdPushDescriptorSet;
+}
+// --------------------------------------------------------------------------------
+
+bool VulkanLogicalDevice::isMemoryBudgetEnabled() const {
+    return memoryBudgetEnabled;
+}
+
+// --------------------------------------------------------------------------------
+
 void VulkanLogicalDevice::createLogicalDevice() {
     QueueFamilyIndices indices = QueueFamily::findQueueFamilies(physicalDevice, surface);
 
@@ -207,13 +280,50 @@ void VulkanLogicalDevice::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures{};
+    // Query the optional features used by the indirect draw path
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+    bool vulkan12Supported = deviceProperties.apiVersion >= VK_API_VERSION_1_2;
+
+    VkPhysicalDeviceVulkan12Features supportedVulkan12Features{};
+    supportedVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = vulkan12Supported ? &supportedVulkan12Features : nullptr;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures);
+
+    // Enable only what the device supports
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.drawIndirectCount = supportedVulkan12Features.drawIndirectCount;
+
+    // Bindless descriptors, which VulkanPhysicalDevice only selects devices for
+    vulkan12Features.descriptorIndexing = supportedVulkan12Features.descriptorIndexing;
+    vulkan12Features.runtimeDescriptorArray = supportedVulkan12Features.runtimeDescriptorArray;
+    vulkan12Features.descriptorBindingPartiallyBound = supportedVulkan12Features.descriptorBindingPartiallyBound;
+    vulkan12Features.descriptorBindingUpdateUnusedWhilePending =
+        supportedVulkan12Features.descriptorBindingUpdateUnusedWhilePending;
+    vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind =
+        supportedVulkan12Features.descriptorBindingStorageBufferUpdateAfterBind;
+    vulkan12Features.descriptorBindingSampledImageUpdateAfterBind =
+        supportedVulkan12Features.descriptorBindingSampledImageUpdateAfterBind;
+    vulkan12Features.shaderSampledImageArrayNonUniformIndexing =
+        supportedVulkan12Features.shaderSampledImageArrayNonUniformIndexing;
+
+    VkPhysicalDeviceFeatures2 deviceFeatures{};
+    deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    deviceFeatures.pNext = vulkan12Supported ? &vulkan12Features : nullptr;
+    deviceFeatures.features.multiDrawIndirect = supportedFeatures.features.multiDrawIndirect;
+    deviceFeatures.features.drawIndirectFirstInstance = supportedFeatures.features.drawIndirectFirstInstance;
+    deviceFeatures.features.shaderStorageBufferArrayDynamicIndexing =
+        supportedFeatures.features.shaderStorageBufferArrayDynamicIndexing;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &deviceFeatures;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
+    createInfo.pEnabledFeatures = nullptr;  // Features are passed through VkPhysicalDeviceFeatures2
 
     createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
     createInfo.ppEnabledExtensionNames = deviceExtensions.data();
@@ -232,6 +342,20 @@ void VulkanLogicalDevice::createLogicalDevice() {
         }
     }
 
+    multiDrawIndirectEnabled = deviceFeatures.features.multiDrawIndirect == VK_TRUE;
+    drawIndirectFirstInstanceEnabled = deviceFeatures.features.drawIndirectFirstInstance == VK_TRUE;
+    drawIndirectCountEnabled = vulkan12Supported && vulkan12Features.drawIndirectCount == VK_TRUE;
+
+    // Extension commands are not exported by the loader and must be fetched from the device
+    for (const char* extension : deviceExtensions) {
+        if (std::strcmp(extension, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME) == 0) {
+            cmdPushDescriptorSet = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+                vkGetDeviceProcAddr(device, "vkCmdPushDescriptorSetKHR"));
+        } else if (std::strcmp(extension, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) {
+            memoryBudgetEnabled = true;
+        }
+    }
+
     {
         std::lock_guard<std::mutex> lock(queueMutex); // Lock while accessing the queues
         vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
@@ -253,6 +377,11 @@ VulkanLogicalDevice::VulkanLogicalDevice(VulkanLogicalDevice&& other) noexcept
     device = other.device;
     graphicsQueue = other.graphicsQueue;
     presentQueue = other.presentQueue;
+    multiDrawIndirectEnabled = other.multiDrawIndirectEnabled;
+    drawIndirectFirstInstanceEnabled = other.drawIndirectFirstInstanceEnabled;
+    drawIndirectCountEnabled = other.drawIndirectCountEnabled;
+    cmdPushDescriptorSet = other.cmdPushDescriptorSet;
+    memoryBudgetEnabled = other.memoryBudgetEnabled;
 
     // Reset the source object
     other.device = VK_NULL_HANDLE;
@@ -277,6 +406,11 @@ VulkanLogicalDevice& VulkanLogicalDevice::operator=(VulkanLogicalDevice&& other)
         validationLayers = std::move(other.validationLayers); // Move the vectors
         deviceExtensions = std::move(other.deviceExtensions);
         surface = other.surface;
+        multiDrawIndirectEnabled = other.multiDrawIndirectEnabled;
+        drawIndirectFirstInstanceEnabled = other.drawIndirectFirstInstanceEnabled;
+        drawIndirectCountEnabled = other.drawIndirectCountEnabled;
+        cmdPushDescriptorSet = other.cmdPushDescriptorSet;
+        memoryBudgetEnabled = other.memoryBudgetEnabled;
 
         // Reset the source object
         other.device = VK_NULL_HANDLE;
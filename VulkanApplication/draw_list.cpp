@@ -0,0 +1,183 @@
+// ================================================================================
+// ================================================================================
+// - File:    draw_list.cpp
+// - Purpose: This file contains the implementation of the IndirectDrawList class.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/draw_list.hpp"
+
+#include <stdexcept>
+#include <string>
+// ================================================================================
+// ================================================================================
+
+
+IndirectDrawList::IndirectDrawList(AllocatorManager& allocatorManager,
+                                   bool multiDrawIndirect,
+                                   bool drawIndirectCount,
+                                   bool drawIndirectFirstInstance,
+                                   uint32_t maxDraws)
+    : allocatorManager(allocatorManager),
+      multiDrawIndirect(multiDrawIndirect),
+      drawIndirectCount(drawIndirectCount),
+      drawIndirectFirstInstance(drawIndirectFirstInstance),
+      maxDraws(maxDraws) {
+    try {
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            void* data = nullptr;
+            allocatorManager.createBuffer(sizeof(VkDrawIndexedIndirectCommand) * maxDraws,
+                                          VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                          MemoryClass::HostWrite,
+                                          indirectBuffers[i], indirectAllocations[i]);
+            allocatorManager.mapMemory(indirectAllocations[i], &data);
+            mappedCommands[i] = static_cast<VkDrawIndexedIndirectCommand*>(data);
+
+            allocatorManager.createBuffer(sizeof(uint32_t),
+                                          VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                          MemoryClass::HostWrite,
+                                          countBuffers[i], countAllocations[i]);
+            allocatorManager.mapMemory(countAllocations[i], &data);
+            mappedCounts[i] = static_cast<uint32_t*>(data);
+            *mappedCounts[i] = 0;
+        }
+    } catch (const std::runtime_error&) {
+        destroyBuffers();
+        throw;
+    }
+}
+// --------------------------------------------------------------------------------
+
+IndirectDrawList::~IndirectDrawList() {
+    destroyBuffers();
+}
+// --------------------------------------------------------------------------------
+
+void IndirectDrawList::addDraw(uint32_t frameIndex, const MeshHandle& mesh, uint32_t instanceCount,
+                               uint32_t firstInstance) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    if (drawCounts[frameIndex] >= maxDraws) {
+        throw std::runtime_error(std::string("Indirect draw list for frame ") + std::to_string(frameIndex) +
+                                 " is full!");
+    }
+    if (firstInstance != 0 && !drawIndirectFirstInstance) {
+        throw std::runtime_error("Device does not support a non-zero firstInstance in indirect draws!");
+    }
+
+    VkDrawIndexedIndirectCommand& command = mappedCommands[frameIndex][drawCounts[frameIndex]];
+    command.indexCount = mesh.indexCount;
+    command.instanceCount = instanceCount;
+    command.firstIndex = mesh.firstIndex;
+    command.vertexOffset = mesh.vertexOffset;
+    command.firstInstance = firstInstance;
+
+    drawCounts[frameIndex]++;
+}
+// --------------------------------------------------------------------------------
+
+void IndirectDrawList::record(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    uint32_t drawCount = getDrawCount(frameIndex);
+    if (drawCount == 0) {
+        return;
+    }
+
+    // Make the CPU written records visible to the device before the frame is submitted
+    *mappedCounts[frameIndex] = drawCount;
+    allocatorManager.flushAllocation(indirectAllocations[frameIndex], 0,
+                                     sizeof(VkDrawIndexedIndirectCommand) * drawCount);
+    allocatorManager.flushAllocation(countAllocations[frameIndex], 0, sizeof(uint32_t));
+
+    const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    if (drawIndirectCount) {
+        vkCmdDrawIndexedIndirectCount(commandBuffer, indirectBuffers[frameIndex], 0,
+                                      countBuffers[frameIndex], 0, drawCount, stride);
+    } else if (multiDrawIndirect) {
+        vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffers[frameIndex], 0, drawCount, stride);
+    } else {
+        for (uint32_t i = 0; i < drawCount; i++) {
+            vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffers[frameIndex],
+                                     static_cast<VkDeviceSize>(i) * stride, 1, stride);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void IndirectDrawList::reset(uint32_t frameIndex) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    drawCounts[frameIndex] = 0;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t IndirectDrawList::getDrawCount(uint32_t frameIndex) const {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    return drawCounts[frameIndex];
+}
+// --------------------------------------------------------------------------------
+
+uint32_t IndirectDrawList::getMaxDraws() const {
+    return maxDraws;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer IndirectDrawList::getIndirectBuffer(uint32_t frameIndex) const {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    return indirectBuffers[frameIndex];
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer IndirectDrawList::getCountBuffer(uint32_t frameIndex) const {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    return countBuffers[frameIndex];
+}
+// --------------------------------------------------------------------------------
+
+bool IndirectDrawList::supportsFirstInstance() const {
+    return drawIndirectFirstInstance;
+}
+// --------------------------------------------------------------------------------
+
+bool IndirectDrawList::supportsDrawCount() const {
+    return drawIndirectCount;
+}
+// ================================================================================
+
+void IndirectDrawList::destroyBuffers() {
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (indirectBuffers[i] != VK_NULL_HANDLE) {
+            if (mappedCommands[i] != nullptr) {
+                allocatorManager.unmapMemory(indirectAllocations[i]);
+                mappedCommands[i] = nullptr;
+            }
+            allocatorManager.destroyBuffer(indirectBuffers[i], indirectAllocations[i]);
+            indirectBuffers[i] = VK_NULL_HANDLE;
+        }
+        if (countBuffers[i] != VK_NULL_HANDLE) {
+            if (mappedCounts[i] != nullptr) {
+                allocatorManager.unmapMemory(countAllocations[i]);
+                mappedCounts[i] = nullptr;
+            }
+            allocatorManager.destroyBuffer(countBuffers[i], countAllocations[i]);
+            countBuffers[i] = VK_NULL_HANDLE;
+        }
+    }
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -14,12 +14,19 @@
 
 #include "include/graphics.hpp"
 #include "include/queues.hpp"
+#include "include/mesh.hpp"
+#include "include/draw_list.hpp"
+#include "include/culling.hpp"
+#include "include/streaming.hpp"
+#include "include/attachments.hpp"
+#include "include/vertex_formats.hpp"
 #include <iostream>
 
 #include <cstring>  // memcpy
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
 // ================================================================================
 // ================================================================================
 
@@ -224,9 +231,7 @@ BufferManager::BufferManager(const std::vector<Vertex>& vertices,
                              AllocatorManager& allocatorManager,
                              CommandBufferManager& commandBufferManager,
                              VkQueue graphicsQueue)
-    : vertices(vertices),
-      indices(indices),
-      allocatorManager(allocatorManager),
+    : allocatorManager(allocatorManager),
       commandBufferManager(commandBufferManager),
      // commandPool(commandPool),
       graphicsQueue(graphicsQueue){
@@ -234,9 +239,12 @@ BufferManager::BufferManager(const std::vector<Vertex>& vertices,
     uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
     uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
-    createVertexBuffer();
-    createIndexBuffer();
+    meshRegistry = std::make_unique<MeshRegistry>(allocatorManager,
+                                                  commandBufferManager.getCommandPool(),
+                                                  graphicsQueue);
+    initialMeshId = meshRegistry->addMesh(vertices, indices).id;
     createUniformBuffers();
+    createInstanceBuffers();
 }
 // --------------------------------------------------------------------------------
 
@@ -253,15 +261,18 @@ BufferManager::~BufferManager() {
         }
     }
 
-    // Clean up vertex buffer
-    if (vertexBuffer != VK_NULL_HANDLE) {
-        allocatorManager.destroyBuffer(vertexBuffer, vertexBufferAllocation);
+    // Clean up instance buffers
+    for (size_t i = 0; i < instanceBuffers.size(); i++) {
+        if (instanceBuffers[i] != VK_NULL_HANDLE) {
+            if (instanceBuffersMapped[i] != nullptr) {
+                allocatorManager.unmapMemory(instanceBuffersMemory[i]);
+            }
+            allocatorManager.destroyBuffer(instanceBuffers[i], instanceBuffersMemory[i]);
+        }
     }
 
-    // Clean up index buffer
-    if (indexBuffer != VK_NULL_HANDLE) {
-        allocatorManager.destroyBuffer(indexBuffer, indexBufferAllocation);
-    }
+    // Clean up the shared vertex and index buffers
+    meshRegistry.reset();
 }
 // --------------------------------------------------------------------------------
 
@@ -284,131 +295,72 @@ void BufferManager::updateUniformBuffer(uint32_t currentFrame, const UniformBuff
 // --------------------------------------------------------------------------------
 
 const VkBuffer BufferManager::getVertexBuffer() const{
-    return vertexBuffer;
+    return meshRegistry->getVertexBuffer();
 }
 // --------------------------------------------------------------------------------
 
 const VkBuffer BufferManager::getIndexBuffer() const {
-    return indexBuffer;
+    return meshRegistry->getIndexBuffer();
 }
 // --------------------------------------------------------------------------------
 
-const std::vector<VkBuffer>& BufferManager::getUniformBuffers() const {
-    return uniformBuffers;
+MeshRegistry& BufferManager::getMeshRegistry() const {
+    return *meshRegistry;
 }
 // --------------------------------------------------------------------------------
 
-const std::vector<void*>& BufferManager::getUniformBuffersMapped() const {
-    return uniformBuffersMapped;
+const MeshHandle& BufferManager::getInitialMesh() const {
+    return meshRegistry->getMesh(initialMeshId);
 }
-// ================================================================================
-
-bool BufferManager::createVertexBuffer() {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-    // Step 1: Create a staging buffer
-    VkBuffer stagingBuffer;
-    VmaAllocation stagingBufferAllocation;
-    try {
-        allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                                      VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer, stagingBufferAllocation);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return false;
-    }
-
-    // Step 2: Map memory and copy vertex data to the staging buffer
-    void* data;
-    try {
-        allocatorManager.mapMemory(stagingBufferAllocation, &data);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        return false;
-    }
-    memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-    allocatorManager.unmapMemory(stagingBufferAllocation);
+// --------------------------------------------------------------------------------
 
-    // Step 3: Create the vertex buffer on the GPU
-    try {
-        allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
-                                      VMA_MEMORY_USAGE_GPU_ONLY, vertexBuffer, vertexBufferAllocation);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        return false;
+uint32_t BufferManager::writeInstances(uint32_t currentFrame, const std::vector<InstanceData>& instances) {
+    if (currentFrame >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index out of bounds.");
     }
 
-    // Step 4: Copy data from the staging buffer to the vertex buffer
-    try {
-        allocatorManager.copyBuffer(stagingBuffer, vertexBuffer, bufferSize, graphicsQueue, commandBufferManager.getCommandPool());
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        allocatorManager.destroyBuffer(vertexBuffer, vertexBufferAllocation);   // Cleanup
-        return false;
+    uint32_t firstInstance = instanceCounts[currentFrame];
+    if (instances.size() > MAX_INSTANCES_PER_FRAME - firstInstance) {
+        throw std::runtime_error(std::string("Instance buffer for frame ") + std::to_string(currentFrame) +
+                                 " cannot hold " + std::to_string(instances.size()) + " more instances!");
     }
 
-    // Step 5: Clean up the staging buffer
-    allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation);
+    InstanceData* mapped = static_cast<InstanceData*>(instanceBuffersMapped[currentFrame]);
+    memcpy(mapped + firstInstance, instances.data(), instances.size() * sizeof(InstanceData));
+    allocatorManager.flushAllocation(instanceBuffersMemory[currentFrame], firstInstance * sizeof(InstanceData),
+                                     instances.size() * sizeof(InstanceData));
+    instanceCounts[currentFrame] += static_cast<uint32_t>(instances.size());
 
-    return true; // Indicate success
+    return firstInstance;
 }
 // --------------------------------------------------------------------------------
 
-bool BufferManager::createIndexBuffer() {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-    // Step 1: Create a staging buffer
-    VkBuffer stagingBuffer;
-    VmaAllocation stagingBufferAllocation;
-    try {
-        allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                                      VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer, stagingBufferAllocation);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return false;
-    }
-
-    // Step 2: Map memory and copy index data to the staging buffer
-    void* data;
-    try {
-        allocatorManager.mapMemory(stagingBufferAllocation, &data);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        return false;
-    }
-    memcpy(data, indices.data(), static_cast<size_t>(bufferSize));
-    allocatorManager.unmapMemory(stagingBufferAllocation);
-
-    // Step 3: Create the index buffer on the GPU
-    try {
-        allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 
-                                      VMA_MEMORY_USAGE_GPU_ONLY, indexBuffer, indexBufferAllocation);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        return false;
+void BufferManager::resetInstances(uint32_t currentFrame) {
+    if (currentFrame >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index out of bounds.");
     }
+    instanceCounts[currentFrame] = 0;
+}
+// --------------------------------------------------------------------------------
 
-    // Step 4: Copy data from the staging buffer to the index buffer
-    try {
-        allocatorManager.copyBuffer(stagingBuffer, indexBuffer, bufferSize, graphicsQueue, commandBufferManager.getCommandPool());
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        allocatorManager.destroyBuffer(indexBuffer, indexBufferAllocation);     // Cleanup
-        return false;
+VkBuffer BufferManager::getInstanceBuffer(uint32_t currentFrame) const {
+    if (currentFrame >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index out of bounds.");
     }
+    return instanceBuffers[currentFrame];
+}
+// --------------------------------------------------------------------------------
 
-    // Step 5: Clean up the staging buffer
-    allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation);
-
-    return true; // Indicate success
+const std::vector<VkBuffer>& BufferManager::getUniformBuffers() const {
+    return uniformBuffers;
 }
 // --------------------------------------------------------------------------------
 
+const std::vector<void*>& BufferManager::getUniformBuffersMapped() const {
+    return uniformBuffersMapped;
+}
+// ================================================================================
+
 bool BufferManager::createUniformBuffers() {
     VkDeviceSize bufferSize = sizeof(UniformBufferObject);
 
@@ -419,9 +371,10 @@ bool BufferManager::createUniformBuffers() {
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         try {
-            // Step 1: Create a uniform buffer for each frame
-            allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-                                          VMA_MEMORY_USAGE_CPU_TO_GPU, 
+            // Step 1: Create a uniform buffer for each frame, also read through the bindless storage buffers
+            allocatorManager.createBuffer(bufferSize,
+                                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                          MemoryClass::Uniform, 
                                           uniformBuffers[i], uniformBuffersMemory[i]);
         } catch (const std::runtime_error& e) {
             std::cerr << "Error: " << e.what() << std::endl;
@@ -447,82 +400,127 @@ bool BufferManager::createUniformBuffers() {
 
     return true; // Indicate success
 }
+// --------------------------------------------------------------------------------
+
+void BufferManager::createInstanceBuffers() {
+    VkDeviceSize bufferSize = sizeof(InstanceData) * MAX_INSTANCES_PER_FRAME;
+
+    instanceBuffers.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    instanceBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    instanceBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT, nullptr);
+    instanceCounts.resize(MAX_FRAMES_IN_FLIGHT, 0);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        // The buffers stay mapped for their whole lifetime, like the uniform buffers
+        allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                      MemoryClass::HostWrite,
+                                      instanceBuffers[i], instanceBuffersMemory[i]);
+        allocatorManager.mapMemory(instanceBuffersMemory[i], &instanceBuffersMapped[i]);
+    }
+}
 // ================================================================================
 // ================================================================================
 
 
-DescriptorManager::DescriptorManager(VkDevice device)
-    : device(device){
-    createDescriptorSetLayout();
-    createDescriptorPool();
-}
+static constexpr VkShaderStageFlags BINDLESS_STAGES =
+    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+static constexpr VkDescriptorType BINDLESS_DESCRIPTOR_TYPES[BINDLESS_TYPE_COUNT] = {
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+    VK_DESCRIPTOR_TYPE_SAMPLER
+};
 // --------------------------------------------------------------------------------
 
-    DescriptorManager::~DescriptorManager() {
-    // Check and clean up descriptor set layout
-    if (descriptorSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
-        descriptorSetLayout = VK_NULL_HANDLE;  // Reset to null handle after destruction
+DescriptorManager::DescriptorManager(VkDevice device, VkPhysicalDevice physicalDevice)
+    : device(device) {
+    selectCapacities(physicalDevice);
+    try {
+        createDescriptorSetLayout();
+        createDescriptorPool();
+        createDescriptorSet();
+    } catch (const std::runtime_error&) {
+        destroyDescriptorObjects();
+        throw;
     }
+}
+// --------------------------------------------------------------------------------
 
-    // Check and clean up descriptor pool (this will automatically free descriptor sets)
-    if (descriptorPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-        descriptorPool = VK_NULL_HANDLE;  // Reset to null handle after destruction
-    }
+DescriptorManager::~DescriptorManager() {
+    destroyDescriptorObjects();
+}
+// --------------------------------------------------------------------------------
+
+uint32_t DescriptorManager::registerStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    uint32_t index = allocateSlot(BindlessType::StorageBuffer);
 
-    // Clear the descriptor sets vector to free any associated memory
-    descriptorSets.clear();
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = offset;
+    bufferInfo.range = range;
+    writeSlot(BindlessType::StorageBuffer, index, &bufferInfo, nullptr);
+    return index;
 }
 // --------------------------------------------------------------------------------
 
-void DescriptorManager::createDescriptorPool() {
-    std::vector<VkDescriptorPoolSize> poolSizes = {
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)},
-    };
+uint32_t DescriptorManager::registerSampledImage(VkImageView imageView, VkImageLayout layout) {
+    uint32_t index = allocateSlot(BindlessType::SampledImage);
 
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageView = imageView;
+    imageInfo.imageLayout = layout;
+    writeSlot(BindlessType::SampledImage, index, nullptr, &imageInfo);
+    return index;
+}
+// --------------------------------------------------------------------------------
 
-    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create descriptor pool!");
-    }
+uint32_t DescriptorManager::registerSampler(VkSampler sampler) {
+    uint32_t index = allocateSlot(BindlessType::Sampler);
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = sampler;
+    writeSlot(BindlessType::Sampler, index, nullptr, &imageInfo);
+    return index;
 }
 // --------------------------------------------------------------------------------
 
-void DescriptorManager::createDescriptorSets(const std::vector<VkBuffer> uniformBuffers) {
-    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-    allocInfo.pSetLayouts = layouts.data();
+void DescriptorManager::release(BindlessType type, uint32_t index, uint32_t frameIndex) {
+    SlotAllocator& allocator = slots[static_cast<uint32_t>(type)];
+    if (index >= allocator.nextSlot) {
+        throw std::out_of_range("Bindless index was never registered!");
+    }
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    allocator.releasedSlots[frameIndex].push_back(index);
+}
+// --------------------------------------------------------------------------------
 
-    descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate descriptor sets!");
+void DescriptorManager::collectReleased(uint32_t frameIndex) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    for (SlotAllocator& allocator : slots) {
+        std::vector<uint32_t>& released = allocator.releasedSlots[frameIndex];
+        allocator.freeSlots.insert(allocator.freeSlots.end(), released.begin(), released.end());
+        released.clear();
     }
+}
+// --------------------------------------------------------------------------------
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        VkDescriptorBufferInfo bufferInfo{};
-        bufferInfo.buffer = uniformBuffers[i];
-        bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(UniformBufferObject);
+void DescriptorManager::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                             VkPipelineLayout pipelineLayout) const {
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+}
+// --------------------------------------------------------------------------------
 
-        VkWriteDescriptorSet descriptorWrite{};
-        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = descriptorSets[i];
-        descriptorWrite.dstBinding = 0;
-        descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pBufferInfo = &bufferInfo;
+uint32_t DescriptorManager::getCapacity(BindlessType type) const {
+    return slots[static_cast<uint32_t>(type)].capacity;
+}
+// --------------------------------------------------------------------------------
 
-        vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
-    }
+uint32_t DescriptorManager::getUsedCount(BindlessType type) const {
+    const SlotAllocator& allocator = slots[static_cast<uint32_t>(type)];
+    return allocator.nextSlot - static_cast<uint32_t>(allocator.freeSlots.size());
 }
 // --------------------------------------------------------------------------------
 
@@ -540,44 +538,153 @@ const VkDescriptorPool& DescriptorManager::getDescriptorPool() const {
 }
 // --------------------------------------------------------------------------------
 
-const std::vector<VkDescriptorSet>& DescriptorManager::getDescriptorSets() const {
-    if (descriptorSets.empty())
-        throw std::runtime_error("Descriptor sets vector is empty!");
-    return descriptorSets;
+const VkDescriptorSet& DescriptorManager::getDescriptorSet() const {
+    if (descriptorSet == VK_NULL_HANDLE)
+        throw std::runtime_error("Descriptor set is not initialized!");
+    return descriptorSet;
 }
-// --------------------------------------------------------------------------------
+// ================================================================================
 
-const VkDescriptorSet& DescriptorManager::getDescriptorSet(uint32_t frameIndex) const {
-    // Bounds checking to prevent out-of-range access
-    if (frameIndex >= descriptorSets.size()) {
-        throw std::out_of_range("Frame index is out of bounds!");
+void DescriptorManager::destroyDescriptorObjects() {
+    // Check and clean up descriptor set layout
+    if (descriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        descriptorSetLayout = VK_NULL_HANDLE;  // Reset to null handle after destruction
     }
-    
-    if (descriptorSets[frameIndex] == VK_NULL_HANDLE) {
-        throw std::runtime_error("Descriptor set for frame " + std::to_string(frameIndex) + " is not initialized!");
+
+    // Check and clean up descriptor pool (this will automatically free the descriptor set)
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;  // Reset to null handle after destruction
     }
+    descriptorSet = VK_NULL_HANDLE;
+}
+// --------------------------------------------------------------------------------
 
-    return descriptorSets[frameIndex];
+void DescriptorManager::selectCapacities(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceVulkan12Properties properties12{};
+    properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &properties12;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    // Every array is visible to each stage, so the per stage limits apply as well as the set limits,
+    // and the three arrays together must stay within the per stage resource limit
+    SlotAllocator& samplers = slots[static_cast<uint32_t>(BindlessType::Sampler)];
+    samplers.capacity = std::min({
+        BINDLESS_SAMPLER_CAPACITY,
+        properties12.maxDescriptorSetUpdateAfterBindSamplers,
+        properties12.maxPerStageDescriptorUpdateAfterBindSamplers,
+        properties12.maxPerStageUpdateAfterBindResources / 4});
+    const uint32_t maxResources = (properties12.maxPerStageUpdateAfterBindResources - samplers.capacity) / 2;
+    slots[static_cast<uint32_t>(BindlessType::StorageBuffer)].capacity = std::min({
+        BINDLESS_STORAGE_BUFFER_CAPACITY,
+        properties12.maxDescriptorSetUpdateAfterBindStorageBuffers,
+        properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+        maxResources});
+    slots[static_cast<uint32_t>(BindlessType::SampledImage)].capacity = std::min({
+        BINDLESS_SAMPLED_IMAGE_CAPACITY,
+        properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+        properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+        maxResources});
 }
-// ================================================================================
+// --------------------------------------------------------------------------------
 
 void DescriptorManager::createDescriptorSetLayout() {
-    VkDescriptorSetLayoutBinding uboLayoutBinding{};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.pImmutableSamplers = nullptr;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    std::array<VkDescriptorSetLayoutBinding, BINDLESS_TYPE_COUNT> bindings{};
+    std::array<VkDescriptorBindingFlags, BINDLESS_TYPE_COUNT> bindingFlags{};
+    for (uint32_t i = 0; i < BINDLESS_TYPE_COUNT; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = BINDLESS_DESCRIPTOR_TYPES[i];
+        bindings[i].descriptorCount = slots[i].capacity;
+        bindings[i].stageFlags = BINDLESS_STAGES;
+        bindings[i].pImmutableSamplers = nullptr;
+
+        // Slots may be written while the set is bound, and unwritten slots are never read
+        bindingFlags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                          VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                          VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    flagsInfo.pBindingFlags = bindingFlags.data();
 
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 1;
-    layoutInfo.pBindings = &uboLayoutBinding;
+    layoutInfo.pNext = &flagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
 
     if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor set layout!");
     } 
 }
+// --------------------------------------------------------------------------------
+
+void DescriptorManager::createDescriptorPool() {
+    std::array<VkDescriptorPoolSize, BINDLESS_TYPE_COUNT> poolSizes{};
+    for (uint32_t i = 0; i < BINDLESS_TYPE_COUNT; i++) {
+        poolSizes[i] = {BINDLESS_DESCRIPTOR_TYPES[i], slots[i].capacity};
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor pool!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+void DescriptorManager::createDescriptorSet() {
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+uint32_t DescriptorManager::allocateSlot(BindlessType type) {
+    SlotAllocator& allocator = slots[static_cast<uint32_t>(type)];
+    if (!allocator.freeSlots.empty()) {
+        uint32_t index = allocator.freeSlots.back();
+        allocator.freeSlots.pop_back();
+        return index;
+    }
+    if (allocator.nextSlot >= allocator.capacity) {
+        throw std::runtime_error("Bindless descriptor array is full!");
+    }
+    return allocator.nextSlot++;
+}
+// --------------------------------------------------------------------------------
+
+void DescriptorManager::writeSlot(BindlessType type, uint32_t index, const VkDescriptorBufferInfo* bufferInfo,
+                                  const VkDescriptorImageInfo* imageInfo) {
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = static_cast<uint32_t>(type);
+    descriptorWrite.dstArrayElement = index;
+    descriptorWrite.descriptorType = BINDLESS_DESCRIPTOR_TYPES[static_cast<uint32_t>(type)];
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = bufferInfo;
+    descriptorWrite.pImageInfo = imageInfo;
+
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+}
 // ================================================================================
 // ================================================================================
 
@@ -586,25 +693,56 @@ GraphicsPipeline::GraphicsPipeline(VkDevice device,
                                    CommandBufferManager& commandBufferManager,
                                    BufferManager& bufferManager,
                                    DescriptorManager& descriptorManager,  // Fixed typo here
+                                   IndirectDrawList& drawList,
+                                   CullingPass& cullingPass,
+                                   AssetStreamer& assetStreamer,
+                                   FramebufferAttachments& attachments,
+                                   RenderGraph& renderGraph,
                                    const std::vector<uint16_t>& indices,
                                    VkPhysicalDevice physicalDevice,
                                    std::string vertFile,
-                                   std::string fragFile)
+                                   std::string fragFile,
+                                   std::string instancedVertFile,
+                                   bool depthPrepass)
     : device(device),
       swapChain(swapChain),
       commandBufferManager(commandBufferManager),
       bufferManager(bufferManager),
       descriptorManager(descriptorManager),  // Correct initialization
+      drawList(drawList),
+      cullingPass(cullingPass),
+      assetStreamer(assetStreamer),
+      attachments(attachments),
+      renderGraph(renderGraph),
       indices(indices),
       physicalDevice(physicalDevice),
       vertFile(vertFile),
-      fragFile(fragFile) {
+      fragFile(fragFile),
+      instancedVertFile(instancedVertFile),
+      depthPrepass(depthPrepass) {
     createRenderPass(swapChain.getSwapChainImageFormat());
     createGraphicsPipeline();
+    buildRenderGraph();
+
+    // The frame data never moves, so each frame keeps its bindless slot for the life of the pipeline
+    const std::vector<VkBuffer>& uniformBuffers = bufferManager.getUniformBuffers();
+    frameDataIndices.fill(INVALID_BINDLESS_INDEX);
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frameDataIndices[i] = descriptorManager.registerStorageBuffer(uniformBuffers[i], 0,
+                                                                      sizeof(UniformBufferObject));
+    }
 }
 // --------------------------------------------------------------------------------
 
 GraphicsPipeline::~GraphicsPipeline() {
+    // The pipeline is only destroyed once the device is idle, so the slots are free right away
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (frameDataIndices[i] != INVALID_BINDLESS_INDEX) {
+            descriptorManager.release(BindlessType::StorageBuffer, frameDataIndices[i], i);
+            descriptorManager.collectReleased(i);
+        }
+    }
+
     // Clean up framebuffers
     for (auto framebuffer : framebuffers) {
         if (framebuffer != VK_NULL_HANDLE) {
@@ -616,6 +754,15 @@ GraphicsPipeline::~GraphicsPipeline() {
     if (graphicsPipeline != VK_NULL_HANDLE) {
         vkDestroyPipeline(device, graphicsPipeline, nullptr);
     }
+    if (instancedPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, instancedPipeline, nullptr);
+    }
+    if (depthPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, depthPipeline, nullptr);
+    }
+    if (instancedDepthPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, instancedDepthPipeline, nullptr);
+    }
     if (pipelineLayout != VK_NULL_HANDLE) {
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
     }
@@ -627,18 +774,25 @@ GraphicsPipeline::~GraphicsPipeline() {
 
 void GraphicsPipeline::createFrameBuffers(const std::vector<VkImageView>& swapChainImageViews, 
                                           VkExtent2D swapChainExtent) {
+    // Compiling creates the depth and multisampled images at the new extent
+    renderGraph.compile(swapChainExtent);
     framebuffers.resize(swapChainImageViews.size());
 
     for (size_t i = 0; i < swapChainImageViews.size(); i++) {
-        VkImageView attachments[] = {
-            swapChainImageViews[i]
-        };
+        // The order matches createRenderPass: color, depth, then the resolve target if multisampled
+        std::vector<VkImageView> imageViews;
+        if (attachments.isMultisampled()) {
+            imageViews = {renderGraph.getImageView(colorImage), renderGraph.getImageView(depthImage),
+                          swapChainImageViews[i]};
+        } else {
+            imageViews = {swapChainImageViews[i], renderGraph.getImageView(depthImage)};
+        }
 
         VkFramebufferCreateInfo framebufferInfo{};
         framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
         framebufferInfo.renderPass = renderPass;
-        framebufferInfo.attachmentCount = 1;
-        framebufferInfo.pAttachments = attachments;
+        framebufferInfo.attachmentCount = static_cast<uint32_t>(imageViews.size());
+        framebufferInfo.pAttachments = imageViews.data();
         framebufferInfo.width = swapChainExtent.width;
         framebufferInfo.height = swapChainExtent.height;
         framebufferInfo.layers = 1;
@@ -669,63 +823,122 @@ void GraphicsPipeline::recordCommandBuffer(uint32_t frameIndex, uint32_t imageIn
                                  std::to_string(frameIndex));
     }
 
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = framebuffers[imageIndex];
+    // The graph records the uploads, culling and scene passes with the barriers between them
+    recordingFrame = frameIndex;
+    recordingImage = imageIndex;
+    renderGraph.setImportedImage(swapChainImage, swapChain.getSwapChainImages()[imageIndex],
+                                 swapChain.getSwapChainImageViews()[imageIndex]);
+    renderGraph.execute(commandBuffer);
 
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = swapChain.getSwapChainExtent();
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
 
-    VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
+    // The queued draws are recorded, so the frame's buffers can be refilled next time
+    instancedDraws[frameIndex].clear();
+    objectDraws[frameIndex].clear();
+    drawList.reset(frameIndex);
+    cullingPass.reset(frameIndex);
+    bufferManager.resetInstances(frameIndex);
+}
+// --------------------------------------------------------------------------------
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+void GraphicsPipeline::submitDraw(uint32_t frameIndex, const MeshHandle& mesh, const glm::mat4& model,
+                                  uint32_t materialId) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    objectDraws[frameIndex].push_back({mesh.indexCount, mesh.firstIndex, mesh.vertexOffset, model, materialId});
+}
+// --------------------------------------------------------------------------------
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+void GraphicsPipeline::submitInstances(uint32_t frameIndex, const MeshHandle& mesh, 
+                                       const std::vector<InstanceData>& instances) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    if (instances.empty()) {
+        return;
+    }
 
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float) swapChain.getSwapChainExtent().width;
-    viewport.height = (float) swapChain.getSwapChainExtent().height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    uint32_t firstInstance = bufferManager.writeInstances(frameIndex, instances);
+    uint32_t instanceCount = static_cast<uint32_t>(instances.size());
 
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = swapChain.getSwapChainExtent();
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    if (drawList.supportsFirstInstance()) {
+        drawList.addDraw(frameIndex, mesh, instanceCount, firstInstance);
+        return;
+    }
 
-    VkBuffer vertexBuffers[] = { bufferManager.getVertexBuffer() };
-    VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffer, bufferManager.getIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
-
-    vkCmdBindDescriptorSets(
-        commandBuffer, 
-        VK_PIPELINE_BIND_POINT_GRAPHICS, 
-        pipelineLayout, 
-        0, 
-        1, 
-        &descriptorManager.getDescriptorSet(frameIndex), 
-        0, 
-        nullptr
-    );
-
-    //vkCmdDraw(commandBuffer, static_cast<uint32_t>(vertices.size()), 1, 0, 0);
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+    InstancedDraw draw{};
+    draw.indexCount = mesh.indexCount;
+    draw.firstIndex = mesh.firstIndex;
+    draw.vertexOffset = mesh.vertexOffset;
+    draw.firstInstance = firstInstance;
+    draw.instanceCount = instanceCount;
+    instancedDraws[frameIndex].push_back(draw);
+}
+// --------------------------------------------------------------------------------
 
-    vkCmdEndRenderPass(commandBuffer);
+void GraphicsPipeline::submitCulledInstances(uint32_t frameIndex, const MeshHandle& mesh,
+                                             const std::vector<InstanceData>& instances) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    if (!drawList.supportsFirstInstance()) {
+        // Without per-object draws the GPU cannot cull, so the CPU tests the same spheres
+        visibleInstances.clear();
+        if (hasViewProjection) {
+            cpuCuller.clear();
+            for (const InstanceData& instance : instances) {
+                cpuCuller.addObject(transformSphere(mesh.bounds, instance.transform));
+            }
+            cpuCuller.cull(viewProjection, visibleInstances);
+        } else {
+            for (uint32_t i = 0; i < instances.size(); i++) {
+                visibleInstances.push_back(i);
+            }
+        }
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
+        // Surviving instances that share a level of detail are drawn together
+        std::array<std::vector<InstanceData>, MAX_MESH_LODS> batches;
+        for (uint32_t i : visibleInstances) {
+            const InstanceData& instance = instances[i];
+            batches[selectLod(mesh.lods.data(), mesh.lodCount, mesh.bounds, instance.transform, lodCamera)]
+                .push_back(instance);
+        }
+        for (uint32_t lod = 0; lod < mesh.lodCount; lod++) {
+            submitInstances(frameIndex, getLodHandle(mesh, lod), batches[lod]);
+        }
+        return;
+    }
+    if (instances.empty()) {
+        return;
+    }
+
+    uint32_t firstInstance = bufferManager.writeInstances(frameIndex, instances);
+    for (uint32_t i = 0; i < instances.size(); i++) {
+        uint32_t lod = selectLod(mesh.lods.data(), mesh.lodCount, mesh.bounds, instances[i].transform, lodCamera);
+        cullingPass.addObject(frameIndex, getLodHandle(mesh, lod), instances[i].transform, firstInstance + i);
     }
 }
 // --------------------------------------------------------------------------------
 
+void GraphicsPipeline::setLodCamera(const LodCamera& camera) {
+    lodCamera = camera;
+}
+// --------------------------------------------------------------------------------
+
+void GraphicsPipeline::setViewProjection(const glm::mat4& viewProj) {
+    viewProjection = viewProj;
+    hasViewProjection = true;
+}
+// --------------------------------------------------------------------------------
+
+bool GraphicsPipeline::isDepthPrepassEnabled() const {
+    return depthPrepass;
+}
+// --------------------------------------------------------------------------------
+
 const VkPipelineLayout& GraphicsPipeline::getPipelineLayout() const {
     if (pipelineLayout == VK_NULL_HANDLE)
         throw std::runtime_error("Graphics pipeline layout is not initialized!");
@@ -813,8 +1026,49 @@ uint32_t GraphicsPipeline::findMemoryType(uint32_t typeFilter, VkMemoryPropertyF
 // --------------------------------------------------------------------------------
 
 void GraphicsPipeline::createGraphicsPipeline() {
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;  // Set to 1 since you have one descriptor set layout
+    pipelineLayoutInfo.pSetLayouts = &descriptorManager.getDescriptorSetLayout();  // Pass the descriptor set layout here
+
+    // Draws find their data through bindless indices and per-draw values pushed as constants
+    VkPushConstantRange pushConstantRange = DrawConstantBlock::getRange(physicalDevice, DRAW_CONSTANT_STAGES);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
 
-    auto vertShaderCode = readFile(vertFile);
+    // The shared vertex buffer stores RenderVertex, not the float Vertex the meshes are authored in
+    constexpr auto bindingDescription = RenderVertex::getBindingDescription();
+    constexpr auto attributeDescriptions = RenderVertex::getAttributeDescriptions();
+
+    std::vector<VkVertexInputBindingDescription> bindings = { bindingDescription };
+    std::vector<VkVertexInputAttributeDescription> attributes(attributeDescriptions.begin(), 
+                                                              attributeDescriptions.end());
+    graphicsPipeline = buildPipeline(vertFile, bindings, attributes);
+    if (depthPrepass) {
+        depthPipeline = buildPipeline(vertFile, bindings, attributes, true);
+    }
+
+    // The instanced pipeline adds a second binding that advances once per instance
+    auto instanceAttributeDescriptions = InstanceData::getAttributeDescriptions();
+    bindings.push_back(InstanceData::getBindingDescription());
+    attributes.insert(attributes.end(), instanceAttributeDescriptions.begin(), instanceAttributeDescriptions.end());
+    instancedPipeline = buildPipeline(instancedVertFile, bindings, attributes);
+    if (depthPrepass) {
+        instancedDepthPipeline = buildPipeline(instancedVertFile, bindings, attributes, true);
+    }
+}
+// --------------------------------------------------------------------------------
+
+VkPipeline GraphicsPipeline::buildPipeline(const std::string& vertexShaderFile,
+                                           const std::vector<VkVertexInputBindingDescription>& bindingDescriptions,
+                                           const std::vector<VkVertexInputAttributeDescription>& attributeDescriptions,
+                                           bool depthOnly) {
+
+    auto vertShaderCode = readFile(vertexShaderFile);
     auto fragShaderCode = readFile(fragFile);
 
     VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
@@ -834,14 +1088,11 @@ void GraphicsPipeline::createGraphicsPipeline() {
 
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
-
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
@@ -867,10 +1118,20 @@ void GraphicsPipeline::createGraphicsPipeline() {
     VkPipelineMultisampleStateCreateInfo multisampling{};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.rasterizationSamples = attachments.getSampleCount();
+
+    // Coplanar geometry passes LESS_OR_EQUAL, so later draws still cover earlier ones at the same depth.
+    // After a pre-pass only the fragments that won it are shaded, and depth is already final.
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = (depthOnly || !depthPrepass) ? VK_TRUE : VK_FALSE;
+    depthStencil.depthCompareOp = (depthPrepass && !depthOnly) ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_LESS_OR_EQUAL;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
 
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.colorWriteMask = depthOnly ? 0 : VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
     colorBlendAttachment.blendEnable = VK_FALSE;
 
     VkPipelineColorBlendStateCreateInfo colorBlending{};
@@ -893,25 +1154,16 @@ void GraphicsPipeline::createGraphicsPipeline() {
     dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
     dynamicState.pDynamicStates = dynamicStates.data();
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;  // Set to 1 since you have one descriptor set layout
-    pipelineLayoutInfo.pSetLayouts = &descriptorManager.getDescriptorSetLayout();  // Pass the descriptor set layout here
-    pipelineLayoutInfo.pushConstantRangeCount = 0;  // No push constants for now
-
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
-
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
+    pipelineInfo.stageCount = depthOnly ? 1 : 2;
     pipelineInfo.pStages = shaderStages;
     pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
     pipelineInfo.pRasterizationState = &rasterizer;
     pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = pipelineLayout;
@@ -919,46 +1171,223 @@ void GraphicsPipeline::createGraphicsPipeline() {
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create graphics pipeline!");
-    }
+    VkPipeline pipeline;
+    VkResult result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
 
     vkDestroyShaderModule(device, fragShaderModule, nullptr);
     vkDestroyShaderModule(device, vertShaderModule, nullptr);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create graphics pipeline!");
+    }
+    return pipeline;
 }
 // // --------------------------------------------------------------------------------
 //
 void GraphicsPipeline::createRenderPass(VkFormat swapChainImageFormat) {
+    // A multisampled color attachment is resolved into the swap chain image and then discarded
+    const bool multisampled = attachments.isMultisampled();
     VkAttachmentDescription colorAttachment{};
     colorAttachment.format = swapChainImageFormat;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.samples = attachments.getSampleCount();
     colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // The render graph moves every attachment into its attachment layout before the pass
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    // Depth never outlives the pass, which lets tile based GPUs skip writing it back to memory
+    VkAttachmentDescription depthAttachment{};
+    depthAttachment.format = attachments.getDepthFormat();
+    depthAttachment.samples = attachments.getSampleCount();
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentReference depthAttachmentRef{};
+    depthAttachmentRef.attachment = 1;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentDescription resolveAttachment{};
+    resolveAttachment.format = swapChainImageFormat;
+    resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    resolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    resolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    resolveAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    resolveAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference resolveAttachmentRef{};
+    resolveAttachmentRef.attachment = 2;
+    resolveAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+    subpass.pResolveAttachments = multisampled ? &resolveAttachmentRef : nullptr;
 
+    std::vector<VkAttachmentDescription> descriptions = {colorAttachment, depthAttachment};
+    if (multisampled) {
+        descriptions.push_back(resolveAttachment);
+    }
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = 1;
-    renderPassInfo.pAttachments = &colorAttachment;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(descriptions.size());
+    renderPassInfo.pAttachments = descriptions.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
+    // The render graph's barriers order the attachments against the previous frame, so the
+    // pass needs no external dependency of its own
+    renderPassInfo.dependencyCount = 0;
 
     if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
             throw std::runtime_error("failed to create render pass!");
     }
 }
+// --------------------------------------------------------------------------------
+
+void GraphicsPipeline::recordDraws(VkCommandBuffer commandBuffer, uint32_t frameIndex, bool depthOnly) {
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      depthOnly ? depthPipeline : graphicsPipeline);
+
+    // Single draws only differ in their push constants, so nothing else changes between them
+    DrawConstants drawConstants{};
+    drawConstants.frameData = frameDataIndices[frameIndex];
+    const std::vector<ObjectDraw>& objects = objectDraws[frameIndex];
+    for (uint32_t i = 0; i < objects.size(); i++) {
+        const ObjectDraw& draw = objects[i];
+        drawConstants.model = draw.model;
+        drawConstants.objectIndex = i;
+        drawConstants.materialId = draw.materialId;
+        DrawConstantBlock::push(commandBuffer, pipelineLayout, DRAW_CONSTANT_STAGES, drawConstants);
+        vkCmdDrawIndexed(commandBuffer, draw.indexCount, 1, draw.firstIndex, draw.vertexOffset, 0);
+    }
+
+    // Every queued instanced draw shares the instanced pipeline and the frame's instance buffer
+    const std::vector<InstancedDraw>& draws = instancedDraws[frameIndex];
+    if (!draws.empty() || drawList.getDrawCount(frameIndex) > 0 || cullingPass.getObjectCount(frameIndex) > 0) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          depthOnly ? instancedDepthPipeline : instancedPipeline);
+
+        // Instances carry their own transforms, so the pushed model matrix is left at identity
+        drawConstants.model = glm::mat4(1.0f);
+        drawConstants.objectIndex = 0;
+        drawConstants.materialId = 0;
+        DrawConstantBlock::push(commandBuffer, pipelineLayout, DRAW_CONSTANT_STAGES, drawConstants);
+
+        VkBuffer instanceBuffers[] = { bufferManager.getInstanceBuffer(frameIndex) };
+        VkDeviceSize instanceOffsets[] = { 0 };
+        vkCmdBindVertexBuffers(commandBuffer, 1, 1, instanceBuffers, instanceOffsets);
+
+        for (const InstancedDraw& draw : draws) {
+            vkCmdDrawIndexed(commandBuffer, draw.indexCount, draw.instanceCount,
+                             draw.firstIndex, draw.vertexOffset, draw.firstInstance);
+        }
+
+        // All indirect draws are replayed by a single call regardless of their number
+        drawList.record(commandBuffer, frameIndex);
+        cullingPass.recordDraws(commandBuffer, frameIndex);
+    }
+}
+// --------------------------------------------------------------------------------
+
+void GraphicsPipeline::buildRenderGraph() {
+    // The acquire semaphore is waited on at color attachment output, so the first transition waits there too
+    RenderGraphState acquired{VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED};
+    RenderGraphState presented{VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR};
+    swapChainImage = renderGraph.importImage("swap chain image", VK_IMAGE_ASPECT_COLOR_BIT, acquired, presented);
+    RenderGraphResource meshData = renderGraph.importBuffer("mesh registry");
+    RenderGraphResource drawCommands = renderGraph.importBuffer("culled draw commands");
+    renderGraph.markOutput(swapChainImage);
+
+    // Depth and the multisampled color image only live inside the scene pass
+    depthImage = renderGraph.createImage("depth", attachments.getDepthImageDesc());
+    std::vector<RenderGraphUse> sceneUses = {{meshData, RenderGraphAccess::VertexInputRead},
+                                             {drawCommands, RenderGraphAccess::IndirectRead},
+                                             {depthImage, RenderGraphAccess::DepthAttachmentWrite},
+                                             {swapChainImage, RenderGraphAccess::ColorAttachmentWrite}};
+    if (attachments.isMultisampled()) {
+        colorImage = renderGraph.createImage("multisampled color", attachments.getColorImageDesc());
+        sceneUses.push_back({colorImage, RenderGraphAccess::ColorAttachmentWrite});
+    }
+
+    renderGraph.addPass("upload", {{meshData, RenderGraphAccess::TransferWrite}},
+                        [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                            assetStreamer.recordUploads(commandBuffer, recordingFrame);
+                        });
+
+    // Meshlet culling reads the streamed meshlets
+    renderGraph.addPass("cull", {{meshData, RenderGraphAccess::ComputeStorageRead},
+                                 {drawCommands, RenderGraphAccess::ComputeStorageWrite}},
+                        [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                            cullingPass.setMeshletBuffer(bufferManager.getMeshRegistry().getMeshletBuffer(),
+                                                         recordingFrame);
+                            cullingPass.recordCull(commandBuffer, recordingFrame);
+                        });
+
+    renderGraph.addPass("scene", sceneUses,
+                        [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+                            recordScene(commandBuffer, recordingFrame, recordingImage);
+                        });
+}
+// --------------------------------------------------------------------------------
+
+void GraphicsPipeline::recordScene(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex) {
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = renderPass;
+    renderPassInfo.framebuffer = framebuffers[imageIndex];
+
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = swapChain.getSwapChainExtent();
+
+    std::array<VkClearValue, 2> clearValues{};
+    clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+    clearValues[1].depthStencil = {1.0f, 0};
+    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    renderPassInfo.pClearValues = clearValues.data();
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float) swapChain.getSwapChainExtent().width;
+    viewport.height = (float) swapChain.getSwapChainExtent().height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = swapChain.getSwapChainExtent();
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    bufferManager.getMeshRegistry().bind(commandBuffer);
+
+    // One set serves every draw; the frame only changes the index it reads its matrices at
+    descriptorManager.bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout);
+
+    // The pre-pass resolves visibility so the shading pass runs the fragment shader once per pixel
+    if (depthPrepass) {
+        recordDraws(commandBuffer, frameIndex, true);
+    }
+    recordDraws(commandBuffer, frameIndex, false);
+
+    vkCmdEndRenderPass(commandBuffer);
+}
 // ================================================================================
 // ================================================================================
 // eof
@@ -22,6 +22,12 @@
 #include "memory.hpp"
 //#include "graphics_pipeline.hpp"
 #include "graphics.hpp"
+#include "draw_list.hpp"
+#include "descriptors.hpp"
+#include "culling.hpp"
+#include "streaming.hpp"
+#include "attachments.hpp"
+#include "render_graph.hpp"
 #include "devices.hpp"
 
 #include <memory>
@@ -98,10 +104,15 @@ public:
      * 
      * @param window A reference to a Window object that the application will use.
      * @param vertices A vector of Vertex objects
+     * @param indices The index data of the initial mesh
+     * @param depthPrepass True to lay down depth in a separate pass before shading
+     * @param msaaSamples The preferred MSAA sample count, lowered to what the device supports
      */
     VulkanApplication(GLFWwindow* window, 
                       const std::vector<Vertex>& vertices,
-                      const std::vector<uint16_t>& indices);
+                      const std::vector<uint16_t>& indices,
+                      bool depthPrepass = false,
+                      VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_4_BIT);
 // --------------------------------------------------------------------------------
 
     /**
@@ -120,6 +131,37 @@ public:
 // --------------------------------------------------------------------------------
 
     void setFramebufferResized(bool resized) { framebufferResized = resized; }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Streams a mesh file in the background and draws it once it is resident.
+     *
+     * Rendering starts immediately, and the mesh appears on the first frame after
+     * its upload completes.
+     *
+     * @param filename The path to a mesh file written by MeshConverter.
+     * @return The request identifier of the mesh in the AssetStreamer.
+     */
+    uint32_t streamMesh(const std::string& filename);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes the JSON memory stats of the allocator to a file now.
+     *
+     * @param filename The path of the file to write.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void writeMemoryStats(const std::string& filename) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes the JSON memory stats to a file on exit, after every resource was released.
+     *
+     * Allocations still listed in the file were leaked.
+     *
+     * @param filename The path of the file to write.
+     */
+    void writeMemoryStatsOnExit(const std::string& filename);
 // ================================================================================
 private:
 
@@ -132,15 +174,26 @@ private:
     std::unique_ptr<CommandBufferManager> commandBufferManager;
     std::unique_ptr<BufferManager> bufferManager;
     std::unique_ptr<DescriptorManager> descriptorManager;
+    std::unique_ptr<DescriptorAllocator> descriptorAllocator;
+    std::unique_ptr<DescriptorLayoutCache> descriptorLayoutCache;
+    std::unique_ptr<DescriptorSetCache> descriptorSetCache;
+    std::unique_ptr<DescriptorBinder> descriptorBinder;
+    std::unique_ptr<IndirectDrawList> drawList;
+    std::unique_ptr<CullingPass> cullingPass;
+    std::unique_ptr<AssetStreamer> assetStreamer;
+    std::unique_ptr<FramebufferAttachments> framebufferAttachments;
+    std::unique_ptr<RenderGraph> renderGraph;
     std::unique_ptr<GraphicsPipeline> graphicsPipeline;
 
     std::vector<Vertex> vertices;
     std::vector<uint16_t> indices;
+    std::vector<uint32_t> streamRequests;
     VkQueue graphicsQueue; // = VK_NULL_HANDLE;
     VkQueue presentQueue; // = VK_NULL_HANDLE;
 
     std::unique_ptr<AllocatorManager> allocatorManager;
     uint32_t currentFrame = 0;
+    uint64_t framesRendered = 0;
     bool framebufferResized = false; 
 // --------------------------------------------------------------------------------
 
@@ -0,0 +1,126 @@
+// ================================================================================
+// ================================================================================
+// - File:    attachments.hpp
+// - Purpose: This file contains the formats and sample count of the multisampled
+//            color and depth attachments that the render graph creates.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef attachments_HPP
+#define attachments_HPP
+
+#include <vulkan/vulkan.h>
+
+#include "render_graph.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class FramebufferAttachments
+ * @brief Chooses the intermediate images that every framebuffer of the swap chain renders into.
+ *
+ * The depth image always exists. Its format is the first of D32_SFLOAT, D32_SFLOAT_S8_UINT
+ * and D24_UNORM_S8_UINT that the physical device supports as an optimally tiled depth
+ * attachment. When more than one sample is used, a multisampled color image is added as
+ * well and resolved into the swap chain image at the end of the render pass.
+ *
+ * The images themselves are transient images of the RenderGraph, declared from the
+ * descriptions this class returns. Both are cleared at the start of the render pass and
+ * discarded at its end, so the graph creates them as transient attachments in lazily
+ * allocated memory where the device offers it, and again whenever it is compiled for a
+ * new swap chain extent.
+ */
+class FramebufferAttachments {
+public:
+    /**
+     * @brief Constructor for FramebufferAttachments.
+     *
+     * @param physicalDevice The Vulkan physical device handle whose format support and limits are queried.
+     * @param colorFormat The format of the swap chain images the color attachment resolves into.
+     * @param requestedSamples The preferred sample count, lowered to the largest one the device supports.
+     * @throws std::runtime_error If the device supports none of the depth formats.
+     */
+    FramebufferAttachments(VkPhysicalDevice physicalDevice,
+                           VkFormat colorFormat,
+                           VkSampleCountFlagBits requestedSamples);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the depth format selected for the physical device.
+     *
+     * @return The format of the depth image.
+     */
+    VkFormat getDepthFormat() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the sample count of the color and depth attachments.
+     *
+     * @return The selected sample count, VK_SAMPLE_COUNT_1_BIT if multisampling is off.
+     */
+    VkSampleCountFlagBits getSampleCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if the render pass draws into a multisampled color image that is resolved.
+     *
+     * @return True if the sample count is greater than one.
+     */
+    bool isMultisampled() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Describes the depth image for RenderGraph::createImage.
+     *
+     * @return A description with the depth format, the sample count and the swap chain extent.
+     */
+    TransientImageDesc getDepthImageDesc() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Describes the multisampled color image for RenderGraph::createImage.
+     *
+     * @return A description with the swap chain format, the sample count and the swap chain extent.
+     * @throws std::runtime_error If multisampling is off.
+     */
+    TransientImageDesc getColorImageDesc() const;
+// ================================================================================
+private:
+    VkFormat colorFormat;                         /**< Format of the multisampled color image. */
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;   /**< Depth format selected for the physical device. */
+    VkSampleCountFlagBits samples;                /**< Sample count of both images. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Picks the first candidate depth format usable as an optimally tiled attachment.
+     *
+     * @param physicalDevice The Vulkan physical device handle.
+     * @return The selected format.
+     * @throws std::runtime_error If no candidate is supported.
+     */
+    static VkFormat findDepthFormat(VkPhysicalDevice physicalDevice);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Lowers a requested sample count to the largest one color and depth framebuffers support.
+     *
+     * @param physicalDevice The Vulkan physical device handle.
+     * @param requestedSamples The preferred sample count.
+     * @return The selected sample count.
+     */
+    static VkSampleCountFlagBits findSampleCount(VkPhysicalDevice physicalDevice,
+                                                 VkSampleCountFlagBits requestedSamples);
+};
+// ================================================================================
+// ================================================================================
+#endif /* attachments_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,269 @@
+// ================================================================================
+// ================================================================================
+// - File:    cpu_culling.hpp
+// - Purpose: This file contains a CPU frustum culler that tests bounding spheres
+//            stored in structure of arrays form with SSE or AVX2 instructions.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef cpu_culling_HPP
+#define cpu_culling_HPP
+
+#include <glm/glm.hpp>
+#include <array>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Instruction set used by CpuFrustumCuller to test spheres.
+ */
+enum class CullBackend {
+    Scalar,  /**< One sphere at a time, available on every CPU. */
+    SSE,     /**< Four spheres at a time with SSE. */
+    AVX2     /**< Eight spheres at a time with AVX2. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct Frustum
+ * @brief The six world space planes of a view frustum.
+ *
+ * Each plane stores its normal in xyz and its distance in w, normalized so that
+ * dot(normal, point) + w is the signed distance of a point to the plane, positive
+ * on the inside of the frustum.
+ */
+struct Frustum {
+    std::array<glm::vec4, 6> planes;  /**< Left, right, bottom, top, near and far planes. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Extracts the frustum planes from a combined projection and view matrix.
+     *
+     * The near plane is taken from the OpenGL depth range, which also bounds the
+     * Vulkan depth range, so the test stays conservative whichever one the
+     * projection matrix was built for.
+     *
+     * @param viewProj The product ubo.proj * ubo.view.
+     * @return The normalized frustum planes.
+     */
+    static Frustum fromMatrix(const glm::mat4& viewProj);
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Moves a model space bounding sphere to world space.
+ *
+ * The radius is scaled by the longest axis of the transform, which keeps the sphere
+ * conservative under non-uniform scaling.
+ *
+ * @param sphere The model space sphere, center in xyz and radius in w.
+ * @param transform The model to world transform.
+ * @return The world space sphere.
+ */
+glm::vec4 transformSphere(const glm::vec4& sphere, const glm::mat4& transform);
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class CpuFrustumCuller
+ * @brief Culls bounding spheres against a view frustum on the CPU.
+ *
+ * Sphere centers and radii are kept in four separate arrays so that a SIMD
+ * register can be filled with the same component of consecutive spheres by a
+ * single load. The widest instruction set supported by the running CPU is chosen
+ * at construction, so a binary built for a generic target still uses AVX2 where
+ * it exists. The objects can be split across worker threads, which are started
+ * once and reused by every call to cull. The indices of the visible spheres are
+ * always returned in ascending order, whichever backend or thread count is used.
+ */
+class CpuFrustumCuller {
+public:
+    /**
+     * @brief Constructor for CpuFrustumCuller.
+     *
+     * @param threadCount The number of threads that cull, including the calling thread.
+     *                    Zero selects one thread per hardware thread.
+     */
+    explicit CpuFrustumCuller(uint32_t threadCount = 1);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destructor for CpuFrustumCuller.
+     *
+     * Stops and joins the worker threads.
+     */
+    ~CpuFrustumCuller();
+// --------------------------------------------------------------------------------
+
+    CpuFrustumCuller(const CpuFrustumCuller&) = delete;
+    CpuFrustumCuller& operator=(const CpuFrustumCuller&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reserves storage for a number of objects.
+     *
+     * @param objectCount The number of objects to reserve storage for.
+     */
+    void reserve(size_t objectCount);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Appends a bounding sphere.
+     *
+     * @param sphere The world space sphere, center in xyz and radius in w.
+     * @return The index of the object, which is reported by cull when it is visible.
+     */
+    uint32_t addObject(const glm::vec4& sphere);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Replaces the bounding sphere of an object, e.g. after it moved.
+     *
+     * @param index The index returned by addObject.
+     * @param sphere The world space sphere, center in xyz and radius in w.
+     * @throws std::out_of_range If the index does not refer to an object.
+     */
+    void setObject(uint32_t index, const glm::vec4& sphere);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Removes every object.
+     */
+    void clear();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of objects.
+     *
+     * @return The number of bounding spheres.
+     */
+    size_t getObjectCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Tests every object against the frustum of a matrix.
+     *
+     * @param viewProj The product ubo.proj * ubo.view.
+     * @param visible Receives the ascending indices of the visible objects. Its previous
+     *                contents are replaced.
+     * @return The number of visible objects.
+     */
+    size_t cull(const glm::mat4& viewProj, std::vector<uint32_t>& visible);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Tests every object against a frustum.
+     *
+     * @param frustum The frustum to test against.
+     * @param visible Receives the ascending indices of the visible objects. Its previous
+     *                contents are replaced.
+     * @return The number of visible objects.
+     */
+    size_t cull(const Frustum& frustum, std::vector<uint32_t>& visible);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the backend used by cull.
+     *
+     * @return The active backend.
+     */
+    CullBackend getBackend() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Overrides the backend used by cull, e.g. to compare backends.
+     *
+     * @param backend The backend to use.
+     * @throws std::invalid_argument If the running CPU does not support the backend.
+     */
+    void setBackend(CullBackend backend);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of threads that cull, including the calling thread.
+     *
+     * @return The thread count.
+     */
+    uint32_t getThreadCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if the running CPU supports a backend.
+     *
+     * @param backend The backend to check.
+     * @return True if the backend can be used.
+     */
+    static bool isBackendSupported(CullBackend backend);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Selects the widest backend the running CPU supports.
+     *
+     * @return The best available backend.
+     */
+    static CullBackend detectBackend();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves a printable name of a backend.
+     *
+     * @param backend The backend.
+     * @return The name of the backend.
+     */
+    static const char* getBackendName(CullBackend backend);
+// ================================================================================
+private:
+    std::vector<float> centerX;                /**< X coordinates of the sphere centers. */
+    std::vector<float> centerY;                /**< Y coordinates of the sphere centers. */
+    std::vector<float> centerZ;                /**< Z coordinates of the sphere centers. */
+    std::vector<float> radii;                  /**< Radii of the spheres. */
+    CullBackend backend;                       /**< Instruction set used to test spheres. */
+    uint32_t threadCount;                      /**< Number of threads that cull, including the caller. */
+
+    std::vector<std::thread> workers;          /**< Worker threads, one less than threadCount. */
+    std::vector<std::vector<uint32_t>> chunkResults; /**< Visible indices found by each thread. */
+    std::mutex workMutex;                      /**< Guards the work generation and completion count. */
+    std::condition_variable workReady;         /**< Wakes the workers when a new cull starts. */
+    std::condition_variable workDone;          /**< Wakes the caller when a worker finishes. */
+    const Frustum* activeFrustum = nullptr;    /**< Frustum of the cull in progress. */
+    uint64_t workGeneration = 0;               /**< Incremented once per cull to release the workers. */
+    uint32_t pendingWorkers = 0;               /**< Workers that have not finished the current cull. */
+    bool stopping = false;                     /**< Set to make the workers exit. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Loop run by each worker thread.
+     *
+     * @param chunk The chunk of objects the worker culls.
+     */
+    void workerLoop(uint32_t chunk);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Culls one contiguous chunk of the objects into chunkResults.
+     *
+     * @param frustum The frustum to test against.
+     * @param chunk The chunk to cull.
+     */
+    void cullChunk(const Frustum& frustum, uint32_t chunk);
+};
+// ================================================================================
+// ================================================================================
+#endif /* cpu_culling_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,321 @@
+// ================================================================================
+// ================================================================================
+// - File:    culling.hpp
+// - Purpose: This file contains a compute pass that frustum culls objects and their
+//            meshlets on the GPU and compacts the visible draws into an indirect
+//            argument buffer.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef culling_HPP
+#define culling_HPP
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <array>
+#include <string>
+
+#include "memory.hpp"
+#include "graphics.hpp"
+#include "mesh.hpp"
+#include "descriptors.hpp"
+// ================================================================================
+// ================================================================================
+
+static constexpr uint32_t MAX_CULL_OBJECTS = MAX_INSTANCES_PER_FRAME;
+static constexpr uint32_t MAX_CULL_DRAWS = 1 << 18;
+static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct CullObject
+ * @brief One object tested by the culling shader.
+ *
+ * The layout matches the std430 CullObject struct in cull.comp and cull_meshlets.comp.
+ * The draw fields of an object without meshlets are copied verbatim into a
+ * VkDrawIndexedIndirectCommand when the object survives. An object with meshlets
+ * instead emits one command per surviving meshlet, whose sphere and cone are moved
+ * to world space with the transform rows and scale.
+ */
+struct CullObject {
+    glm::vec4 sphere;                  /**< World space bounding sphere, center in xyz and radius in w. */
+    glm::vec4 transformRows[3];        /**< Rows of the affine model to world transform. */
+    uint32_t indexCount;               /**< Number of indices of the mesh. */
+    uint32_t instanceCount;            /**< Number of instances to draw. */
+    uint32_t firstIndex;               /**< First index of the mesh in the shared index buffer. */
+    int32_t vertexOffset;              /**< Vertex offset of the mesh in the shared vertex buffer. */
+    uint32_t firstInstance;            /**< First instance in the frame's instance buffer. */
+    uint32_t firstMeshlet;             /**< First meshlet of the mesh in the shared meshlet buffer. */
+    uint32_t meshletCount;             /**< Number of meshlets, zero to cull the object as a whole. */
+    float scale;                       /**< Largest axis scale of the transform, applied to meshlet radii. */
+    uint32_t coneCulling;              /**< Non-zero if the transform preserves normal cones and winding. */
+    uint32_t padding[3];               /**< Pads the struct to the std430 array stride. */
+};
+static_assert(sizeof(CullObject) == 112, "CullObject must match the std430 layout in cull.comp");
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct MeshletObjectList
+ * @brief Header of the buffer in which cull.comp lists visible objects that have meshlets.
+ *
+ * The dispatch command is written by cull.comp and consumed by vkCmdDispatchIndirect
+ * to launch one workgroup of cull_meshlets.comp per listed object. The object indices
+ * follow the header.
+ */
+struct MeshletObjectList {
+    VkDispatchIndirectCommand dispatch; /**< Workgroups of the meshlet dispatch. */
+    uint32_t objectCount;               /**< Number of object indices that follow. */
+};
+static_assert(sizeof(MeshletObjectList) == 16, "MeshletObjectList must match the layout in cull.comp");
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class CullingPass
+ * @brief Frustum culls objects in a compute shader and draws the survivors indirectly.
+ *
+ * Each frame owns a persistently mapped buffer of CullObject records written by the
+ * CPU, a device local buffer of VkDrawIndexedIndirectCommand records and a device
+ * local draw count. recordCull resets the count, dispatches cull.comp, which extracts
+ * the frustum planes from the view and projection matrices of the frame's
+ * UniformBufferObject and appends every object whose sphere intersects the frustum
+ * with an atomic counter. The caller makes the results visible to the indirect draw
+ * stage, which the render graph does by declaring the pass as a compute write of the
+ * draw commands that the scene pass reads indirectly. recordDraws replays the compacted list with vkCmdDrawIndexedIndirectCount,
+ * or, on devices without drawIndirectCount, draws one record per draw slot after the
+ * indirect buffer has been zero filled so culled slots draw nothing.
+ *
+ * Visible objects whose mesh has meshlets are not drawn whole. cull.comp lists them
+ * instead, and an indirect dispatch of cull_meshlets.comp tests each of their meshlets
+ * against the frustum and its normal cone against the camera, appending one command
+ * per surviving meshlet. Large, partially visible meshes then only draw the clusters
+ * that can contribute pixels.
+ */
+class CullingPass {
+public:
+    /**
+     * @brief Constructor for CullingPass.
+     *
+     * @param device The Vulkan logical device handle.
+     * @param allocatorManager A reference to the AllocatorManager responsible for memory allocation.
+     * @param descriptorBinder A reference to the DescriptorBinder that pushes or binds the culling descriptors.
+     * @param uniformBuffers The per-frame uniform buffers holding the view and projection matrices.
+     * @param meshletBuffer The shared meshlet buffer of the MeshRegistry.
+     * @param multiDrawIndirect True if the device enabled the multiDrawIndirect feature.
+     * @param drawIndirectCount True if the device enabled the drawIndirectCount feature.
+     * @param compFile The location of the object culling compute shader file relative to the executable.
+     * @param meshletCompFile The location of the meshlet culling compute shader file relative to the executable.
+     * @param maxObjects The number of objects each frame can hold.
+     * @param maxDraws The number of draws each frame can emit, counting every meshlet of an object.
+     * @throws std::runtime_error If the buffers, descriptors or compute pipelines cannot be created.
+     */
+    CullingPass(VkDevice device,
+                AllocatorManager& allocatorManager,
+                DescriptorBinder& descriptorBinder,
+                const std::vector<VkBuffer>& uniformBuffers,
+                VkBuffer meshletBuffer,
+                bool multiDrawIndirect,
+                bool drawIndirectCount,
+                std::string compFile,
+                std::string meshletCompFile,
+                uint32_t maxObjects = MAX_CULL_OBJECTS,
+                uint32_t maxDraws = MAX_CULL_DRAWS);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destructor for CullingPass.
+     *
+     * Destroys the compute pipelines and every buffer.
+     */
+    ~CullingPass();
+// --------------------------------------------------------------------------------
+
+    CullingPass(const CullingPass&) = delete;
+    CullingPass& operator=(const CullingPass&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Appends an object to the culling input of a frame.
+     *
+     * The model space bounding sphere of the mesh is moved to world space with the
+     * transform, and its radius is scaled by the largest axis scale of the transform.
+     * If the mesh has meshlets, they are culled on their own once the object is found
+     * visible, and normal cones are only tested when the transform scales uniformly
+     * and does not mirror, since other transforms do not preserve them. This method
+     * must only be called once the in flight fence of the frame has been waited on.
+     *
+     * @param frameIndex The index of the frame the object belongs to.
+     * @param mesh The mesh drawn for the object.
+     * @param transform The model to world transform of the object.
+     * @param firstInstance The first instance of the object in the frame's instance buffer.
+     * @param instanceCount The number of instances drawn for the object.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     * @throws std::runtime_error If the frame is full of objects or draws.
+     */
+    void addObject(uint32_t frameIndex, const MeshHandle& mesh, const glm::mat4& transform,
+                   uint32_t firstInstance, uint32_t instanceCount = 1);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the culling dispatch of a frame.
+     *
+     * Must be recorded outside of a render pass and after the frame's uniform buffer
+     * has been written. Only the barriers between the steps of the pass are recorded;
+     * the compute writes of the draw commands and count still have to be made visible
+     * to the indirect draw.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     * @param frameIndex The index of the frame to cull.
+     */
+    void recordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Points the culling bindings of every frame at a new meshlet buffer.
+     *
+     * Defragmentation moves the shared meshlet buffer of the MeshRegistry, so the current
+     * handle is passed in before every cull. Fallback sets of the old buffer are evicted
+     * by the recording frame; nothing may still read it.
+     *
+     * @param meshletBuffer The current shared meshlet buffer.
+     * @param frameIndex The index of the frame being recorded.
+     */
+    void setMeshletBuffer(VkBuffer meshletBuffer, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the indirect draws of the objects that survived culling.
+     *
+     * The pipeline, descriptor sets, vertex buffers and index buffer must already be bound.
+     *
+     * @param commandBuffer The command buffer being recorded, inside a render pass.
+     * @param frameIndex The index of the frame whose draws are recorded.
+     */
+    void recordDraws(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Discards every object of a frame.
+     *
+     * @param frameIndex The index of the frame to reset.
+     */
+    void reset(uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of objects submitted for culling in a frame.
+     *
+     * @param frameIndex The index of the frame.
+     * @return The number of objects, before culling.
+     */
+    uint32_t getObjectCount(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the largest number of draws the objects of a frame can emit.
+     *
+     * @param frameIndex The index of the frame.
+     * @return One draw per object without meshlets plus one per meshlet of the others.
+     */
+    uint32_t getDrawSlotCount(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the compacted indirect command buffer of a frame.
+     *
+     * @param frameIndex The index of the frame.
+     * @return The Vulkan buffer of VkDrawIndexedIndirectCommand records.
+     */
+    VkBuffer getDrawBuffer(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the buffer holding the number of visible draws of a frame.
+     *
+     * @param frameIndex The index of the frame.
+     * @return The Vulkan count buffer.
+     */
+    VkBuffer getCountBuffer(uint32_t frameIndex) const;
+// ================================================================================
+private:
+    VkDevice device;                           /**< Vulkan logical device handle. */
+    AllocatorManager& allocatorManager;        /**< The memory allocator manager for handling buffer memory. */
+    DescriptorBinder& descriptorBinder;        /**< Pushes or binds the culling descriptors each frame. */
+    bool multiDrawIndirect;                    /**< True if one indirect call may issue many draws. */
+    bool drawIndirectCount;                    /**< True if vkCmdDrawIndexedIndirectCount may be used. */
+    std::string compFile;                      /**< Culling Compute Shader File. */
+    std::string meshletCompFile;               /**< Meshlet Culling Compute Shader File. */
+    uint32_t maxObjects;                       /**< Capacity of each frame in objects. */
+    uint32_t maxDraws;                         /**< Capacity of each frame in draws. */
+
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> objectBuffers{};          /**< CPU written culling inputs per frame. */
+    std::array<VmaAllocation, MAX_FRAMES_IN_FLIGHT> objectAllocations{}; /**< Allocations of the object buffers. */
+    std::array<CullObject*, MAX_FRAMES_IN_FLIGHT> mappedObjects{};       /**< Mapped object buffers. */
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> drawBuffers{};            /**< Compacted indirect commands per frame. */
+    std::array<VmaAllocation, MAX_FRAMES_IN_FLIGHT> drawAllocations{};   /**< Allocations of the draw buffers. */
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> countBuffers{};           /**< Visible draw counts per frame. */
+    std::array<VmaAllocation, MAX_FRAMES_IN_FLIGHT> countAllocations{};  /**< Allocations of the count buffers. */
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> meshletObjectBuffers{};   /**< Visible objects with meshlets per frame. */
+    std::array<VmaAllocation, MAX_FRAMES_IN_FLIGHT> meshletObjectAllocations{}; /**< Allocations of the meshlet object lists. */
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> objectCounts{};           /**< Number of objects appended per frame. */
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> drawSlotCounts{};         /**< Largest number of draws per frame. */
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> meshletObjectCounts{};    /**< Number of objects with meshlets per frame. */
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE; /**< Layout of the culling descriptors, owned by the layout cache. */
+    std::array<std::vector<DescriptorResource>, MAX_FRAMES_IN_FLIGHT> descriptorResources; /**< Culling bindings per frame. */
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;           /**< Layout of the culling pipeline. */
+    VkPipeline pipeline = VK_NULL_HANDLE;                       /**< The object culling compute pipeline. */
+    VkPipeline meshletPipeline = VK_NULL_HANDLE;                /**< The meshlet culling compute pipeline. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the object, draw, count and meshlet object buffers of every frame.
+     */
+    void createBuffers();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Fetches the descriptor set layout from the binder and lists the bindings of every frame.
+     *
+     * @param uniformBuffers The per-frame uniform buffers bound at binding 0.
+     * @param meshletBuffer The shared meshlet buffer bound at binding 4.
+     */
+    void createDescriptorSets(const std::vector<VkBuffer>& uniformBuffers, VkBuffer meshletBuffer);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the culling pipeline layout and both compute pipelines.
+     */
+    void createPipelines();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates a compute pipeline with the culling pipeline layout.
+     *
+     * @param filename The location of the SPIR-V compute shader.
+     * @return The compute pipeline.
+     * @throws std::runtime_error If the shader cannot be read or the pipeline cannot be created.
+     */
+    VkPipeline createComputePipeline(const std::string& filename);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys every Vulkan object that has been created so far.
+     */
+    void destroyResources();
+};
+// ================================================================================
+// ================================================================================
+#endif /* culling_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,479 @@
+// ================================================================================
+// ================================================================================
+// - File:    descriptors.hpp
+// - Purpose: This file contains a descriptor set allocator that grows its list of
+//            pools on demand, caches that share descriptor set layouts and written
+//            descriptor sets, and a binder that pushes transient bindings straight
+//            into command buffers.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef descriptors_HPP
+#define descriptors_HPP
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "graphics.hpp"
+// ================================================================================
+// ================================================================================
+
+static constexpr uint32_t DESCRIPTOR_POOL_INITIAL_SETS = 64;   /**< Sets held by the first pool. */
+static constexpr uint32_t DESCRIPTOR_POOL_MAX_SETS = 4096;     /**< Sets held by a pool at most. */
+static constexpr uint32_t GUARANTEED_PUSH_DESCRIPTORS = 32;     /**< Smallest maxPushDescriptors Vulkan allows. */
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct DescriptorPoolRatio
+ * @brief The number of descriptors of one type a pool holds for each of its sets.
+ */
+struct DescriptorPoolRatio {
+    VkDescriptorType type;   /**< The descriptor type. */
+    float ratio;             /**< Descriptors of the type per set. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct DescriptorResource
+ * @brief One resource bound at a binding of a descriptor set.
+ *
+ * Buffer descriptors use buffer, offset and range; image and sampler descriptors use
+ * imageView, sampler and imageLayout. Fields a descriptor type does not use must be
+ * left at their defaults, since they take part in the comparison.
+ */
+struct DescriptorResource {
+    uint32_t binding = 0;                                  /**< Binding the resource is written to. */
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; /**< Type of the descriptor. */
+    VkBuffer buffer = VK_NULL_HANDLE;                      /**< Buffer of a buffer descriptor. */
+    VkDeviceSize offset = 0;                               /**< Offset of the buffer range. */
+    VkDeviceSize range = VK_WHOLE_SIZE;                    /**< Size of the buffer range. */
+    VkImageView imageView = VK_NULL_HANDLE;                /**< View of an image descriptor. */
+    VkSampler sampler = VK_NULL_HANDLE;                    /**< Sampler of a sampler descriptor. */
+    VkImageLayout imageLayout = VK_IMAGE_LAYOUT_UNDEFINED; /**< Layout of the image while it is accessed. */
+
+    /**
+     * @brief Compares every field of two resources.
+     *
+     * @param other The resource to compare with.
+     * @return True if both resources write the same descriptor to the same binding.
+     */
+    bool operator==(const DescriptorResource& other) const;
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class DescriptorAllocator
+ * @brief Allocates descriptor sets from a growing list of descriptor pools.
+ *
+ * Pools are created as they are needed. When an allocation fails with
+ * VK_ERROR_OUT_OF_POOL_MEMORY or VK_ERROR_FRAGMENTED_POOL, the pool is set aside as
+ * full and the allocation is retried from a fresh one, so callers never size a pool
+ * themselves. Each new pool holds twice the sets of the previous one, up to
+ * DESCRIPTOR_POOL_MAX_SETS, and its descriptor counts follow the ratios given at
+ * construction.
+ *
+ * Sets are never freed one at a time; they live as long as the allocator. Sets whose
+ * resources change are rewritten by the DescriptorSetCache instead of being reallocated,
+ * and bindings that only last one command buffer are pushed by the DescriptorBinder.
+ *
+ * The allocator is only used from the render thread and needs no locking.
+ */
+class DescriptorAllocator {
+public:
+    /**
+     * @brief Constructor for DescriptorAllocator.
+     *
+     * Creates no pool until the first allocation.
+     *
+     * @param device The Vulkan logical device handle.
+     * @param ratios Descriptors per set of each type held by every pool, a default mix if empty.
+     */
+    explicit DescriptorAllocator(VkDevice device, std::vector<DescriptorPoolRatio> ratios = {});
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destructor for DescriptorAllocator.
+     *
+     * Destroys every pool, which frees every set allocated from it.
+     */
+    ~DescriptorAllocator();
+// --------------------------------------------------------------------------------
+
+    DescriptorAllocator(const DescriptorAllocator&) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Allocates a set that lives as long as the allocator.
+     *
+     * @param layout The layout of the set.
+     * @return The allocated set.
+     * @throws std::runtime_error If the set cannot be allocated even from a new pool.
+     */
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+// --------------------------------------------------------------------------------
+
+
+    /**
+     * @brief Retrieves the number of pools the allocator has created.
+     *
+     * @return The number of pools.
+     */
+    uint32_t getPoolCount() const;
+// ================================================================================
+private:
+    VkDevice device;                                     /**< Vulkan logical device handle. */
+    std::vector<DescriptorPoolRatio> ratios;             /**< Descriptors per set of each type in a pool. */
+    uint32_t nextPoolSets = DESCRIPTOR_POOL_INITIAL_SETS; /**< Sets held by the next pool created. */
+    VkDescriptorPool currentPool = VK_NULL_HANDLE;       /**< Pool new sets are allocated from. */
+    std::vector<VkDescriptorPool> allPools;              /**< Every pool created, for destruction. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates an empty pool sized for nextPoolSets sets.
+     *
+     * @return The new pool.
+     * @throws std::runtime_error If the pool cannot be created.
+     */
+    VkDescriptorPool createPool();
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class DescriptorLayoutCache
+ * @brief Creates each distinct descriptor set layout once and shares it among its users.
+ *
+ * A layout is identified by its creation flags and its bindings. The bindings are
+ * normalized by sorting them on their binding number, along with their binding flags,
+ * so two lists that describe the same layout in a different order share one
+ * VkDescriptorSetLayout. Passes and materials that ask for the same layout every time
+ * they are built then cost a hash lookup instead of a vkCreateDescriptorSetLayout call.
+ *
+ * The cache owns every layout it returns and destroys them when it is destroyed, so
+ * callers must not destroy them. Immutable samplers are not part of the key and are
+ * rejected.
+ */
+class DescriptorLayoutCache {
+public:
+    /**
+     * @brief Constructor for DescriptorLayoutCache.
+     *
+     * @param device The Vulkan logical device handle.
+     */
+    explicit DescriptorLayoutCache(VkDevice device);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destructor for DescriptorLayoutCache.
+     *
+     * Destroys every layout the cache created.
+     */
+    ~DescriptorLayoutCache();
+// --------------------------------------------------------------------------------
+
+    DescriptorLayoutCache(const DescriptorLayoutCache&) = delete;
+    DescriptorLayoutCache& operator=(const DescriptorLayoutCache&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the layout for a list of bindings, creating it on first use.
+     *
+     * @param bindings The bindings of the layout, in any order.
+     * @param flags The creation flags of the layout.
+     * @param bindingFlags The descriptor indexing flags of each binding, in the order of bindings, or empty.
+     * @return The shared layout.
+     * @throws std::invalid_argument If a binding number repeats, a binding uses immutable
+     *         samplers, or bindingFlags is neither empty nor as long as bindings.
+     * @throws std::runtime_error If the layout cannot be created.
+     */
+    VkDescriptorSetLayout getLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+                                    VkDescriptorSetLayoutCreateFlags flags = 0,
+                                    const std::vector<VkDescriptorBindingFlags>& bindingFlags = {});
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of distinct layouts created.
+     *
+     * @return The number of layouts in the cache.
+     */
+    uint32_t getLayoutCount() const;
+// ================================================================================
+private:
+    /**
+     * @brief One normalized binding of a layout key.
+     */
+    struct BindingKey {
+        uint32_t binding;                     /**< Binding number. */
+        VkDescriptorType type;                /**< Descriptor type. */
+        uint32_t count;                       /**< Number of descriptors. */
+        VkShaderStageFlags stages;            /**< Stages that access the binding. */
+        VkDescriptorBindingFlags flags;       /**< Descriptor indexing flags. */
+
+        bool operator==(const BindingKey& other) const;
+    };
+
+    /**
+     * @brief The normalized description of a layout.
+     */
+    struct LayoutKey {
+        VkDescriptorSetLayoutCreateFlags flags; /**< Creation flags of the layout. */
+        std::vector<BindingKey> bindings;       /**< Bindings sorted by binding number. */
+
+        bool operator==(const LayoutKey& other) const;
+    };
+
+    /**
+     * @brief Hashes every field of a layout key.
+     */
+    struct LayoutKeyHash {
+        size_t operator()(const LayoutKey& key) const;
+    };
+
+    VkDevice device;                                                        /**< Vulkan logical device handle. */
+    std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHash> layouts; /**< Layouts by normalized key. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class DescriptorSetCache
+ * @brief Reuses written descriptor sets when the same resources are bound with the same layout again.
+ *
+ * A set is identified by its layout and the resources written to it, normalized by
+ * binding number. The first request allocates a persistent set from the
+ * DescriptorAllocator and writes it; every later request with the same key returns
+ * that set without calling vkUpdateDescriptorSets. Each binding receives one
+ * descriptor at array element 0.
+ *
+ * Cached sets refer to their resources by handle, so a resource must be evicted before
+ * it is destroyed. Frames in flight may still use the sets that referenced it, so they
+ * are only rewritten for other resources once collectRetired is called for the frame
+ * that evicted them, after its fence was waited on.
+ *
+ * The cache is only used from the render thread and needs no locking.
+ */
+class DescriptorSetCache {
+public:
+    /**
+     * @brief Constructor for DescriptorSetCache.
+     *
+     * @param device The Vulkan logical device handle.
+     * @param descriptorAllocator A reference to the DescriptorAllocator the cached sets come from.
+     */
+    DescriptorSetCache(VkDevice device, DescriptorAllocator& descriptorAllocator);
+// --------------------------------------------------------------------------------
+
+    DescriptorSetCache(const DescriptorSetCache&) = delete;
+    DescriptorSetCache& operator=(const DescriptorSetCache&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a set of a layout with the given resources written to it.
+     *
+     * @param layout The layout of the set, which must outlive the cache.
+     * @param resources One resource per binding of the layout, in any order.
+     * @return The cached set, written on first use.
+     * @throws std::invalid_argument If a binding number repeats.
+     * @throws std::runtime_error If the set cannot be allocated.
+     */
+    VkDescriptorSet getSet(VkDescriptorSetLayout layout, const std::vector<DescriptorResource>& resources);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Drops every cached set that refers to a buffer.
+     *
+     * @param buffer The buffer about to be destroyed.
+     * @param frameIndex The frame being recorded, whose completion makes the sets reusable.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     */
+    void evict(VkBuffer buffer, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Drops every cached set that refers to an image view.
+     *
+     * @param imageView The image view about to be destroyed.
+     * @param frameIndex The frame being recorded, whose completion makes the sets reusable.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     */
+    void evict(VkImageView imageView, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Makes the sets evicted by a frame available for rewriting.
+     *
+     * Must be called after the in flight fence of the frame has been waited on.
+     *
+     * @param frameIndex The index of the frame.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     */
+    void collectRetired(uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of sets currently cached.
+     *
+     * @return The number of cached sets.
+     */
+    uint32_t getSetCount() const;
+// ================================================================================
+private:
+    /**
+     * @brief The normalized description of a written set.
+     */
+    struct SetKey {
+        VkDescriptorSetLayout layout;             /**< Layout of the set. */
+        std::vector<DescriptorResource> resources; /**< Resources sorted by binding number. */
+
+        bool operator==(const SetKey& other) const;
+    };
+
+    /**
+     * @brief Hashes every field of a set key.
+     */
+    struct SetKeyHash {
+        size_t operator()(const SetKey& key) const;
+    };
+
+    /**
+     * @brief A set that no longer belongs to a key, along with its layout.
+     */
+    struct RetiredSet {
+        VkDescriptorSetLayout layout;             /**< Layout of the set. */
+        VkDescriptorSet set;                      /**< The set. */
+    };
+
+    VkDevice device;                              /**< Vulkan logical device handle. */
+    DescriptorAllocator& descriptorAllocator;     /**< The allocator new sets come from. */
+    std::unordered_map<SetKey, VkDescriptorSet, SetKeyHash> sets; /**< Written sets by normalized key. */
+    std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorSet>> freeSets; /**< Reusable sets per layout. */
+    std::array<std::vector<RetiredSet>, MAX_FRAMES_IN_FLIGHT> retiredSets; /**< Sets evicted by each frame. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Drops every cached set that refers to a resource matched by a predicate.
+     *
+     * @param refersTo Returns true for a resource that is being evicted.
+     * @param frameIndex The frame being recorded.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     */
+    template <typename Predicate>
+    void evictIf(Predicate refersTo, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes the resources of a key into a set.
+     *
+     * @param set The set to write.
+     * @param resources The resources, one per binding.
+     */
+    void writeSet(VkDescriptorSet set, const std::vector<DescriptorResource>& resources);
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class DescriptorBinder
+ * @brief Binds transient descriptor sets with push descriptors where the device supports them.
+ *
+ * When VK_KHR_push_descriptor is enabled, getLayout creates layouts with the push
+ * descriptor flag and bind records the writes straight into the command buffer through
+ * vkCmdPushDescriptorSetKHR. No set is allocated or written ahead of time, so those
+ * bindings never touch a descriptor pool.
+ *
+ * Without the extension, or for layouts with more descriptors than every device can
+ * push, the binder falls back to the DescriptorSetCache and binds the cached set. A
+ * pipeline layout must use the layout returned by getLayout for bind to match it.
+ *
+ * The binder is only used from the render thread and needs no locking.
+ */
+class DescriptorBinder {
+public:
+    /**
+     * @brief Constructor for DescriptorBinder.
+     *
+     * @param layoutCache A reference to the DescriptorLayoutCache that owns the layouts.
+     * @param setCache A reference to the DescriptorSetCache used when a layout cannot be pushed.
+     * @param cmdPushDescriptorSet vkCmdPushDescriptorSetKHR, or nullptr if the extension is not enabled.
+     */
+    DescriptorBinder(DescriptorLayoutCache& layoutCache,
+                     DescriptorSetCache& setCache,
+                     PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet);
+// --------------------------------------------------------------------------------
+
+    DescriptorBinder(const DescriptorBinder&) = delete;
+    DescriptorBinder& operator=(const DescriptorBinder&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a layout for transient bindings, flagged for push descriptors where possible.
+     *
+     * @param bindings The bindings of the layout, in any order.
+     * @return The cached layout, owned by the layout cache.
+     * @throws std::invalid_argument If a binding number repeats or uses immutable samplers.
+     * @throws std::runtime_error If the layout cannot be created.
+     */
+    VkDescriptorSetLayout getLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Binds resources to a set index of a pipeline layout.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     * @param bindPoint The pipeline bind point.
+     * @param pipelineLayout The pipeline layout, created with the given set layout at the set index.
+     * @param setIndex The set index to bind.
+     * @param layout A layout returned by getLayout.
+     * @param resources One resource per binding of the layout, in any order.
+     * @throws std::invalid_argument If a binding number repeats.
+     * @throws std::runtime_error If a fallback set cannot be allocated.
+     */
+    void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout,
+              uint32_t setIndex, VkDescriptorSetLayout layout, const std::vector<DescriptorResource>& resources);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Drops every fallback set that refers to a buffer.
+     *
+     * Pushed bindings hold no reference past their command buffer, so only cached sets are affected.
+     *
+     * @param buffer The buffer about to be destroyed.
+     * @param frameIndex The frame being recorded, whose completion makes the sets reusable.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     */
+    void evict(VkBuffer buffer, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks whether bindings are pushed rather than written into cached sets.
+     *
+     * @return True if VK_KHR_push_descriptor is enabled.
+     */
+    bool usesPushDescriptors() const;
+// ================================================================================
+private:
+    DescriptorLayoutCache& layoutCache;             /**< The cache that owns the layouts. */
+    DescriptorSetCache& setCache;                   /**< The cache fallback sets come from. */
+    PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet; /**< vkCmdPushDescriptorSetKHR, or nullptr. */
+    std::unordered_set<VkDescriptorSetLayout> pushLayouts; /**< Layouts created with the push descriptor flag. */
+};
+// ================================================================================
+// ================================================================================
+#endif /* descriptors_HPP */
+// ================================================================================
+// ================================================================================
+// eof
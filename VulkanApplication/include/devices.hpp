@@ -108,6 +108,17 @@ public:
      * @return The Vulkan physical device handle.
      */
     const VkPhysicalDevice getDevice() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Lists the device extensions to enable on the selected device.
+     *
+     * The list holds the required extensions followed by every optional extension,
+     * such as VK_KHR_push_descriptor or VK_EXT_memory_budget, that the device supports.
+     *
+     * @return The names of the extensions to pass to VulkanLogicalDevice.
+     */
+    std::vector<const char*> getEnabledExtensions() const;
 // ================================================================================
 
 private:
@@ -117,6 +128,8 @@ private:
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     mutable std::mutex deviceMutex;
     std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    std::vector<const char*> optionalDeviceExtensions = { VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME,
+                                                           VK_EXT_MEMORY_BUDGET_EXTENSION_NAME };
 // --------------------------------------------------------------------------------
     
     /**
@@ -142,6 +155,30 @@ private:
     bool checkDeviceExtensionSupport(const VkPhysicalDevice& device) const;
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Checks if a physical device supports every extension of a list.
+     *
+     * @param device The Vulkan physical device to check for extension support.
+     * @param extensions The names of the extensions.
+     * @return true if every extension of the list is supported, false otherwise.
+     */
+    bool checkDeviceExtensionSupport(const VkPhysicalDevice& device,
+                                     const std::vector<const char*>& extensions) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if a physical device supports the descriptor indexing the bindless descriptors need.
+     *
+     * The DescriptorManager binds every resource through runtime sized arrays that are
+     * partially bound and updated after being bound, and the vertex shaders index the array of
+     * frame data buffers with a push constant, so a device without these features cannot render.
+     *
+     * @param device The Vulkan physical device to check.
+     * @return True if the device is Vulkan 1.2 or newer and supports every required feature.
+     */
+    bool checkDescriptorIndexingSupport(const VkPhysicalDevice& device) const;
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Rates the suitability of a given Vulkan physical device for the application.
      * 
@@ -361,7 +398,7 @@ public:
      * @param physicalDevice The Vulkan physical device to use for logical device creation.
      * @param validationLayers A vector containing the names of the validation layers to be enabled.
      * @param surface The surface used to present images to the screen.
-     * @param deviceExtensions A vector of required device extensions.
+     * @param deviceExtensions A vector of the device extensions to enable, which may include optional ones.
      */
     VulkanLogicalDevice(VkPhysicalDevice physicalDevice, 
                         const std::vector<const char*>& validationLayers,
@@ -458,6 +495,46 @@ public:
      * @return The Vulkan present queue handle.
      */
     VkQueue getPresentQueue() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if indirect draws may issue more than one draw per call.
+     * 
+     * @return True if the multiDrawIndirect feature was enabled on the device.
+     */
+    bool isMultiDrawIndirectEnabled() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if indirect draws may use a non-zero firstInstance.
+     * 
+     * @return True if the drawIndirectFirstInstance feature was enabled on the device.
+     */
+    bool isDrawIndirectFirstInstanceEnabled() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if vkCmdDrawIndexedIndirectCount may be used.
+     * 
+     * @return True if the Vulkan 1.2 drawIndirectCount feature was enabled on the device.
+     */
+    bool isDrawIndirectCountEnabled() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves vkCmdPushDescriptorSetKHR if VK_KHR_push_descriptor was enabled.
+     * 
+     * @return The device level command, or nullptr if the extension is not enabled.
+     */
+    PFN_vkCmdPushDescriptorSetKHR getCmdPushDescriptorSet() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if VK_EXT_memory_budget was enabled, so the allocator can report heap budgets.
+     * 
+     * @return True if the extension is enabled on the device.
+     */
+    bool isMemoryBudgetEnabled() const;
 // ================================================================================
 private:
     VkDevice device = VK_NULL_HANDLE; ///< Vulkan logical device handle.
@@ -467,6 +544,11 @@ private:
     std::vector<const char*> validationLayers; ///< Names of the validation layers to be enabled.
     VkSurfaceKHR surface; ///< Surface used to present images to the screen.
     std::vector<const char*> deviceExtensions; ///< Names of the device extensions to be enabled.
+    bool multiDrawIndirectEnabled = false; ///< True if multiDrawIndirect was enabled.
+    bool drawIndirectFirstInstanceEnabled = false; ///< True if drawIndirectFirstInstance was enabled.
+    bool drawIndirectCountEnabled = false; ///< True if drawIndirectCount was enabled.
+    PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet = nullptr; ///< vkCmdPushDescriptorSetKHR, if enabled.
+    bool memoryBudgetEnabled = false; ///< True if VK_EXT_memory_budget was enabled.
 
     mutable std::mutex deviceMutex; ///< Mutex to protect access to the Vulkan logical device.
     mutable std::mutex queueMutex; ///< Mutex to protect access to the Vulkan queues.
@@ -0,0 +1,188 @@
+// ================================================================================
+// ================================================================================
+// - File:    draw_list.hpp
+// - Purpose: This file contains a draw list that records indexed draws as
+//            VkDrawIndexedIndirectCommand records in GPU visible memory.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef draw_list_HPP
+#define draw_list_HPP
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <array>
+
+#include "memory.hpp"
+#include "graphics.hpp"
+#include "mesh.hpp"
+// ================================================================================
+// ================================================================================
+
+static constexpr uint32_t MAX_INDIRECT_DRAWS = 1 << 16;
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class IndirectDrawList
+ * @brief Collects indexed draws into per-frame indirect command buffers.
+ *
+ * Each frame owns a persistently mapped buffer of VkDrawIndexedIndirectCommand
+ * records and a buffer holding the number of records. Draws are appended on the
+ * CPU and replayed with a single vkCmdDrawIndexedIndirectCount call when the
+ * device supports it, or a single vkCmdDrawIndexedIndirect call otherwise, so
+ * the cost of recording is independent of the number of draws. Devices without
+ * multiDrawIndirect fall back to one indirect call per draw.
+ */
+class IndirectDrawList {
+public:
+    /**
+     * @brief Constructor for IndirectDrawList.
+     *
+     * @param allocatorManager A reference to the AllocatorManager responsible for memory allocation.
+     * @param multiDrawIndirect True if the device enabled the multiDrawIndirect feature.
+     * @param drawIndirectCount True if the device enabled the drawIndirectCount feature.
+     * @param drawIndirectFirstInstance True if the device enabled the drawIndirectFirstInstance feature.
+     * @param maxDraws The number of draws each frame can hold.
+     * @throws std::runtime_error If the indirect or count buffers cannot be created.
+     */
+    IndirectDrawList(AllocatorManager& allocatorManager,
+                     bool multiDrawIndirect,
+                     bool drawIndirectCount,
+                     bool drawIndirectFirstInstance,
+                     uint32_t maxDraws = MAX_INDIRECT_DRAWS);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destructor for IndirectDrawList.
+     *
+     * Unmaps and destroys the indirect and count buffers of every frame.
+     */
+    ~IndirectDrawList();
+// --------------------------------------------------------------------------------
+
+    IndirectDrawList(const IndirectDrawList&) = delete;
+    IndirectDrawList& operator=(const IndirectDrawList&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Appends a draw of a mesh to the command buffer of a frame.
+     *
+     * This method must only be called once the in flight fence of the frame has been
+     * waited on, since it writes into memory the GPU reads while the frame executes.
+     *
+     * @param frameIndex The index of the frame the draw belongs to.
+     * @param mesh The mesh to draw.
+     * @param instanceCount The number of instances to draw.
+     * @param firstInstance The first instance to draw.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     * @throws std::runtime_error If the frame is full, or firstInstance is not zero on a
+     *         device without drawIndirectFirstInstance.
+     */
+    void addDraw(uint32_t frameIndex, const MeshHandle& mesh, uint32_t instanceCount = 1,
+                 uint32_t firstInstance = 0);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the draws of a frame into a command buffer.
+     *
+     * The pipeline, descriptor sets, vertex buffers and index buffer must already be bound.
+     *
+     * @param commandBuffer The command buffer being recorded, inside a render pass.
+     * @param frameIndex The index of the frame whose draws are recorded.
+     */
+    void record(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Discards every draw of a frame.
+     *
+     * @param frameIndex The index of the frame to reset.
+     */
+    void reset(uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of draws appended to a frame.
+     *
+     * @param frameIndex The index of the frame.
+     * @return The number of draws.
+     */
+    uint32_t getDrawCount(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of draws each frame can hold.
+     *
+     * @return The capacity of each frame's indirect buffer in draws.
+     */
+    uint32_t getMaxDraws() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the buffer of VkDrawIndexedIndirectCommand records of a frame.
+     *
+     * @param frameIndex The index of the frame.
+     * @return The Vulkan indirect buffer.
+     */
+    VkBuffer getIndirectBuffer(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the buffer holding the draw count of a frame.
+     *
+     * @param frameIndex The index of the frame.
+     * @return The Vulkan count buffer.
+     */
+    VkBuffer getCountBuffer(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if draws may use a non-zero firstInstance.
+     *
+     * @return True if the drawIndirectFirstInstance feature is enabled.
+     */
+    bool supportsFirstInstance() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if the draw count can be read from a GPU buffer.
+     *
+     * @return True if the drawIndirectCount feature is enabled.
+     */
+    bool supportsDrawCount() const;
+// ================================================================================
+private:
+    AllocatorManager& allocatorManager;        /**< The memory allocator manager for handling buffer memory. */
+    bool multiDrawIndirect;                    /**< True if one indirect call may issue many draws. */
+    bool drawIndirectCount;                    /**< True if vkCmdDrawIndexedIndirectCount may be used. */
+    bool drawIndirectFirstInstance;            /**< True if indirect draws may use a non-zero firstInstance. */
+    uint32_t maxDraws;                         /**< Capacity of each frame in draws. */
+
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> indirectBuffers{};          /**< Indirect command buffers per frame. */
+    std::array<VmaAllocation, MAX_FRAMES_IN_FLIGHT> indirectAllocations{}; /**< Allocations of the indirect buffers. */
+    std::array<VkDrawIndexedIndirectCommand*, MAX_FRAMES_IN_FLIGHT> mappedCommands{}; /**< Mapped indirect buffers. */
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> countBuffers{};             /**< Draw count buffers per frame. */
+    std::array<VmaAllocation, MAX_FRAMES_IN_FLIGHT> countAllocations{};    /**< Allocations of the count buffers. */
+    std::array<uint32_t*, MAX_FRAMES_IN_FLIGHT> mappedCounts{};            /**< Mapped count buffers. */
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> drawCounts{};               /**< Number of draws appended per frame. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys every buffer that has been created so far.
+     */
+    void destroyBuffers();
+};
+// ================================================================================
+// ================================================================================
+#endif /* draw_list_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -19,14 +19,32 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 
 #include "memory.hpp"
 #include "devices.hpp"
+#include "vertex_layout.hpp"
+#include "lod.hpp"
+#include "cpu_culling.hpp"
+#include "render_graph.hpp"
 #include <vk_mem_alloc.h>
 // ================================================================================
 // ================================================================================ 
 
 static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+static constexpr uint32_t MAX_INSTANCES_PER_FRAME = 1 << 17;
+// ================================================================================
+// ================================================================================ 
+
+class MeshRegistry;
+class IndirectDrawList;
+class CullingPass;
+class AssetStreamer;
+class FramebufferAttachments;
+struct MeshHandle;
 // ================================================================================
 // ================================================================================ 
 
@@ -52,13 +70,8 @@ struct Vertex {
      * 
      * @return A VkVertexInputBindingDescription struct that describes the input binding.
      */
-    static VkVertexInputBindingDescription getBindingDescription() {
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex);
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-        return bindingDescription;
+    static constexpr VkVertexInputBindingDescription getBindingDescription() {
+        return makeBindingDescription<Vertex>(0);
     }
 // --------------------------------------------------------------------------------
 
@@ -66,25 +79,51 @@ struct Vertex {
      * @brief Returns the attribute descriptions for the vertex input.
      *
      * This function describes the vertex attributes (position and color) and their
-     * layout in memory. It specifies the format of each attribute and the byte offset
-     * from the start of the vertex structure.
+     * layout in memory. The format and byte offset of each attribute are derived from
+     * the member declarations at compile time.
      * 
      * @return A std::array of VkVertexInputAttributeDescription structs that describe the vertex attributes.
      */
-    static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
-        std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+    static constexpr auto getAttributeDescriptions() {
+        return makeAttributeDescriptions(0, VERTEX_MEMBER(Vertex, pos), VERTEX_MEMBER(Vertex, color));
+    }
+};
+// ================================================================================
+// ================================================================================
 
-        attributeDescriptions[0].binding = 0;
-        attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[0].offset = offsetof(Vertex, pos);
 
-        attributeDescriptions[1].binding = 0;
-        attributeDescriptions[1].location = 1;
-        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[1].offset = offsetof(Vertex, color);
+/**
+ * @brief Represents the per-instance attributes of an instanced draw.
+ *
+ * Instance data is read from a second vertex binding that advances once per
+ * instance rather than once per vertex. The transform occupies four consecutive
+ * attribute locations, one for each column of the matrix.
+ */
+struct InstanceData {
+    glm::mat4 transform;
+    glm::vec4 color;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the binding description for the instance input.
+     *
+     * @return A VkVertexInputBindingDescription struct that describes binding 1 at instance rate.
+     */
+    static constexpr VkVertexInputBindingDescription getBindingDescription() {
+        return makeBindingDescription<InstanceData>(1, VK_VERTEX_INPUT_RATE_INSTANCE);
+    }
+// --------------------------------------------------------------------------------
 
-        return attributeDescriptions;
+    /**
+     * @brief Returns the attribute descriptions for the instance input.
+     *
+     * Locations 2 through 5 hold the columns of the transform and location 6 holds the color.
+     *
+     * @return A std::array of VkVertexInputAttributeDescription structs that describe the instance attributes.
+     */
+    static constexpr auto getAttributeDescriptions() {
+        return makeAttributeDescriptions(1, VERTEX_MEMBER_AT(InstanceData, transform, 2),
+                                         VERTEX_MEMBER(InstanceData, color));
     }
 };
 // ================================================================================
@@ -239,15 +278,16 @@ private:
  *
  * This class encapsulates the management and allocation of various Vulkan buffers, such as vertex buffers,
  * index buffers, and uniform buffers. It also handles the mapping and updating of uniform buffers for different
- * frames.
+ * frames. Vertex and index data live in the shared buffers of a MeshRegistry, which holds the mesh passed
+ * to the constructor along with any mesh added at runtime.
  */
 class BufferManager {
 public:
      /**
      * @brief Constructor for BufferManager.
      *
-     * @param vertices A vector of Vertex objects representing the vertex data.
-     * @param indices A vector of 16-bit unsigned integers representing the index data.
+     * @param vertices A vector of Vertex objects representing the vertex data of the initial mesh.
+     * @param indices A vector of 16-bit unsigned integers representing the index data of the initial mesh.
      * @param allocatorManager A reference to the AllocatorManager responsible for memory allocation.
      * @param commandBufferManager A reference to the CommandBufferManager used for command buffer management.
      * @param graphicsQueue The Vulkan queue used for submitting graphics commands.
@@ -277,7 +317,7 @@ public:
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Retrieves the Vulkan vertex buffer.
+     * @brief Retrieves the shared Vulkan vertex buffer of the mesh registry.
      *
      * @return The Vulkan buffer used for storing vertex data.
      */
@@ -285,13 +325,29 @@ public:
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Retrieves the Vulkan index buffer.
+     * @brief Retrieves the shared Vulkan index buffer of the mesh registry.
      *
      * @return The Vulkan buffer used for storing index data.
      */
     const VkBuffer getIndexBuffer() const;
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Retrieves the registry that owns the shared vertex and index buffers.
+     *
+     * @return A reference to the mesh registry.
+     */
+    MeshRegistry& getMeshRegistry() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the handle of the mesh passed to the constructor.
+     *
+     * @return A reference to the handle of the initial mesh.
+     */
+    const MeshHandle& getInitialMesh() const;
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Retrieves the vector of uniform buffers used for each frame.
      *
@@ -306,65 +362,214 @@ public:
      * @return A reference to the vector of void pointers that map the uniform buffers.
      */
     const std::vector<void*>& getUniformBuffersMapped() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Appends instance data to the persistently mapped instance buffer of a frame.
+     *
+     * This method must only be called once the in flight fence of the frame has been
+     * waited on, since it writes into memory the GPU reads while the frame executes.
+     *
+     * @param currentFrame The index of the current frame.
+     * @param instances The per-instance data to append.
+     * @return The index of the first appended instance, suitable as firstInstance of a draw.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     * @throws std::runtime_error If the instance buffer of the frame is full.
+     */
+    uint32_t writeInstances(uint32_t currentFrame, const std::vector<InstanceData>& instances);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Discards every instance written to the instance buffer of a frame.
+     *
+     * @param currentFrame The index of the frame whose instance buffer is reset.
+     */
+    void resetInstances(uint32_t currentFrame);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the instance buffer of a frame.
+     *
+     * @param currentFrame The index of the frame.
+     * @return The Vulkan buffer holding the instance data of the frame.
+     */
+    VkBuffer getInstanceBuffer(uint32_t currentFrame) const;
 // ================================================================================
 private:
-    std::vector<Vertex> vertices;                   /**< The vertex data used for rendering. */
-    std::vector<uint16_t> indices;                  /**< The index data for drawing elements. */
     AllocatorManager& allocatorManager;             /**< The memory allocator manager for handling buffer memory. */
     CommandBufferManager& commandBufferManager;     /**< Command buffer manager for managing related command buffers. */
     VkQueue graphicsQueue;                          /**< The Vulkan queue used for submitting graphics commands. */
 
-    VkBuffer vertexBuffer;                          /**< Vulkan buffer for storing vertex data. */
-    VkBuffer indexBuffer;                           /**< Vulkan buffer for storing index data. */
-    VmaAllocation vertexBufferAllocation;           /**< Memory allocation handle for the vertex buffer. */
-    VmaAllocation indexBufferAllocation;            /**< Memory allocation handle for the index buffer. */
+    std::unique_ptr<MeshRegistry> meshRegistry;     /**< Registry owning the shared vertex and index buffers. */
+    uint32_t initialMeshId;                         /**< Registry identifier of the mesh passed to the constructor. */
 
     std::vector<VkBuffer> uniformBuffers;           /**< Vector of Vulkan buffers used for uniform data across frames. */
     std::vector<void*> uniformBuffersMapped;        /**< Vector of pointers that map uniform buffers for direct memory access. */
     std::vector<VmaAllocation> uniformBuffersMemory;/**< Memory allocation handles for the uniform buffers. */
+
+    std::vector<VkBuffer> instanceBuffers;          /**< Vector of Vulkan buffers holding per-instance data for each frame. */
+    std::vector<void*> instanceBuffersMapped;       /**< Vector of pointers that persistently map the instance buffers. */
+    std::vector<VmaAllocation> instanceBuffersMemory;/**< Memory allocation handles for the instance buffers. */
+    std::vector<uint32_t> instanceCounts;           /**< Number of instances written to each frame's instance buffer. */
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Creates the vertex buffer and allocates memory for it.
+     * @brief Creates uniform buffers for each frame in the application.
      *
-     * @return True if the vertex buffer was successfully created, false otherwise.
+     * @return True if the uniform buffers were successfully created, false otherwise.
      */
-    bool createVertexBuffer();
+    bool createUniformBuffers();
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Creates the index buffer and allocates memory for it.
+     * @brief Creates and persistently maps an instance buffer for each frame in the application.
      *
-     * @return True if the index buffer was successfully created, false otherwise.
+     * @throws std::runtime_error If a buffer cannot be created or mapped.
      */
-    bool createIndexBuffer();
+    void createInstanceBuffers();
+};
+// // ================================================================================
+// // ================================================================================ 
+
+/**
+ * @brief The kinds of resources held by the bindless descriptor arrays.
+ *
+ * The value of each kind is the binding of its array in the bindless descriptor set.
+ */
+enum class BindlessType : uint32_t {
+    StorageBuffer = 0,  /**< Storage buffers, binding 0. */
+    SampledImage = 1,   /**< Sampled images, binding 1. */
+    Sampler = 2         /**< Samplers, binding 2. */
+};
+// --------------------------------------------------------------------------------
+
+static constexpr uint32_t BINDLESS_TYPE_COUNT = 3;                 /**< Number of BindlessType values. */
+static constexpr uint32_t BINDLESS_STORAGE_BUFFER_CAPACITY = 1 << 16; /**< Largest storage buffer array requested. */
+static constexpr uint32_t BINDLESS_SAMPLED_IMAGE_CAPACITY = 1 << 16;  /**< Largest sampled image array requested. */
+static constexpr uint32_t BINDLESS_SAMPLER_CAPACITY = 1 << 10;        /**< Largest sampler array requested. */
+static constexpr uint32_t INVALID_BINDLESS_INDEX = UINT32_MAX;     /**< Index of an unregistered resource. */
+// --------------------------------------------------------------------------------
+
+static constexpr uint32_t GUARANTEED_PUSH_CONSTANTS_SIZE = 128;  /**< Smallest maxPushConstantsSize a device may report. */
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Typed access to a block of push constants.
+ *
+ * The block type is checked at compile time: it must be trivially copyable, a multiple
+ * of four bytes and no larger than the 128 bytes every device provides, so a block that
+ * compiles fits any device on its own. Only the offset of the block is checked against
+ * the device, when its range is built.
+ *
+ * @tparam T The C++ mirror of the push_constant block declared by the shaders.
+ */
+template <typename T>
+class PushConstantBlock {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "Push constant blocks must be trivially copyable");
+    static_assert(sizeof(T) % 4 == 0, "Push constant blocks must be a multiple of 4 bytes");
+    static_assert(sizeof(T) <= GUARANTEED_PUSH_CONSTANTS_SIZE,
+                  "Push constant blocks must fit the 128 bytes every device supports");
+
+    static constexpr uint32_t SIZE = static_cast<uint32_t>(sizeof(T)); /**< Size of the block in bytes. */
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Creates uniform buffers for each frame in the application.
+     * @brief Builds the push constant range of the block for a pipeline layout.
      *
-     * @return True if the uniform buffers were successfully created, false otherwise.
+     * @param physicalDevice The Vulkan physical device whose maxPushConstantsSize bounds the range.
+     * @param stages The shader stages that read the block.
+     * @param offset The offset of the block, a multiple of four.
+     * @return The range to add to the pipeline layout.
+     * @throws std::invalid_argument If the offset is not a multiple of four.
+     * @throws std::runtime_error If the block ends beyond maxPushConstantsSize.
      */
-    bool createUniformBuffers();
+    static VkPushConstantRange getRange(VkPhysicalDevice physicalDevice, VkShaderStageFlags stages,
+                                        uint32_t offset = 0) {
+        if (offset % 4 != 0) {
+            throw std::invalid_argument("Push constant offsets must be a multiple of 4 bytes!");
+        }
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        if (offset + SIZE > properties.limits.maxPushConstantsSize) {
+            throw std::runtime_error("Push constant block ends at byte " + std::to_string(offset + SIZE) +
+                                     ", beyond the device limit of " +
+                                     std::to_string(properties.limits.maxPushConstantsSize) + "!");
+        }
+        return {stages, offset, SIZE};
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records an update of the whole block.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     * @param pipelineLayout The pipeline layout the range was added to.
+     * @param stages The stages of the range, which must match the ones given to getRange.
+     * @param value The new contents of the block.
+     * @param offset The offset of the range.
+     */
+    static void push(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkShaderStageFlags stages,
+                     const T& value, uint32_t offset = 0) {
+        vkCmdPushConstants(commandBuffer, pipelineLayout, stages, offset, SIZE, &value);
+    }
 };
-// // ================================================================================
-// // ================================================================================ 
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief The push constants shared by every graphics pipeline.
+ *
+ * Small per-draw data travels here rather than through buffers and descriptors, since
+ * one vkCmdPushConstants call between draws costs far less than a buffer write and a
+ * descriptor set bind. The layout mirrors the DrawConstants block of the vertex shaders.
+ */
+struct DrawConstants {
+    glm::mat4 model;      /**< Model matrix of a single draw, identity for instanced draws. */
+    uint32_t objectIndex; /**< Position of the draw among the frame's single draws. */
+    uint32_t materialId;  /**< Material of the draw. */
+    uint32_t frameData;   /**< Storage buffer index of the frame's UniformBufferObject. */
+    uint32_t padding;     /**< Pads the block to a multiple of 16 bytes. */
+};
+
+using DrawConstantBlock = PushConstantBlock<DrawConstants>;
+
+static constexpr VkShaderStageFlags DRAW_CONSTANT_STAGES =
+    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;  /**< Stages that read DrawConstants. */
+// ================================================================================
+// ================================================================================
 
 /**
  * @class DescriptorManager
- * @brief Manages Vulkan descriptor sets, layouts, and descriptor pools.
+ * @brief Manages the bindless descriptor set that every resource of the renderer is reached through.
+ *
+ * A single descriptor set holds one large array per BindlessType: storage buffers at
+ * binding 0, sampled images at binding 1 and samplers at binding 2. Registering a
+ * resource writes it into a free slot of its array and returns the slot, which shaders
+ * use as a plain integer index. The set is bound once per command buffer, so draws
+ * never bind descriptor sets and the indices can be stored in GPU written buffers.
  *
- * This class handles the creation and management of Vulkan descriptor sets, layouts, and descriptor pools.
- * It is responsible for creating the descriptor sets for each frame and managing the descriptor pool and layout.
+ * The arrays are created with the update-after-bind, update-unused-while-pending and
+ * partially-bound flags of descriptor indexing, which lets resources be registered
+ * while frames in flight use the set and leaves unregistered slots unwritten. A slot
+ * that is released may still be read by a frame in flight, so it is only reused once
+ * collectReleased is called for the frame that released it, after its fence was waited on.
+ * The array sizes are the BINDLESS_*_CAPACITY constants clamped to the update-after-bind
+ * limits of the device.
+ *
+ * The manager is only used from the render thread and needs no locking.
  */
 class DescriptorManager {
 public:
     /**
      * @brief Constructor for DescriptorManager.
      *
+     * Creates the bindless layout, the pool and the descriptor set.
+     *
      * @param device The Vulkan device handle used for creating descriptor sets and pools.
+     * @param physicalDevice The Vulkan physical device whose descriptor indexing limits size the arrays.
+     * @throws std::runtime_error If the layout, pool or set cannot be created.
      */
-    DescriptorManager(VkDevice device);
+    DescriptorManager(VkDevice device, VkPhysicalDevice physicalDevice);
 // --------------------------------------------------------------------------------
 
     /**
@@ -375,12 +580,94 @@ public:
     ~DescriptorManager();
 // --------------------------------------------------------------------------------
 
+    DescriptorManager(const DescriptorManager&) = delete;
+    DescriptorManager& operator=(const DescriptorManager&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes a range of a storage buffer into a free slot of the storage buffer array.
+     *
+     * @param buffer The buffer, created with VK_BUFFER_USAGE_STORAGE_BUFFER_BIT.
+     * @param offset The offset of the range, a multiple of minStorageBufferOffsetAlignment.
+     * @param range The size of the range, VK_WHOLE_SIZE for the rest of the buffer.
+     * @return The index shaders read the buffer at.
+     * @throws std::runtime_error If every slot is in use.
+     */
+    uint32_t registerStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+// --------------------------------------------------------------------------------
+
     /**
-     * @brief Creates descriptor sets for each frame in the application.
+     * @brief Writes an image view into a free slot of the sampled image array.
      *
-     * @param uniformBuffers A vector of Vulkan buffers that hold the uniform buffer data for each frame.
+     * @param imageView The view, of an image created with VK_IMAGE_USAGE_SAMPLED_BIT.
+     * @param layout The layout the image is in whenever shaders sample it.
+     * @return The index shaders sample the image at.
+     * @throws std::runtime_error If every slot is in use.
      */
-    void createDescriptorSets(const std::vector<VkBuffer> uniformBuffers);
+    uint32_t registerSampledImage(VkImageView imageView,
+                                  VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes a sampler into a free slot of the sampler array.
+     *
+     * @param sampler The sampler.
+     * @return The index shaders combine the sampler at.
+     * @throws std::runtime_error If every slot is in use.
+     */
+    uint32_t registerSampler(VkSampler sampler);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Releases a slot once the frame that stops using it has completed.
+     *
+     * The descriptor is left in place, since frames in flight may still read it.
+     *
+     * @param type The array the slot belongs to.
+     * @param index The slot returned when the resource was registered.
+     * @param frameIndex The frame being recorded, whose completion makes the slot reusable.
+     * @throws std::out_of_range If the slot or the frame index is out of bounds.
+     */
+    void release(BindlessType type, uint32_t index, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the slots released by a frame to their free lists.
+     *
+     * Must be called after the in flight fence of the frame has been waited on.
+     *
+     * @param frameIndex The index of the frame.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     */
+    void collectReleased(uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Binds the bindless descriptor set as set 0.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     * @param bindPoint The pipeline bind point to bind the set for.
+     * @param pipelineLayout A pipeline layout whose set 0 is getDescriptorSetLayout.
+     */
+    void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the size of an array.
+     *
+     * @param type The array.
+     * @return The number of slots of the array.
+     */
+    uint32_t getCapacity(BindlessType type) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of slots of an array that are registered or awaiting reuse.
+     *
+     * @param type The array.
+     * @return The number of slots that are not free.
+     */
+    uint32_t getUsedCount(BindlessType type) const;
 // --------------------------------------------------------------------------------
 
     /**
@@ -400,33 +687,49 @@ public:
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Retrieves the vector of Vulkan descriptor sets.
+     * @brief Retrieves the bindless descriptor set.
      *
-     * @return A reference to the vector of Vulkan descriptor sets.
+     * @return A reference to the Vulkan descriptor set shared by every frame.
+     */
+    const VkDescriptorSet& getDescriptorSet() const;
+// ================================================================================
+private:
+    /**
+     * @brief The slots of one bindless array.
      */
-    const std::vector<VkDescriptorSet>& getDescriptorSets() const;
+    struct SlotAllocator {
+        uint32_t capacity = 0;                     /**< Size of the array. */
+        uint32_t nextSlot = 0;                     /**< First slot that was never handed out. */
+        std::vector<uint32_t> freeSlots;           /**< Released slots that may be reused. */
+        std::array<std::vector<uint32_t>, MAX_FRAMES_IN_FLIGHT> releasedSlots; /**< Slots released by each frame. */
+    };
+
+    VkDevice device;                                /**< The Vulkan device handle. */
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;  /**< The layout of the bindless set. */
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;            /**< The update-after-bind pool of the bindless set. */
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;              /**< The bindless set. */
+    std::array<SlotAllocator, BINDLESS_TYPE_COUNT> slots;        /**< Slot allocator of each array. */
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Retrieves the descriptor set for a specific frame.
-     *
-     * @param frameIndex The index of the frame for which to retrieve the descriptor set.
-     * @return A reference to the Vulkan descriptor set for the given frame.
+     * @brief Destroys the pool, which frees the set, and the layout if they exist.
      */
-    const VkDescriptorSet& getDescriptorSet(uint32_t frameIndex) const;
-// ================================================================================
-private:
-    VkDevice device;                                /**< The Vulkan device handle. */
+    void destroyDescriptorObjects();
+// --------------------------------------------------------------------------------
 
-    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;  /**< The layout of the descriptor sets. */
-    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;            /**< The descriptor pool for allocating descriptor sets. */
-    std::vector<VkDescriptorSet> descriptorSets;                 /**< A vector holding descriptor sets for each frame. */
+    /**
+     * @brief Clamps the requested array sizes to the update-after-bind limits of the device.
+     *
+     * @param physicalDevice The Vulkan physical device.
+     */
+    void selectCapacities(VkPhysicalDevice physicalDevice);
 // --------------------------------------------------------------------------------
 
     /**
      * @brief Creates the Vulkan descriptor set layout.
      *
-     * Defines the layout of the descriptor sets and creates a corresponding layout object.
+     * Every binding is a partially bound, update-after-bind array visible to all shader stages.
      */
     void createDescriptorSetLayout();
 // --------------------------------------------------------------------------------
@@ -434,9 +737,37 @@ private:
     /**
      * @brief Creates the Vulkan descriptor pool.
      *
-     * Allocates a descriptor pool from which descriptor sets can be allocated.
+     * Allocates an update-after-bind pool sized for the one bindless set.
      */
     void createDescriptorPool();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Allocates the bindless descriptor set from the pool.
+     */
+    void createDescriptorSet();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Takes a free slot of an array, preferring released ones.
+     *
+     * @param type The array.
+     * @return The slot.
+     * @throws std::runtime_error If every slot is in use.
+     */
+    uint32_t allocateSlot(BindlessType type);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes one descriptor into a slot.
+     *
+     * @param type The array.
+     * @param index The slot.
+     * @param bufferInfo The buffer of a storage buffer slot, otherwise nullptr.
+     * @param imageInfo The image or sampler of the other slots, otherwise nullptr.
+     */
+    void writeSlot(BindlessType type, uint32_t index, const VkDescriptorBufferInfo* bufferInfo,
+                   const VkDescriptorImageInfo* imageInfo);
 };
 // ================================================================================
 // ================================================================================ 
@@ -448,6 +779,20 @@ private:
  * This class encapsulates the creation and management of the Vulkan graphics pipeline,
  * including framebuffers, render passes, and shader modules. It also handles command buffer
  * recording for rendering.
+ *
+ * A frame is recorded through the RenderGraph as three passes: the streamed uploads, the
+ * GPU culling pass and the scene render pass. The graph derives the barriers between
+ * them from the buffers and swap chain image each pass declares, and it owns the layout
+ * transitions of the swap chain image, so the render pass keeps that image in the color
+ * attachment layout from start to end.
+ *
+ * Every pipeline depth tests against a depth image that the render graph creates from the
+ * FramebufferAttachments description. With multisampling, the pipelines draw into a
+ * multisampled color image of the render graph, which the render pass resolves into the
+ * swap chain image.
+ * With the depth pre-pass enabled, the scene is first drawn by depth-only pipelines without
+ * a fragment shader, and then drawn again with an EQUAL depth test and depth writes off, so
+ * the fragment shader runs once per pixel no matter how many layers cover it.
  */
 class GraphicsPipeline {
 public:
@@ -462,21 +807,35 @@ public:
      * @param swapChain Reference to the swap chain.
      * @param commandBufferManager Reference to the CommandBufferManager, used for managing command buffers.
      * @param bufferManager Reference to the BufferManager, which provides vertex and index buffers.
-     * @param descriptorManager Reference to the DescriptorManager, which provides descriptor sets and layouts.
+     * @param descriptorManager Reference to the DescriptorManager whose bindless set the frame data is registered in.
+     * @param drawList Reference to the IndirectDrawList that replays instanced draws indirectly.
+     * @param cullingPass Reference to the CullingPass that frustum culls instanced draws on the GPU.
+     * @param assetStreamer Reference to the AssetStreamer whose uploads are recorded into each frame.
+     * @param attachments Reference to the formats and sample count of the depth and multisampled color images.
+     * @param renderGraph Reference to the empty RenderGraph that the passes of a frame are added to.
      * @param indices The index data for rendering.
      * @param physicalDevice The Vulkan physical device handle.
      * @param vertFile The location of the vertice shader file relative to the executable 
      * @param fragFile The location of the fragmentation shader file relative to the executable
+     * @param instancedVertFile The location of the instanced vertex shader file relative to the executable
+     * @param depthPrepass True to lay down depth in a separate pass before shading.
      */
     GraphicsPipeline(VkDevice device,
                      SwapChain& swapChain,
                      CommandBufferManager& commandBufferManager,
                      BufferManager& bufferManager,
                      DescriptorManager& descirptorManager,
+                     IndirectDrawList& drawList,
+                     CullingPass& cullingPass,
+                     AssetStreamer& assetStreamer,
+                     FramebufferAttachments& attachments,
+                     RenderGraph& renderGraph,
                      const std::vector<uint16_t>& indices,
                      VkPhysicalDevice physicalDevice,
                      std::string vertFile,
-                     std::string fragFile);
+                     std::string fragFile,
+                     std::string instancedVertFile,
+                     bool depthPrepass = false);
  // --------------------------------------------------------------------------------
 
     /**
@@ -491,6 +850,9 @@ public:
     /**
      * @brief Creates framebuffers for each swap chain image view.
      *
+     * The render graph is compiled for the extent first, which creates the depth and multisampled
+     * color images that every framebuffer shares.
+     *
      * @param swapChainImageViews The image views from the swap chain.
      * @param swapChainExtent The extent of the swap chain, i.e., its width and height.
      */
@@ -502,6 +864,7 @@ public:
      * @brief Destroys all the framebuffers.
      *
      * This method cleans up and destroys the Vulkan framebuffers created for the swap chain.
+     * The images they share belong to the render graph and are replaced when it is compiled again.
      */
     void destroyFramebuffers();
 // --------------------------------------------------------------------------------
@@ -509,8 +872,9 @@ public:
     /**
      * @brief Records command buffer for a specific frame and image index.
      *
-     * This method records the commands needed to render a frame, including setting up the
-     * render pass, binding the graphics pipeline, and drawing indexed vertex data.
+     * This method records the commands needed to render a frame by executing the render graph,
+     * which records the uploads, the culling pass and the scene render pass with the barriers
+     * between them.
      *
      * @param frameIndex The index of the current frame in flight.
      * @param imageIndex The index of the swap chain image being rendered to.
@@ -518,6 +882,89 @@ public:
     void recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex);
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Queues a single draw of a mesh for the next recording of a frame.
+     *
+     * The model matrix and material reach the shaders through push constants that are
+     * updated right before the draw, so no buffer is written and no descriptor set is
+     * bound for it. Queued draws are consumed by recordCommandBuffer.
+     *
+     * @param frameIndex The index of the frame the draw belongs to.
+     * @param mesh The mesh to draw.
+     * @param model The model matrix of the draw.
+     * @param materialId The material of the draw.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     */
+    void submitDraw(uint32_t frameIndex, const MeshHandle& mesh, const glm::mat4& model, uint32_t materialId = 0);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Queues an instanced draw of a mesh for the next recording of a frame.
+     *
+     * The instances are written to the frame's instance buffer immediately. When the
+     * device supports a non-zero firstInstance in indirect draws, the draw is appended
+     * to the indirect draw list so every queued mesh is replayed by one indirect call;
+     * otherwise it is drawn with its own vkCmdDrawIndexed call. Queued draws are consumed
+     * by recordCommandBuffer. This method must only be called once the in flight
+     * fence of the frame has been waited on.
+     *
+     * @param frameIndex The index of the frame the draw belongs to.
+     * @param mesh The mesh to draw.
+     * @param instances The per-instance transform and color of each copy.
+     */
+    void submitInstances(uint32_t frameIndex, const MeshHandle& mesh, const std::vector<InstanceData>& instances);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Queues instances of a mesh that are individually frustum culled on the GPU.
+     *
+     * Each instance becomes one culling object whose bounding sphere is the mesh bounds
+     * moved by the instance transform. Surviving instances are drawn indirectly from the
+     * compacted command buffer of the culling pass. Devices without drawIndirectFirstInstance
+     * cannot address the instances from indirect commands, so the same spheres are culled on
+     * the CPU against the matrix last passed to setViewProjection instead, and the survivors
+     * are submitted through submitInstances, one batch per level of detail.
+     *
+     * Every instance draws the level of detail that selectLod picks for it against the
+     * camera last passed to setLodCamera.
+     *
+     * @param frameIndex The index of the frame the draw belongs to.
+     * @param mesh The mesh to draw.
+     * @param instances The per-instance transform and color of each copy.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     */
+    void submitCulledInstances(uint32_t frameIndex, const MeshHandle& mesh,
+                               const std::vector<InstanceData>& instances);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sets the camera that submitCulledInstances selects levels of detail against.
+     *
+     * Until a camera is set, every instance is drawn at full detail.
+     *
+     * @param camera The camera built by makeLodCamera from the view and projection of the frame.
+     */
+    void setLodCamera(const LodCamera& camera);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sets the matrix whose frustum submitCulledInstances culls against on the CPU.
+     *
+     * Until a matrix is set, the CPU fallback of submitCulledInstances draws every instance.
+     *
+     * @param viewProj The product ubo.proj * ubo.view of the frame.
+     */
+    void setViewProjection(const glm::mat4& viewProj);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if the scene is drawn with a depth pre-pass.
+     *
+     * @return True if depth is laid down before shading.
+     */
+    bool isDepthPrepassEnabled() const;
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Retrieves the pipeline layout.
      *
@@ -564,15 +1011,60 @@ private:
     CommandBufferManager& commandBufferManager;/**< Reference to the command buffer manager. */
     BufferManager& bufferManager;             /**< Reference to the buffer manager. */
     DescriptorManager& descriptorManager;     /**< Reference to the descriptor manager. */
+    IndirectDrawList& drawList;               /**< Reference to the indirect draw list. */
+    CullingPass& cullingPass;                 /**< Reference to the GPU culling pass. */
+    AssetStreamer& assetStreamer;             /**< Reference to the background asset streamer. */
+    FramebufferAttachments& attachments;      /**< Reference to the formats of the depth and multisampled color images. */
+    RenderGraph& renderGraph;                 /**< Reference to the render graph that records a frame. */
     std::vector<uint16_t> indices;            /**< Index data for rendering. */
     VkPhysicalDevice physicalDevice;          /**< Vulkan physical device handle. */
     std::string vertFile;                     /**< Vertices Shader File. */ 
     std::string fragFile;                     /**< Fragmentation Shader File. */
+    std::string instancedVertFile;            /**< Instanced Vertices Shader File. */
+    bool depthPrepass;                        /**< True if depth is laid down before shading. */
+
+    /**
+     * @brief A queued instanced draw of one mesh that is recorded directly.
+     */
+    struct InstancedDraw {
+        uint32_t indexCount;                  /**< Number of indices of the mesh. */
+        uint32_t firstIndex;                  /**< First index of the mesh in the shared index buffer. */
+        int32_t vertexOffset;                 /**< Vertex offset of the mesh in the shared vertex buffer. */
+        uint32_t firstInstance;               /**< First instance in the frame's instance buffer. */
+        uint32_t instanceCount;               /**< Number of instances to draw. */
+    };
 
     VkPipelineLayout pipelineLayout;          /**< The Vulkan pipeline layout. */
     VkPipeline graphicsPipeline;              /**< The Vulkan graphics pipeline. */
+    VkPipeline instancedPipeline;             /**< The Vulkan graphics pipeline that consumes per-instance data. */
+    VkPipeline depthPipeline = VK_NULL_HANDLE;          /**< Depth-only variant of graphicsPipeline for the pre-pass. */
+    VkPipeline instancedDepthPipeline = VK_NULL_HANDLE; /**< Depth-only variant of instancedPipeline for the pre-pass. */
+    /**
+     * @brief A queued draw of one mesh whose per-draw data is pushed as constants.
+     */
+    struct ObjectDraw {
+        uint32_t indexCount;                  /**< Number of indices of the mesh. */
+        uint32_t firstIndex;                  /**< First index of the mesh in the shared index buffer. */
+        int32_t vertexOffset;                 /**< Vertex offset of the mesh in the shared vertex buffer. */
+        glm::mat4 model;                      /**< Model matrix of the draw. */
+        uint32_t materialId;                  /**< Material of the draw. */
+    };
+
+    std::array<std::vector<InstancedDraw>, MAX_FRAMES_IN_FLIGHT> instancedDraws; /**< Queued instanced draws per frame. */
+    std::array<std::vector<ObjectDraw>, MAX_FRAMES_IN_FLIGHT> objectDraws;       /**< Queued single draws per frame. */
+    LodCamera lodCamera;                      /**< Camera that levels of detail are selected against. */
+    CpuFrustumCuller cpuCuller;               /**< Culls instances on the CPU when the GPU cannot. */
+    glm::mat4 viewProjection = glm::mat4(1.0f); /**< Matrix whose frustum the CPU culler tests against. */
+    bool hasViewProjection = false;           /**< True once setViewProjection has been called. */
+    std::vector<uint32_t> visibleInstances;   /**< Indices of the instances the CPU culler kept. */
     VkRenderPass renderPass;                  /**< The Vulkan render pass. */
     std::vector<VkFramebuffer> framebuffers;  /**< Framebuffers for each swap chain image. */
+    RenderGraphResource swapChainImage = 0;   /**< The swap chain image imported into the render graph. */
+    RenderGraphResource depthImage = 0;       /**< The transient depth image of the render graph. */
+    RenderGraphResource colorImage = 0;       /**< The transient multisampled color image, if multisampled. */
+    uint32_t recordingFrame = 0;              /**< Frame in flight that the render graph is recording. */
+    uint32_t recordingImage = 0;              /**< Swap chain image that the render graph is recording. */
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> frameDataIndices{}; /**< Bindless storage buffer slot of each frame's uniform buffer. */
 // --------------------------------------------------------------------------------
 
     /**
@@ -614,9 +1106,59 @@ private:
     /**
      * @brief Creates the graphics pipeline.
      *
-     * Sets up all the pipeline stages, including shaders, input assembly, and rasterization.
+     * Creates the shared pipeline layout along with the per-vertex and instanced pipelines,
+     * and their depth-only variants if the depth pre-pass is enabled.
      */
     void createGraphicsPipeline();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Builds a graphics pipeline from a vertex shader and a vertex input layout.
+     *
+     * Sets up all the pipeline stages, including shaders, input assembly, and rasterization.
+     * The fragment shader, pipeline layout and render pass are shared by every pipeline.
+     * A depth-only pipeline has no fragment shader and writes depth but no color.
+     *
+     * @param vertexShaderFile The location of the vertex shader file relative to the executable.
+     * @param bindingDescriptions The vertex input bindings consumed by the vertex shader.
+     * @param attributeDescriptions The vertex input attributes consumed by the vertex shader.
+     * @param depthOnly True to build the pre-pass variant.
+     * @return The created graphics pipeline.
+     */
+    VkPipeline buildPipeline(const std::string& vertexShaderFile,
+                             const std::vector<VkVertexInputBindingDescription>& bindingDescriptions,
+                             const std::vector<VkVertexInputAttributeDescription>& attributeDescriptions,
+                             bool depthOnly = false);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records every draw of a frame with either the depth-only or the shading pipelines.
+     *
+     * @param commandBuffer The command buffer being recorded inside the render pass.
+     * @param frameIndex The index of the current frame in flight.
+     * @param depthOnly True to record the pre-pass.
+     */
+    void recordDraws(VkCommandBuffer commandBuffer, uint32_t frameIndex, bool depthOnly);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Adds the upload, culling and scene passes of a frame to the render graph.
+     *
+     * The mesh registry buffers and the compacted draw commands are imported as buffers,
+     * and the swap chain image is imported as the output of the frame, arriving undefined
+     * once the acquire semaphore is waited on and left ready to present.
+     */
+    void buildRenderGraph();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the scene render pass with the optional depth pre-pass.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     * @param frameIndex The index of the current frame in flight.
+     * @param imageIndex The index of the swap chain image being rendered to.
+     */
+    void recordScene(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex);
 };
 // ================================================================================
 // ================================================================================
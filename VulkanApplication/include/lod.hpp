@@ -0,0 +1,143 @@
+// ================================================================================
+// ================================================================================
+// - File:    lod.hpp
+// - Purpose: This file contains the quadric error metric simplifier that builds
+//            level of detail chains and the screen space LOD selection.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef lod_HPP
+#define lod_HPP
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+static constexpr uint32_t MAX_MESH_LODS = 4;             /**< Levels of detail of one mesh, including the full mesh. */
+static constexpr float LOD_REDUCTION = 0.5f;             /**< Fraction of triangles each level keeps of the previous one. */
+static constexpr float MIN_LOD_REDUCTION = 0.8f;         /**< Largest fraction a level may keep and still be worth storing. */
+static constexpr float DEFAULT_LOD_PIXEL_ERROR = 1.0f;   /**< Largest projected simplification error in pixels. */
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct MeshLod
+ * @brief One level of detail of a mesh, a range of its index list.
+ *
+ * Every level shares the vertices of the mesh, so a level is drawn by swapping the
+ * first index and index count of the full mesh for its own.
+ */
+struct MeshLod {
+    uint32_t firstIndex = 0;   /**< First index of the level relative to the first index of the mesh. */
+    uint32_t indexCount = 0;   /**< Number of indices of the level. */
+    float error = 0.0f;        /**< Model space distance the level may deviate from the full mesh. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct LodChain
+ * @brief The index lists of every level of detail of a mesh stored back to back.
+ */
+struct LodChain {
+    std::vector<uint16_t> indices;  /**< The full triangle list followed by each coarser level. */
+    std::vector<MeshLod> lods;      /**< The levels from finest to coarsest, at least one. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct LodCamera
+ * @brief The parts of the camera that LOD selection needs.
+ */
+struct LodCamera {
+    glm::vec3 position = glm::vec3(0.0f);  /**< World space position of the camera. */
+    float pixelsPerUnit = 0.0f;            /**< Pixels covered by one world unit at distance one, zero if unknown. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Simplifies a triangle list by collapsing edges in order of their quadric error.
+ *
+ * Follows Garland and Heckbert: every vertex accumulates the area weighted planes of its
+ * triangles, and open edges add a perpendicular plane so that borders and UV seams
+ * keep their outline. Each collapse moves one end of an edge onto the other, so the
+ * result indexes the original vertices and shares their buffer. Collapses that would
+ * flip a triangle are rejected.
+ *
+ * @param indices The triangle list.
+ * @param positions The position of every vertex.
+ * @param targetIndexCount The index count at which to stop collapsing.
+ * @param resultError Receives the root mean square plane distance of the worst collapse.
+ * @return The simplified triangle list, which may stay above the target if no valid collapse remains.
+ * @throws std::invalid_argument If the index count is not a multiple of three or an index is out of range.
+ */
+std::vector<uint16_t> simplifyMesh(const std::vector<uint16_t>& indices,
+                                   const std::vector<glm::vec3>& positions,
+                                   size_t targetIndexCount,
+                                   float& resultError);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Builds up to maxLods levels of detail that each keep about LOD_REDUCTION of the triangles.
+ *
+ * Every coarser level is simplified from the previous one and reordered by
+ * optimizeVertexCache. The chain stops early once simplification keeps more than
+ * MIN_LOD_REDUCTION of the triangles, since such a level would save little.
+ *
+ * @param indices The cache-optimized triangle list, stored unchanged as the first level.
+ * @param positions The position of every vertex.
+ * @param maxLods The largest number of levels, including the first.
+ * @return The concatenated index lists and their levels.
+ * @throws std::invalid_argument If maxLods is zero, the index count is not a multiple of
+ *         three or an index is out of range.
+ */
+LodChain buildLodChain(const std::vector<uint16_t>& indices,
+                       const std::vector<glm::vec3>& positions,
+                       uint32_t maxLods = MAX_MESH_LODS);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Extracts the camera position and projection scale from a view and projection matrix.
+ *
+ * @param view The view matrix.
+ * @param proj The projection matrix, whose [1][1] term is the vertical focal length.
+ * @param viewportHeight The height of the viewport in pixels.
+ * @return The camera used by selectLod.
+ */
+LodCamera makeLodCamera(const glm::mat4& view, const glm::mat4& proj, float viewportHeight);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Picks the coarsest level whose error projects to at most pixelError pixels.
+ *
+ * The error of a level is scaled by the largest axis scale of the transform and
+ * projected at the distance of the nearest point of the bounding sphere, so an
+ * object that contains the camera always uses the first level.
+ *
+ * @param lods The levels from finest to coarsest.
+ * @param lodCount The number of levels.
+ * @param bounds The model space bounding sphere of the mesh.
+ * @param transform The model to world transform of the object.
+ * @param camera The camera returned by makeLodCamera.
+ * @param pixelError The largest accepted projected error in pixels.
+ * @return The index of the selected level, zero if there is only one or the camera is unknown.
+ */
+uint32_t selectLod(const MeshLod* lods, uint32_t lodCount, const glm::vec4& bounds,
+                   const glm::mat4& transform, const LodCamera& camera,
+                   float pixelError = DEFAULT_LOD_PIXEL_ERROR);
+// ================================================================================
+// ================================================================================
+#endif /* lod_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -19,13 +19,133 @@
 
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
+#include <array>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+static constexpr VkDeviceSize UPLOAD_POOL_SIZE = 32ull << 20;        /**< Bytes of the linear upload ring. */
+static constexpr VkDeviceSize UNIFORM_POOL_BLOCK_SIZE = 1ull << 20;  /**< Bytes of each uniform pool block. */
+static constexpr VkDeviceSize DEFRAG_MAX_BYTES_PER_PASS = 64ull << 20; /**< Bytes one defragmentation pass copies at most. */
+static constexpr uint32_t DEFRAG_MAX_ALLOCATIONS_PER_PASS = 16;      /**< Allocations one defragmentation pass moves at most. */
+static constexpr uint32_t DEFRAG_CHECK_INTERVAL = 600;               /**< Frames between fragmentation checks. */
+static constexpr float DEFRAG_FRAGMENTATION_THRESHOLD = 0.5f;        /**< getMovableFragmentation that starts a defragmentation. */
+static constexpr std::chrono::microseconds DEFRAG_TIME_BUDGET{2000}; /**< Time one frame spends defragmenting. */
+// --------------------------------------------------------------------------------
+
+/**
+ * @enum MemoryClass
+ * @brief The lifetime and access pattern of a buffer, which select its pool and memory type.
+ */
+enum class MemoryClass {
+    DeviceLocal = 0,  /**< Long-lived buffers only the GPU touches, such as meshes, in VMA's default pools. */
+    HostWrite = 1,    /**< Mapped buffers the CPU writes sequentially every frame, in VMA's default pools. */
+    Uniform = 2,      /**< Small mapped uniform buffers, in a pool of fixed size blocks. */
+    Upload = 3,       /**< Staging buffers freed in the order they were created, in a linear ring pool. */
+    DirectWrite = 4   /**< Long-lived device local buffers the CPU fills, host visible with ReBAR or unified memory. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct HeapBudget
+ * @brief The memory usage and budget of one memory heap.
+ */
+struct HeapBudget {
+    VkDeviceSize usage = 0;           /**< Bytes the process uses in the heap, including other allocators. */
+    VkDeviceSize budget = 0;          /**< Bytes the process can use before allocations may fail or slow down. */
+    VkDeviceSize blockBytes = 0;      /**< Bytes of the VkDeviceMemory blocks VMA allocated. */
+    VkDeviceSize allocationBytes = 0; /**< Bytes of the VMA allocations placed in those blocks. */
+    VkMemoryHeapFlags flags = 0;      /**< Flags of the heap, such as VK_MEMORY_HEAP_DEVICE_LOCAL_BIT. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Called when the usage of a heap crosses a threshold on its way up.
+ *
+ * The arguments are the heap index, its usage and budget, and the crossed fraction of the budget.
+ */
+using BudgetCallback = std::function<void(uint32_t, const HeapBudget&, float)>;
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Called with the new handle of a buffer that defragmentation moved.
+ */
+using RelocationCallback = std::function<void(VkBuffer)>;
+// --------------------------------------------------------------------------------
+
+/**
+ * @enum AllocationCategory
+ * @brief What an allocation holds, derived from the memory class and usage of its buffer or image.
+ */
+enum class AllocationCategory {
+    Vertex = 0,   /**< Vertex buffers. */
+    Index = 1,    /**< Index buffers. */
+    Uniform = 2,  /**< Uniform buffers. */
+    Staging = 3,  /**< Buffers of MemoryClass::Upload that the CPU fills for transfers. */
+    Image = 4,    /**< Images and the memory aliased between transient images. */
+    Storage = 5,  /**< Storage buffers such as meshlets, instances and draw commands. */
+    Other = 6     /**< Indirect-only and any remaining buffers. */
+};
+static constexpr size_t ALLOCATION_CATEGORY_COUNT = 7;  /**< Number of AllocationCategory values. */
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct CategoryStats
+ * @brief The live allocations of one category.
+ */
+struct CategoryStats {
+    uint32_t allocationCount = 0;     /**< Number of live allocations. */
+    VkDeviceSize bytes = 0;           /**< Bytes of the live allocations. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct MemoryStats
+ * @brief A snapshot of everything the AllocatorManager has allocated.
+ */
+struct MemoryStats {
+    std::array<CategoryStats, ALLOCATION_CATEGORY_COUNT> categories{}; /**< Totals indexed by AllocationCategory. */
+    uint32_t allocationCount = 0;     /**< Number of VMA allocations. */
+    uint32_t blockCount = 0;          /**< Number of VkDeviceMemory blocks. */
+    VkDeviceSize allocationBytes = 0; /**< Bytes of the VMA allocations. */
+    VkDeviceSize blockBytes = 0;      /**< Bytes of the VkDeviceMemory blocks. */
+    VkDeviceSize largestFreeRange = 0; /**< Largest free range inside any block. */
+    float fragmentation = 0.0f;       /**< 1 minus the largest free range over all free bytes, 0 when unfragmented. */
+};
 // ================================================================================
 // ================================================================================
 
 /**
  * @class AllocatorManager
  * @brief Manages Vulkan buffers and memory allocations using the Vulkan Memory Allocator (VMA).
+ *
+ * Buffers are placed by MemoryClass rather than by the deprecated VmaMemoryUsage
+ * values. Long-lived and per-frame buffers stay in VMA's default pools, uniform buffers
+ * share fixed size blocks of their own, and staging buffers come from a single block
+ * linear pool that VMA uses as a ring buffer. Keeping these lifetimes apart stops
+ * short-lived uploads from leaving holes between meshes. A buffer that does not fit its
+ * pool falls back to the default pools.
+ *
+ * With VK_EXT_memory_budget the usage and budget of each heap come from the driver and
+ * include memory other processes and allocators hold. Without it VMA estimates them
+ * from its own allocations and 80% of the heap size.
+ *
+ * Integrated GPUs, software rasterizers and discrete GPUs with resizable BAR let the
+ * host map all of device local memory. On those devices DirectWrite buffers are placed
+ * in host visible device local memory, and writeBuffer fills them without a staging
+ * copy. Elsewhere they are ordinary DeviceLocal buffers, and isHostVisible tells the
+ * caller to stage its data.
+ *
+ * Long sessions fragment the default pools, which defragment compacts with VMA's
+ * incremental defragmentation. Only buffers registered with registerMovableBuffer are
+ * moved. Each one is copied into a new buffer, and its owner is handed the new handle
+ * once no frame in flight can read the old one.
  */
 class AllocatorManager {
 public:
@@ -34,13 +154,18 @@ public:
      * @param physicalDevice The Vulkan physical device.
      * @param device The Vulkan logical device.
      * @param instance The Vulkan instance.
-     * @throws std::runtime_error If the VMA allocator cannot be created.
+     * @param memoryBudget True if VK_EXT_memory_budget was enabled on the device.
+     * @throws std::runtime_error If the VMA allocator or its pools cannot be created.
      */
-    AllocatorManager(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance);
+    AllocatorManager(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance,
+                     bool memoryBudget = false);
 // --------------------------------------------------------------------------------
 
     /**
      * @brief Destructor that cleans up the VMA allocator.
+     *
+     * If an exit stats file was set, the JSON stats are written to it first, so any
+     * allocation still listed there was leaked.
      */
     ~AllocatorManager();
 // --------------------------------------------------------------------------------
@@ -49,12 +174,12 @@ public:
      * @brief Creates a Vulkan buffer and allocates memory for it using VMA.
      * @param size The size of the buffer in bytes.
      * @param usage The usage flags for the buffer (e.g., transfer source, vertex buffer).
-     * @param memoryUsage The memory usage type (e.g., VMA_MEMORY_USAGE_GPU_ONLY).
+     * @param memoryClass The lifetime and access pattern of the buffer, which select its pool.
      * @param buffer A reference to the created Vulkan buffer.
      * @param allocation A reference to the VMA allocation for the buffer's memory.
      * @throws std::runtime_error If buffer creation or memory allocation fails.
      */
-    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage,
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, MemoryClass memoryClass,
                       VkBuffer& buffer, VmaAllocation& allocation);
 // --------------------------------------------------------------------------------
 
@@ -74,6 +199,43 @@ public:
     void unmapMemory(VmaAllocation allocation);
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Flushes CPU writes to a mapped allocation so they are visible to the device.
+     *
+     * This is a no-op for host coherent memory.
+     *
+     * @param allocation The VMA allocation that was written to.
+     * @param offset The byte offset of the written range.
+     * @param size The size of the written range in bytes, or VK_WHOLE_SIZE.
+     * @throws std::runtime_error If the flush fails.
+     */
+    void flushAllocation(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks whether the CPU can write an allocation directly.
+     * @param allocation The VMA allocation.
+     * @return True if the allocation was placed in host visible memory.
+     */
+    bool isHostVisible(VmaAllocation allocation) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Copies data into a host visible allocation and flushes it.
+     *
+     * The range must not be read by a frame in flight. The write is visible to every
+     * command buffer submitted after the call returns. A movable buffer is not moved
+     * while it is written.
+     *
+     * @param allocation The VMA allocation, which must be host visible.
+     * @param offset The byte offset into the allocation.
+     * @param data The data to copy.
+     * @param size The number of bytes to copy.
+     * @throws std::runtime_error If the allocation cannot be mapped or flushed.
+     */
+    void writeBuffer(VmaAllocation allocation, VkDeviceSize offset, const void* data, VkDeviceSize size);
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Destroys a Vulkan buffer and frees its associated memory allocation.
      * @param buffer The Vulkan buffer to destroy.
@@ -82,6 +244,60 @@ public:
     void destroyBuffer(VkBuffer buffer, VmaAllocation allocation);
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Creates a Vulkan image and allocates memory for it using VMA.
+     * @param imageInfo The description of the image.
+     * @param memoryUsage VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, or VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED for transient attachments.
+     * @param image A reference to the created Vulkan image.
+     * @param allocation A reference to the VMA allocation for the image's memory.
+     * @throws std::runtime_error If image creation or memory allocation fails.
+     */
+    void createImage(const VkImageCreateInfo& imageInfo, VmaMemoryUsage memoryUsage,
+                     VkImage& image, VmaAllocation& allocation);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys a Vulkan image and frees its associated memory allocation.
+     * @param image The Vulkan image to destroy.
+     * @param allocation The VMA allocation to free.
+     */
+    void destroyImage(VkImage image, VmaAllocation allocation);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Allocates memory with VMA that is not yet bound to any resource.
+     *
+     * Several images can later be bound to the allocation, as long as they are never used at the same time.
+     *
+     * @param requirements The size, alignment and memory type bits the allocation must satisfy.
+     * @param requiredFlags The memory properties the allocation needs, since VMA_MEMORY_USAGE_AUTO
+     *        cannot pick a memory type without a buffer or image.
+     * @param allocation A reference to the created VMA allocation.
+     * @throws std::runtime_error If the memory cannot be allocated.
+     */
+    void allocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags requiredFlags,
+                        VmaAllocation& allocation);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Binds an image to the start of an allocation created by allocateMemory.
+     * @param allocation The VMA allocation.
+     * @param image The Vulkan image, which must not be bound yet.
+     * @throws std::runtime_error If the image cannot be bound.
+     */
+    void bindImageMemory(VmaAllocation allocation, VkImage image);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Frees an allocation created by allocateMemory.
+     *
+     * The images bound to it must be destroyed by the caller.
+     *
+     * @param allocation The VMA allocation to free.
+     */
+    void freeMemory(VmaAllocation allocation);
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Copies data from one buffer to another.
      * @param srcBuffer The source buffer.
@@ -95,15 +311,269 @@ public:
                     VkQueue graphicsQueue, VkCommandPool commandPool);
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Allocates and begins a primary command buffer for a one time submission.
+     * @param commandPool The command pool to allocate the command buffer from.
+     * @return A command buffer in the recording state.
+     * @throws std::runtime_error If the command buffer cannot be allocated or begun.
+     */
+    VkCommandBuffer beginSingleTimeCommands(VkCommandPool commandPool);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Ends, submits and frees a command buffer created by beginSingleTimeCommands.
+     *
+     * The call blocks until the graphics queue is idle.
+     *
+     * @param commandBuffer The command buffer to submit.
+     * @param graphicsQueue The queue the command buffer is submitted to.
+     * @param commandPool The command pool the command buffer was allocated from.
+     * @throws std::runtime_error If the command buffer cannot be submitted.
+     */
+    void endSingleTimeCommands(VkCommandBuffer commandBuffer, VkQueue graphicsQueue, 
+                               VkCommandPool commandPool);
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Returns the VMA allocator instance.
      * @return The VMA allocator used by this manager.
      */
     VmaAllocator getAllocator() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks whether heap usage and budgets are reported by the driver.
+     * @return True if the allocator was created with VK_EXT_memory_budget.
+     */
+    bool isMemoryBudgetEnabled() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks whether the host can map the device local heap buffers live in.
+     *
+     * This holds for unified memory and for resizable BAR, but not for the small BAR
+     * window of other discrete GPUs.
+     *
+     * @return True if DirectWrite buffers are placed in host visible memory.
+     */
+    bool isDirectWriteEnabled() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the usage and budget of every memory heap.
+     *
+     * The values are refreshed from the driver by updateBudgets and by VMA itself after
+     * enough allocations, and are safe to read from any thread.
+     *
+     * @return One entry per memory heap, in heap index order.
+     */
+    std::vector<HeapBudget> getHeapBudgets() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sets the fractions of a heap's budget whose crossing is reported to a callback.
+     *
+     * A threshold is reported once each time usage rises past it. Replacing the thresholds
+     * forgets which ones were already crossed.
+     *
+     * @param thresholds Fractions of the budget, such as 0.8 for 80%, in any order.
+     * @param callback Called from updateBudgets with the highest threshold crossed by a heap.
+     * @throws std::invalid_argument If a threshold is not positive.
+     */
+    void setBudgetThresholds(std::vector<float> thresholds, BudgetCallback callback);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Refreshes the heap budgets and reports the thresholds crossed since the last call.
+     *
+     * Must be called once per frame from the render thread.
+     */
+    void updateBudgets();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Totals the live allocations by category and measures fragmentation.
+     *
+     * Walks every VMA block, so it is meant for diagnostics rather than every frame.
+     *
+     * @return The current statistics.
+     */
+    MemoryStats getMemoryStats() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes the JSON built by vmaBuildStatsString to a file.
+     *
+     * Every allocation is listed with its category as its name.
+     *
+     * @param filename The path of the file to write.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void writeStatsJson(const std::string& filename) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sets a file the JSON stats are written to when the manager is destroyed.
+     *
+     * @param filename The path of the file, or an empty string to write nothing.
+     */
+    void setExitStatsFile(const std::string& filename);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Lets defragmentation move a buffer of the default pools.
+     *
+     * The buffer must be created by createBuffer with MemoryClass::DeviceLocal or
+     * MemoryClass::DirectWrite and be usable as both the source and the destination of
+     * a copy. It may be written with writeBuffer, which maps it only for the length of
+     * the call and never overlaps a defragmentation pass, but must not be held mapped
+     * through mapMemory. It stays registered until destroyBuffer is called.
+     *
+     * @param buffer The buffer.
+     * @param allocation The allocation of the buffer.
+     * @param size The size the buffer was created with.
+     * @param usage The usage the buffer was created with.
+     * @param onMoved Receives the new handle after a move, and must update every reference to the buffer.
+     * @throws std::invalid_argument If the usage lacks transfer source or destination, or the
+     *         allocation was not made by createBuffer in a default pool.
+     */
+    void registerMovableBuffer(VkBuffer buffer, VmaAllocation allocation, VkDeviceSize size,
+                               VkBufferUsageFlags usage, RelocationCallback onMoved);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Measures how fragmented the memory is that defragmentation could compact.
+     *
+     * Each memory type holding a registered movable buffer is measured as 1 minus its
+     * largest free range over its free bytes, counting only VMA's default pools. The
+     * upload ring and the uniform pool are never defragmented and are left out.
+     *
+     * @return The worst fragmentation of those memory types, 0 when none is fragmented.
+     */
+    float getMovableFragmentation() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Starts compacting the default pools, unless a defragmentation is already running.
+     *
+     * @return True if a new defragmentation was started.
+     * @throws std::runtime_error If VMA cannot start the defragmentation.
+     */
+    bool beginDefragmentation();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Runs defragmentation passes until the time budget is spent or nothing is left to move.
+     *
+     * Each pass copies at most DEFRAG_MAX_BYTES_PER_PASS with a single submission and
+     * waits for the queue to go idle, after which the old buffers are destroyed and their
+     * owners are told about the new ones. At least one pass runs per call, so spreading
+     * calls over frames keeps each stall short.
+     *
+     * @param commandPool The command pool the copy command buffer is allocated from.
+     * @param queue The queue every frame is submitted to.
+     * @param timeBudget The time after which no further pass is started.
+     * @throws std::runtime_error If a pass cannot be run, which also ends the defragmentation.
+     */
+    void defragment(VkCommandPool commandPool, VkQueue queue, std::chrono::microseconds timeBudget);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks whether a defragmentation is running.
+     * @return True between beginDefragmentation and the pass that finishes it.
+     */
+    bool isDefragmenting() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves what the last finished defragmentation achieved.
+     * @return The bytes and allocations moved and the bytes and blocks freed.
+     */
+    const VmaDefragmentationStats& getLastDefragmentationStats() const;
 // ================================================================================
 private:
     VkDevice device;
     VmaAllocator allocator;
+    bool memoryBudgetEnabled;              /**< True if VK_EXT_memory_budget backs the budgets. */
+    bool directWriteEnabled = false;       /**< True if the main device local heap is host visible. */
+    uint32_t frameNumber = 0;              /**< Frames counted by updateBudgets, passed on to VMA. */
+    std::vector<float> budgetThresholds;   /**< Reported fractions of the budget, ascending. */
+    BudgetCallback budgetCallback;         /**< Receives threshold crossings. */
+    std::vector<size_t> budgetLevels;      /**< Number of thresholds each heap was past at the last update. */
+    std::string exitStatsFile;             /**< File the stats are written to on destruction, if not empty. */
+
+    VmaPool uploadPool = VK_NULL_HANDLE;   /**< Single block linear pool used as a ring for staging buffers. */
+    VmaPool uniformPool = VK_NULL_HANDLE;  /**< Pool of fixed size blocks for uniform buffers. */
+    uint32_t uploadPoolMemoryType = 0;     /**< Memory type of the upload ring. */
+    uint32_t uniformPoolMemoryType = 0;    /**< Memory type of the uniform pool. */
+
+    /**
+     * @brief What the manager knows about a live allocation.
+     */
+    struct TrackedAllocation {
+        AllocationCategory category;       /**< What the allocation holds. */
+        bool defaultPool;                  /**< True if it lives in VMA's default pools, which defragmentation scans. */
+    };
+
+    /**
+     * @brief A buffer defragmentation may move.
+     */
+    struct MovableBuffer {
+        VkBuffer buffer;                   /**< The current handle of the buffer. */
+        VkDeviceSize size;                 /**< The size of the buffer. */
+        VkBufferUsageFlags usage;          /**< The usage of the buffer. */
+        RelocationCallback onMoved;        /**< Receives the new handle after a move. */
+    };
+
+    mutable std::mutex trackingMutex;      /**< Guards the tracked allocations, which loader threads also create. */
+    std::unordered_map<VmaAllocation, TrackedAllocation> trackedAllocations; /**< Every live allocation. */
+
+    mutable std::mutex defragmentationMutex; /**< Serializes defragmentation passes with writeBuffer and with frees. */
+    VmaDefragmentationContext defragmentationContext = VK_NULL_HANDLE; /**< The running defragmentation, if any. */
+    VmaDefragmentationStats lastDefragmentationStats{};                /**< Results of the last defragmentation. */
+    std::unordered_map<VmaAllocation, MovableBuffer> movableBuffers;   /**< Buffers that may be moved. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the upload ring and the uniform pool.
+     * @throws std::runtime_error If no memory type fits a pool or a pool cannot be created.
+     */
+    void createPools();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the pools, whose allocations must already be freed.
+     */
+    void destroyPools();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the category of a new allocation and names it after the category.
+     * @param allocation The new VMA allocation.
+     * @param category The category of the allocation.
+     * @param defaultPool True if the allocation was placed in VMA's default pools.
+     */
+    void track(VmaAllocation allocation, AllocationCategory category, bool defaultPool);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Forgets an allocation that is about to be freed.
+     *
+     * The caller must hold defragmentationMutex until the allocation is freed. Passes run
+     * to completion under the same lock, so the free never races a move and a running
+     * defragmentation carries on without the allocation.
+     *
+     * @param allocation The VMA allocation, which may be VK_NULL_HANDLE.
+     */
+    void untrack(VmaAllocation allocation);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Ends the running defragmentation and keeps its statistics.
+     *
+     * The caller must hold defragmentationMutex.
+     */
+    void endDefragmentation();
 };
 // ================================================================================
 // ================================================================================
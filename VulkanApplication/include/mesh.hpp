@@ -0,0 +1,424 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh.hpp
+// - Purpose: This file contains a registry that sub-allocates many meshes out of
+//            a single shared vertex, index and meshlet buffer.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef mesh_HPP
+#define mesh_HPP
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <limits>
+
+#include "memory.hpp"
+#include "graphics.hpp"
+#include "lod.hpp"
+#include "mesh_file.hpp"
+#include "mesh_optimizer.hpp"
+#include "meshlet.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Identifier returned for a mesh that does not exist.
+ */
+static constexpr uint32_t INVALID_MESH_ID = std::numeric_limits<uint32_t>::max();
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct MeshHandle
+ * @brief Lightweight description of a mesh that lives inside the shared buffers.
+ *
+ * The fields map directly onto the arguments of vkCmdDrawIndexed and
+ * VkDrawIndexedIndirectCommand, so a handle is all that is needed to draw a mesh
+ * once the shared vertex and index buffers are bound.
+ *
+ * A mesh with levels of detail stores every level back to back in its index range.
+ * The first and index count of the handle describe the full detail level, and
+ * getLodHandle narrows a handle to any of the others.
+ */
+struct MeshHandle {
+    uint32_t id = INVALID_MESH_ID;  /**< Registry identifier of the mesh. */
+    uint32_t firstIndex = 0;        /**< First index of the mesh within the shared index buffer. */
+    int32_t vertexOffset = 0;       /**< Value added to each index to address the shared vertex buffer. */
+    uint32_t indexCount = 0;        /**< Number of indices that make up the full detail level of the mesh. */
+    uint32_t vertexCount = 0;       /**< Number of vertices that make up the mesh. */
+    uint32_t firstMeshlet = 0;      /**< First meshlet of the mesh within the shared meshlet buffer. */
+    uint32_t meshletCount = 0;      /**< Number of meshlets, zero if the mesh is only culled as a whole. */
+    glm::vec4 bounds = glm::vec4(0.0f); /**< Model space bounding sphere, center in xyz and radius in w. */
+    uint32_t lodCount = 1;          /**< Number of valid entries of lods. */
+    std::array<MeshLod, MAX_MESH_LODS> lods{}; /**< Levels of detail from finest to coarsest. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Narrows a mesh handle to one of its levels of detail.
+ *
+ * Meshlets are only built for the full detail level, so coarser levels are culled
+ * as a whole.
+ *
+ * @param mesh The handle of the mesh.
+ * @param lod The level, which must be less than mesh.lodCount.
+ * @return A copy of the handle that draws the level.
+ * @throws std::out_of_range If the level does not exist.
+ */
+MeshHandle getLodHandle(const MeshHandle& mesh, uint32_t lod);
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class MeshRegistry
+ * @brief Sub-allocates meshes out of large shared device local vertex and index buffers.
+ *
+ * The registry owns one vertex buffer and one index buffer that are allocated once
+ * with a fixed capacity. Each mesh receives a range of each buffer through a VMA
+ * virtual block, whose sizes are expressed in vertices and indices rather than bytes.
+ * Meshes split into meshlets also receive a range of a third storage buffer that
+ * holds their Meshlet records, which CullingPass reads to cull clusters of triangles.
+ * Because every mesh lives in the same two buffers, the buffers can be bound once
+ * per frame and every mesh can be drawn by offset, which is a prerequisite for
+ * indirect and multi-draw rendering.
+ *
+ * Removed meshes are retired rather than freed immediately, since frames that are
+ * still in flight may reference them. Their ranges are returned to the virtual
+ * blocks by processRetiredMeshes once MAX_FRAMES_IN_FLIGHT frames have passed.
+ *
+ * Defragmentation may move each shared buffer as a whole, but it never compacts the
+ * ranges inside them. Adding and removing meshes of different sizes can therefore
+ * leave free ranges too small for the next mesh, even while the buffer has room.
+ */
+class MeshRegistry {
+public:
+    static constexpr VkDeviceSize DEFAULT_MAX_VERTICES = 1 << 20; /**< Default vertex capacity. */
+    static constexpr VkDeviceSize DEFAULT_MAX_INDICES = 1 << 22;  /**< Default index capacity. */
+    static constexpr VkDeviceSize DEFAULT_MAX_MESHLETS = 1 << 16; /**< Default meshlet capacity. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Constructor for MeshRegistry.
+     *
+     * @param allocatorManager A reference to the AllocatorManager responsible for memory allocation.
+     * @param commandPool The command pool used to allocate transfer command buffers.
+     * @param graphicsQueue The Vulkan queue used for submitting transfer commands.
+     * @param maxVertices The number of vertices the shared vertex buffer can hold.
+     * @param maxIndices The number of indices the shared index buffer can hold.
+     * @param maxMeshlets The number of meshlets the shared meshlet buffer can hold.
+     * @throws std::runtime_error If the shared buffers or virtual blocks cannot be created.
+     */
+    MeshRegistry(AllocatorManager& allocatorManager,
+                 VkCommandPool commandPool,
+                 VkQueue graphicsQueue,
+                 VkDeviceSize maxVertices = DEFAULT_MAX_VERTICES,
+                 VkDeviceSize maxIndices = DEFAULT_MAX_INDICES,
+                 VkDeviceSize maxMeshlets = DEFAULT_MAX_MESHLETS);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destructor for MeshRegistry.
+     *
+     * Releases every mesh and destroys the shared buffers.
+     */
+    ~MeshRegistry();
+// --------------------------------------------------------------------------------
+
+    MeshRegistry(const MeshRegistry&) = delete;
+    MeshRegistry& operator=(const MeshRegistry&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sub-allocates space for a mesh and uploads its vertex and index data.
+     *
+     * The triangles and vertices are first reordered by optimizeMesh for post-transform
+     * cache and vertex fetch locality, then the vertices are encoded into RenderVertex, the
+     * layout selected by the VERTEX_FORMAT CMake option, before they are uploaded.
+     * Vertices that no index references are dropped. The optimized triangle list is
+     * then split into meshlets, which are uploaded alongside it, and simplified by
+     * buildLodChain into coarser levels that follow it in the index range.
+     *
+     * @param vertices The vertex data of the mesh.
+     * @param indices The index data of the mesh, relative to the first vertex of the mesh.
+     * @return A handle describing where the mesh lives in the shared buffers.
+     * @throws std::invalid_argument If either vector is empty, the index count is not a multiple
+     *         of three, an index is out of range, or a position cannot be encoded.
+     * @throws std::runtime_error If the shared buffers are full or the upload fails.
+     */
+    MeshHandle addMesh(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sub-allocates space for a mesh file and uploads its blobs.
+     *
+     * The vertex and index blobs are copied from the mapping straight into the staging
+     * buffer, so the file must already store vertices in the RenderVertex layout. A file
+     * without a bounding sphere is given one of infinite radius so it is never culled.
+     * The meshlet section of the file, if any, is uploaded as well. Mesh files hold
+     * no levels of detail, so the mesh is always drawn at full detail.
+     *
+     * @param file The mapped mesh file.
+     * @return A handle describing where the mesh lives in the shared buffers.
+     * @throws std::runtime_error If the vertex layout of the file differs from RenderVertex,
+     *         its meshlets are invalid, the shared buffers are full or the upload fails.
+     */
+    MeshHandle addMesh(const MappedMeshFile& file);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if a mesh file stores vertices in the RenderVertex layout of this build.
+     *
+     * A meshlet section, if present, must hold Meshlet records that stay inside the
+     * index range of the file.
+     *
+     * @param file The mapped mesh file.
+     * @return True if the blobs of the file can be copied into the shared buffers unchanged.
+     */
+    static bool isCompatible(const MappedMeshFile& file);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sub-allocates space for a mesh without uploading anything.
+     *
+     * The caller is responsible for copying RenderVertex data, 16 bit indices and
+     * Meshlet records into the returned ranges of getVertexBuffer, getIndexBuffer and
+     * getMeshletBuffer, and for not drawing
+     * the mesh until those copies have completed. This lets uploads be recorded into
+     * a frame's command buffer instead of waiting on a dedicated submission.
+     *
+     * @param vertexCount The number of vertices to reserve.
+     * @param indexCount The number of indices to reserve.
+     * @param bounds The model space bounding sphere of the mesh.
+     * @param meshletCount The number of meshlets to reserve, zero for none.
+     * @param lods The levels of detail within the index range, empty for a single level covering it.
+     * @return A handle describing where the mesh lives in the shared buffers.
+     * @throws std::invalid_argument If the vertex or index count is zero, or there are more than
+     *         MAX_MESH_LODS levels, one of them leaves the index range or the first does not start it.
+     * @throws std::runtime_error If the shared buffers are full.
+     */
+    MeshHandle reserveMesh(uint32_t vertexCount, uint32_t indexCount, const glm::vec4& bounds,
+                           uint32_t meshletCount = 0, const std::vector<MeshLod>& lods = {});
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Removes a mesh from the registry.
+     *
+     * The mesh can no longer be retrieved after this call, but its ranges are only
+     * returned to the shared buffers once no frame in flight can reference them.
+     *
+     * @param meshId The identifier of the mesh to remove.
+     * @throws std::out_of_range If the mesh does not exist.
+     */
+    void removeMesh(uint32_t meshId);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Advances the registry by one frame and frees retired meshes that are no longer in flight.
+     *
+     * This method should be called once per frame after the in flight fence of the
+     * frame has been waited on.
+     */
+    void processRetiredMeshes();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the handle of a mesh.
+     *
+     * @param meshId The identifier of the mesh.
+     * @return A reference to the handle of the mesh.
+     * @throws std::out_of_range If the mesh does not exist.
+     */
+    const MeshHandle& getMesh(uint32_t meshId) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if a mesh exists in the registry.
+     *
+     * @param meshId The identifier of the mesh.
+     * @return True if the mesh exists, false otherwise.
+     */
+    bool containsMesh(uint32_t meshId) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of meshes currently registered.
+     *
+     * @return The number of live meshes.
+     */
+    size_t getMeshCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Binds the shared vertex and index buffers to a command buffer.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     */
+    void bind(VkCommandBuffer commandBuffer) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the shared Vulkan vertex buffer.
+     *
+     * @return The Vulkan buffer holding the vertices of every mesh.
+     */
+    VkBuffer getVertexBuffer() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the shared Vulkan index buffer.
+     *
+     * @return The Vulkan buffer holding the indices of every mesh.
+     */
+    VkBuffer getIndexBuffer() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the shared Vulkan meshlet buffer.
+     *
+     * @return The storage buffer holding the Meshlet records of every mesh.
+     */
+    VkBuffer getMeshletBuffer() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks whether mesh data is written into the shared buffers by the CPU.
+     *
+     * @return True if every shared buffer is host visible, so uploads need no staging copy.
+     */
+    bool isDirectWrite() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes data straight into a shared buffer.
+     *
+     * Only valid when isDirectWrite returns true. The range must belong to a mesh no
+     * frame in flight draws, and the write is visible to every later submission.
+     *
+     * @param buffer The shared vertex, index or meshlet buffer.
+     * @param offset The byte offset into the buffer.
+     * @param data The data to copy.
+     * @param size The number of bytes to copy.
+     * @throws std::invalid_argument If the buffer is not one of the shared buffers.
+     * @throws std::runtime_error If the write fails.
+     */
+    void writeShared(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the index type of the shared index buffer.
+     *
+     * @return The Vulkan index type used by every mesh.
+     */
+    VkIndexType getIndexType() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the vertex cache statistics of the last mesh added from vectors.
+     *
+     * @return The ACMR and ATVR before and after the optimization run by addMesh.
+     */
+    const MeshOptimizationReport& getLastOptimizationReport() const;
+// ================================================================================
+private:
+    /**
+     * @brief Bookkeeping for a single mesh in the shared buffers.
+     */
+    struct MeshRecord {
+        MeshHandle handle;                                   /**< The public description of the mesh. */
+        VmaVirtualAllocation vertexRange = VK_NULL_HANDLE;   /**< Range of the vertex virtual block. */
+        VmaVirtualAllocation indexRange = VK_NULL_HANDLE;    /**< Range of the index virtual block. */
+        VmaVirtualAllocation meshletRange = VK_NULL_HANDLE;  /**< Range of the meshlet virtual block, if any. */
+        uint64_t retireFrame = 0;                            /**< Frame after which a retired mesh may be freed. */
+    };
+
+    AllocatorManager& allocatorManager;            /**< The memory allocator manager for handling buffer memory. */
+    VkCommandPool commandPool;                     /**< Command pool used for transfer command buffers. */
+    VkQueue graphicsQueue;                         /**< The Vulkan queue used for submitting transfer commands. */
+    VkDeviceSize maxVertices;                      /**< Capacity of the shared vertex buffer in vertices. */
+    VkDeviceSize maxIndices;                       /**< Capacity of the shared index buffer in indices. */
+    VkDeviceSize maxMeshlets;                      /**< Capacity of the shared meshlet buffer in meshlets. */
+
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;        /**< Shared Vulkan buffer for storing vertex data. */
+    VkBuffer indexBuffer = VK_NULL_HANDLE;         /**< Shared Vulkan buffer for storing index data. */
+    VkBuffer meshletBuffer = VK_NULL_HANDLE;       /**< Shared Vulkan buffer for storing meshlets. */
+    VmaAllocation vertexBufferAllocation = VK_NULL_HANDLE; /**< Memory allocation handle for the vertex buffer. */
+    VmaAllocation indexBufferAllocation = VK_NULL_HANDLE;  /**< Memory allocation handle for the index buffer. */
+    VmaAllocation meshletBufferAllocation = VK_NULL_HANDLE; /**< Memory allocation handle for the meshlet buffer. */
+    bool directWrite = false;                      /**< True if the CPU writes the shared buffers without staging. */
+    VmaVirtualBlock vertexBlock = VK_NULL_HANDLE;  /**< Virtual block that hands out vertex ranges. */
+    VmaVirtualBlock indexBlock = VK_NULL_HANDLE;   /**< Virtual block that hands out index ranges. */
+    VmaVirtualBlock meshletBlock = VK_NULL_HANDLE; /**< Virtual block that hands out meshlet ranges. */
+
+    std::unordered_map<uint32_t, MeshRecord> meshes; /**< Live meshes keyed by identifier. */
+    std::vector<MeshRecord> retiredMeshes;         /**< Removed meshes waiting for their frames to complete. */
+    uint32_t nextMeshId = 0;                       /**< Identifier assigned to the next mesh. */
+    uint64_t frameNumber = 0;                      /**< Number of frames processed by the registry. */
+    MeshOptimizationReport lastOptimizationReport; /**< Statistics of the last optimized mesh. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the ranges of a mesh to the virtual blocks.
+     *
+     * @param record The mesh whose ranges are freed.
+     */
+    void releaseRecord(const MeshRecord& record);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief One range of data copied into a shared buffer by upload.
+     */
+    struct UploadRegion {
+        const void* data;                          /**< Source of the copy. */
+        VkDeviceSize size;                         /**< Size of the copy in bytes. */
+        VkBuffer dstBuffer;                        /**< Shared buffer the data is copied into. */
+        VkDeviceSize dstOffset;                    /**< Byte offset into the shared buffer. */
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reserves ranges for encoded mesh data, uploads it and registers the mesh.
+     *
+     * @param vertexData Pointer to vertexCount vertices in the RenderVertex layout.
+     * @param vertexCount The number of vertices.
+     * @param indexData Pointer to the index data.
+     * @param indexCount The number of indices.
+     * @param meshletData Pointer to the meshlets, or nullptr if meshletCount is zero.
+     * @param meshletCount The number of meshlets.
+     * @param bounds The model space bounding sphere of the mesh.
+     * @param lods The levels of detail within the index data, empty for a single level.
+     * @return A handle describing where the mesh lives in the shared buffers.
+     * @throws std::runtime_error If the shared buffers are full or the upload fails.
+     */
+    MeshHandle registerMesh(const void* vertexData, uint32_t vertexCount,
+                            const uint16_t* indexData, uint32_t indexCount,
+                            const Meshlet* meshletData, uint32_t meshletCount, const glm::vec4& bounds,
+                            const std::vector<MeshLod>& lods = {});
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Copies ranges of data into the shared buffers through a single staging buffer.
+     *
+     * Host visible shared buffers are written directly instead, see isDirectWrite.
+     *
+     * @param regions The ranges to copy, empty ones are skipped.
+     * @throws std::runtime_error If the staging buffer cannot be created or the copy fails.
+     */
+    void upload(const std::vector<UploadRegion>& regions);
+};
+// ================================================================================
+// ================================================================================
+#endif /* mesh_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,273 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh_file.hpp
+// - Purpose: This file contains the versioned binary mesh format, a loader that
+//            memory maps mesh files and a writer used by the offline converter.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef mesh_file_HPP
+#define mesh_file_HPP
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+static constexpr char MESH_FILE_MAGIC[4] = {'V', 'M', 'S', 'H'};  /**< First four bytes of every mesh file. */
+static constexpr uint32_t MESH_FILE_VERSION = 1;                   /**< Version written by this build. */
+static constexpr uint64_t MESH_FILE_ALIGNMENT = 16;                /**< Alignment of every section. */
+static constexpr uint32_t MAX_MESH_FILE_ATTRIBUTES = 16;           /**< Largest attribute count accepted. */
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Flags of the optional sections of a mesh file.
+ */
+enum MeshFileFlags : uint32_t {
+    MESH_FILE_HAS_BOUNDS = 1u << 0,    /**< The header holds a valid bounding sphere. */
+    MESH_FILE_HAS_MESHLETS = 1u << 1   /**< The file holds a meshlet section. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct MeshFileHeader
+ * @brief Fixed size header at the start of a mesh file.
+ *
+ * Every offset is in bytes from the start of the file and aligned to
+ * MESH_FILE_ALIGNMENT, so each blob can be copied to the GPU exactly as it lies
+ * in the file. The file is little endian.
+ */
+struct MeshFileHeader {
+    char magic[4];              /**< MESH_FILE_MAGIC. */
+    uint32_t version;           /**< MESH_FILE_VERSION of the writer. */
+    uint32_t headerSize;        /**< sizeof(MeshFileHeader) of the writer. */
+    uint32_t flags;             /**< Combination of MeshFileFlags. */
+    uint32_t vertexCount;       /**< Number of vertices. */
+    uint32_t vertexStride;      /**< Size of one vertex in bytes. */
+    uint32_t indexCount;        /**< Number of indices. */
+    uint32_t indexType;         /**< VkIndexType of the indices. */
+    uint32_t attributeCount;    /**< Number of MeshFileAttribute records. */
+    uint32_t meshletCount;      /**< Number of meshlets, zero without a meshlet section. */
+    uint64_t attributeOffset;   /**< Offset of the attribute records. */
+    uint64_t vertexOffset;      /**< Offset of the vertex blob. */
+    uint64_t vertexSize;        /**< Size of the vertex blob. */
+    uint64_t indexOffset;       /**< Offset of the index blob. */
+    uint64_t indexSize;         /**< Size of the index blob. */
+    uint64_t meshletOffset;     /**< Offset of the meshlet section. */
+    uint64_t meshletSize;       /**< Size of the meshlet section. */
+    float bounds[4];            /**< Model space bounding sphere, center in xyz and radius in w. */
+};
+static_assert(sizeof(MeshFileHeader) == 112, "MeshFileHeader must not change size within a version");
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct MeshFileAttribute
+ * @brief Describes one vertex attribute of the vertex blob.
+ */
+struct MeshFileAttribute {
+    uint32_t location;          /**< Shader location of the attribute. */
+    uint32_t format;            /**< VkFormat of the attribute. */
+    uint32_t offset;            /**< Byte offset of the attribute within a vertex. */
+    uint32_t reserved;          /**< Zero. */
+};
+static_assert(sizeof(MeshFileAttribute) == 16, "MeshFileAttribute must not change size within a version");
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class MappedMeshFile
+ * @brief Maps a mesh file into memory and exposes its sections without copying them.
+ *
+ * The constructor validates the header and every section against the size of
+ * the file, so the pointers returned by the accessors are always in bounds. The
+ * mapping lives as long as the object, and the kernel pages the file in as the
+ * blobs are read, which lets a loader copy them straight into a staging buffer.
+ */
+class MappedMeshFile {
+public:
+    /**
+     * @brief Maps and validates a mesh file.
+     *
+     * @param filename The path to the mesh file.
+     * @throws std::runtime_error If the file cannot be mapped or is not a valid mesh file.
+     */
+    explicit MappedMeshFile(const std::string& filename);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destructor for MappedMeshFile.
+     *
+     * Unmaps the file.
+     */
+    ~MappedMeshFile();
+// --------------------------------------------------------------------------------
+
+    MappedMeshFile(const MappedMeshFile&) = delete;
+    MappedMeshFile& operator=(const MappedMeshFile&) = delete;
+    MappedMeshFile(MappedMeshFile&& other) noexcept;
+    MappedMeshFile& operator=(MappedMeshFile&& other) noexcept;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the header of the file.
+     *
+     * @return A reference to the mapped header.
+     */
+    const MeshFileHeader& getHeader() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the vertex attribute records.
+     *
+     * @return The attribute records, one per attribute of the vertex blob.
+     */
+    std::vector<MeshFileAttribute> getAttributes() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if the vertex blob is stored in the layout of a vertex type.
+     *
+     * @param binding The binding description of the expected vertex type.
+     * @param attributes The attribute descriptions of the expected vertex type.
+     * @param attributeCount The number of attribute descriptions.
+     * @return True if the stride and every attribute match, in any order.
+     */
+    bool matchesLayout(const VkVertexInputBindingDescription& binding,
+                       const VkVertexInputAttributeDescription* attributes,
+                       size_t attributeCount) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the vertex blob.
+     *
+     * @return A pointer to getHeader().vertexSize bytes of vertex data.
+     */
+    const void* getVertexData() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the index blob.
+     *
+     * @return A pointer to getHeader().indexSize bytes of index data.
+     */
+    const void* getIndexData() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if the file stores a bounding sphere.
+     *
+     * @return True if getBounds is valid.
+     */
+    bool hasBounds() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the model space bounding sphere.
+     *
+     * @return The sphere, center in xyz and radius in w.
+     */
+    glm::vec4 getBounds() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if the file has a meshlet section.
+     *
+     * @return True if getMeshletData is valid.
+     */
+    bool hasMeshlets() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the meshlet section.
+     *
+     * @return A pointer to getHeader().meshletSize bytes, or nullptr without a meshlet section.
+     */
+    const void* getMeshletData() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the size of the mapped file.
+     *
+     * @return The size in bytes.
+     */
+    size_t getFileSize() const;
+// ================================================================================
+private:
+    std::string filename;                      /**< Path of the mapped file, for error messages. */
+    const unsigned char* data = nullptr;       /**< Start of the mapping. */
+    size_t fileSize = 0;                       /**< Size of the mapping in bytes. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Validates the header and the bounds of every section.
+     *
+     * @throws std::runtime_error If the file is not a valid mesh file.
+     */
+    void validate() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Unmaps the file if it is mapped.
+     */
+    void unmap();
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct MeshFileContents
+ * @brief Everything the writer needs to produce a mesh file.
+ */
+struct MeshFileContents {
+    uint32_t vertexStride = 0;                      /**< Size of one vertex in bytes. */
+    std::vector<MeshFileAttribute> attributes;      /**< Attributes of the vertex blob. */
+    const void* vertexData = nullptr;               /**< Vertex blob. */
+    uint32_t vertexCount = 0;                       /**< Number of vertices. */
+    const uint16_t* indexData = nullptr;            /**< Index blob. */
+    uint32_t indexCount = 0;                        /**< Number of indices. */
+    bool hasBounds = false;                         /**< True if bounds is valid. */
+    glm::vec4 bounds = glm::vec4(0.0f);             /**< Model space bounding sphere. */
+    const void* meshletData = nullptr;              /**< Meshlet section, or nullptr. */
+    uint64_t meshletSize = 0;                       /**< Size of the meshlet section in bytes. */
+    uint32_t meshletCount = 0;                      /**< Number of meshlets. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Writes a mesh file with every section aligned to MESH_FILE_ALIGNMENT.
+ *
+ * @param filename The path of the file to write.
+ * @param contents The sections to write.
+ * @return The number of bytes written.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+size_t writeMeshFile(const std::string& filename, const MeshFileContents& contents);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Converts attribute descriptions to mesh file attribute records.
+ *
+ * @param attributes The attribute descriptions of a vertex type.
+ * @param attributeCount The number of attribute descriptions.
+ * @return One record per description.
+ */
+std::vector<MeshFileAttribute> toMeshFileAttributes(const VkVertexInputAttributeDescription* attributes,
+                                                    size_t attributeCount);
+// ================================================================================
+// ================================================================================
+#endif /* mesh_file_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,181 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh_optimizer.hpp
+// - Purpose: This file contains the index and vertex reordering passes that run
+//            on geometry before it is uploaded to the shared buffers.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef mesh_optimizer_HPP
+#define mesh_optimizer_HPP
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+static constexpr uint32_t FORSYTH_CACHE_SIZE = 32;       /**< LRU cache modelled while reordering triangles. */
+static constexpr uint32_t ANALYSIS_CACHE_SIZE = 16;      /**< FIFO cache modelled when measuring ACMR. */
+static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f; /**< Largest ACMR growth accepted for overdraw. */
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct VertexCacheStatistics
+ * @brief Post-transform cache efficiency of an index buffer.
+ */
+struct VertexCacheStatistics {
+    uint32_t transformedVertices = 0;  /**< Cache misses, each of which runs the vertex shader. */
+    float acmr = 0.0f;                 /**< Average cache miss ratio, transformed vertices per triangle. */
+    float atvr = 0.0f;                 /**< Average transform to vertex ratio, 1.0 is optimal. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct MeshOptimizationReport
+ * @brief Cache efficiency before and after optimizeMesh.
+ */
+struct MeshOptimizationReport {
+    VertexCacheStatistics before;      /**< Statistics of the indices as provided. */
+    VertexCacheStatistics after;       /**< Statistics of the optimized indices. */
+    bool overdrawApplied = false;      /**< True if the overdraw pass kept its reordering. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Simulates a FIFO post-transform cache over a triangle list.
+ *
+ * @param indices The triangle list.
+ * @param vertexCount The number of vertices the indices address.
+ * @param cacheSize The number of entries of the simulated cache.
+ * @return The number of transformed vertices, ACMR and ATVR of the list.
+ * @throws std::invalid_argument If the index count is not a multiple of three.
+ */
+VertexCacheStatistics analyzeVertexCache(const std::vector<uint16_t>& indices, size_t vertexCount,
+                                         uint32_t cacheSize = ANALYSIS_CACHE_SIZE);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Reorders triangles for post-transform cache locality.
+ *
+ * Implements Tom Forsyth's linear-speed vertex cache optimization, which greedily
+ * emits the triangle whose vertices score highest against a modelled LRU cache,
+ * favouring recently used vertices and vertices with few remaining triangles.
+ *
+ * @param indices The triangle list, reordered in place.
+ * @param vertexCount The number of vertices the indices address.
+ * @throws std::invalid_argument If the index count is not a multiple of three or an index is out of range.
+ */
+void optimizeVertexCache(std::vector<uint16_t>& indices, size_t vertexCount);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Reorders cache-optimized triangles so that outward facing clusters are drawn first.
+ *
+ * Follows the second half of Sander, Nehab and Barczak's Tipsify: the triangle list is
+ * split into clusters wherever the cache runs cold and wherever the part drawn since the
+ * last split has amortized its cold start, and the clusters are sorted by
+ * how far their centroid lies along their normal. The result is kept only if its ACMR
+ * stays within threshold times the ACMR of the input. Flat meshes have no preferred
+ * order, so they are returned unchanged.
+ *
+ * @param indices The cache-optimized triangle list, reordered in place.
+ * @param positions The position of every vertex.
+ * @param threshold The largest accepted ratio of output to input ACMR.
+ * @return True if the reordering was kept.
+ * @throws std::invalid_argument If the index count is not a multiple of three or an index is out of range.
+ */
+bool optimizeOverdraw(std::vector<uint16_t>& indices, const std::vector<glm::vec3>& positions,
+                      float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Builds the permutation that orders vertices by their first use in the index list.
+ *
+ * Unreferenced vertices are dropped.
+ *
+ * @param indices The triangle list, remapped in place to the new vertex order.
+ * @param vertexCount The number of vertices the indices address.
+ * @return For each new vertex, the old vertex it is taken from.
+ */
+std::vector<uint32_t> buildVertexFetchRemap(std::vector<uint16_t>& indices, size_t vertexCount);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Reorders vertices for fetch locality so that consecutive indices read nearby memory.
+ *
+ * @tparam VertexT Any vertex type.
+ * @param vertices The vertices, reordered in place. Unreferenced vertices are dropped.
+ * @param indices The triangle list, remapped in place to the new vertex order.
+ */
+template <typename VertexT>
+void optimizeVertexFetch(std::vector<VertexT>& vertices, std::vector<uint16_t>& indices) {
+    std::vector<uint32_t> remap = buildVertexFetchRemap(indices, vertices.size());
+    std::vector<VertexT> reordered;
+    reordered.reserve(remap.size());
+    for (uint32_t oldIndex : remap) {
+        reordered.push_back(vertices[oldIndex]);
+    }
+    vertices.swap(reordered);
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Extracts the positions of 2D vertices as points on the z = 0 plane.
+ *
+ * @tparam VertexT A vertex type with a glm::vec2 pos member, such as Vertex.
+ * @param vertices The vertices.
+ * @return The position of every vertex.
+ */
+template <typename VertexT>
+std::vector<glm::vec3> positionsOf(const std::vector<VertexT>& vertices) {
+    std::vector<glm::vec3> positions;
+    positions.reserve(vertices.size());
+    for (const VertexT& vertex : vertices) {
+        positions.push_back(glm::vec3(vertex.pos, 0.0f));
+    }
+    return positions;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Runs the vertex cache, optional overdraw and vertex fetch passes in that order.
+ *
+ * @tparam VertexT A vertex type with a glm::vec2 pos member, such as Vertex.
+ * @param vertices The vertices, reordered in place.
+ * @param indices The triangle list, reordered and remapped in place.
+ * @param overdraw True to run the overdraw pass.
+ * @return The cache statistics before and after.
+ * @throws std::invalid_argument If the index count is not a multiple of three or an index is out of range.
+ */
+template <typename VertexT>
+MeshOptimizationReport optimizeMesh(std::vector<VertexT>& vertices, std::vector<uint16_t>& indices,
+                                    bool overdraw = false) {
+    MeshOptimizationReport report;
+    report.before = analyzeVertexCache(indices, vertices.size());
+
+    optimizeVertexCache(indices, vertices.size());
+    if (overdraw) {
+        report.overdrawApplied = optimizeOverdraw(indices, positionsOf(vertices));
+    }
+    optimizeVertexFetch(vertices, indices);
+
+    report.after = analyzeVertexCache(indices, vertices.size());
+    return report;
+}
+// ================================================================================
+// ================================================================================
+#endif /* mesh_optimizer_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,92 @@
+// ================================================================================
+// ================================================================================
+// - File:    meshlet.hpp
+// - Purpose: This file contains the meshlet builder that splits a triangle list
+//            into small clusters with bounding spheres and normal cones.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef meshlet_HPP
+#define meshlet_HPP
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+static constexpr uint32_t MESHLET_MAX_VERTICES = 64;    /**< Unique vertices of one meshlet. */
+static constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;  /**< Triangles of one meshlet. */
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct Meshlet
+ * @brief A contiguous run of triangles of a mesh that is culled and drawn on its own.
+ *
+ * The layout matches the std430 Meshlet struct in cull_meshlets.comp. The index
+ * range is relative to the first index of the mesh, so meshlets are stored and
+ * uploaded verbatim wherever the mesh lands in the shared index buffer.
+ *
+ * The cone bounds the normals of every triangle. The camera sees only back faces
+ * of the meshlet when dot(center - camera, cone.xyz) >= cone.w * |center - camera| + radius,
+ * and a cutoff of 1 disables the test for meshlets whose normals spread too far.
+ */
+struct Meshlet {
+    glm::vec4 sphere;        /**< Model space bounding sphere, center in xyz and radius in w. */
+    glm::vec4 cone;          /**< Normal cone axis in xyz and the sine of its half angle in w. */
+    uint32_t firstIndex;     /**< First index of the meshlet relative to the first index of the mesh. */
+    uint32_t indexCount;     /**< Number of indices of the meshlet. */
+    uint32_t vertexCount;    /**< Number of unique vertices the meshlet references. */
+    uint32_t padding;        /**< Pads the struct to the std430 array stride. */
+};
+static_assert(sizeof(Meshlet) == 48, "Meshlet must match the std430 layout in cull_meshlets.comp");
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Splits a triangle list into meshlets.
+ *
+ * Triangles are scanned in order and appended to the current meshlet until either
+ * limit would be exceeded, so every meshlet is a contiguous range of the index list
+ * and the index buffer is drawn unchanged. The list should already be ordered by
+ * optimizeVertexCache, which keeps neighbouring triangles together and yields
+ * compact meshlets with tight bounds and narrow cones.
+ *
+ * @param indices The triangle list.
+ * @param positions The position of every vertex.
+ * @param maxVertices The largest number of unique vertices of one meshlet.
+ * @param maxTriangles The largest number of triangles of one meshlet.
+ * @return The meshlets in index order.
+ * @throws std::invalid_argument If a limit is too small, the index count is not a multiple
+ *         of three or an index is out of range.
+ */
+std::vector<Meshlet> buildMeshlets(const std::vector<uint16_t>& indices,
+                                   const std::vector<glm::vec3>& positions,
+                                   uint32_t maxVertices = MESHLET_MAX_VERTICES,
+                                   uint32_t maxTriangles = MESHLET_MAX_TRIANGLES);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Checks that meshlets cover whole triangles inside the index range of a mesh.
+ *
+ * @param meshlets Pointer to the meshlets.
+ * @param meshletCount The number of meshlets.
+ * @param indexCount The number of indices of the mesh.
+ * @return True if every meshlet can be drawn without reading past the mesh.
+ */
+bool validateMeshlets(const Meshlet* meshlets, size_t meshletCount, uint32_t indexCount);
+// ================================================================================
+// ================================================================================
+#endif /* meshlet_HPP */
+// ================================================================================
+// ================================================================================
+// eof
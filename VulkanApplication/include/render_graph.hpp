@@ -0,0 +1,493 @@
+// ================================================================================
+// ================================================================================
+// - File:    render_graph.hpp
+// - Purpose: This file contains the render graph that orders the passes of a frame,
+//            derives their pipeline barriers and aliases their transient images.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef render_graph_HPP
+#define render_graph_HPP
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "memory.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief The ways a pass can touch a resource of the render graph.
+ *
+ * Every access implies the pipeline stages, memory accesses and, for images, the
+ * layout that getAccessState returns for it.
+ */
+enum class RenderGraphAccess : uint32_t {
+    ColorAttachmentWrite,  /**< Written as a color attachment. */
+    DepthAttachmentWrite,  /**< Tested and written as a depth attachment. */
+    DepthAttachmentRead,   /**< Tested as a read-only depth attachment. */
+    FragmentSampledRead,   /**< Sampled or read as a storage buffer by fragment shaders. */
+    ComputeSampledRead,    /**< Sampled by compute shaders. */
+    ComputeStorageRead,    /**< Read as a storage image or buffer by compute shaders. */
+    ComputeStorageWrite,   /**< Written as a storage image or buffer by compute shaders. */
+    IndirectRead,          /**< Read as indirect draw or dispatch parameters. */
+    VertexInputRead,       /**< Read as vertex or index data. */
+    TransferRead,          /**< Source of a copy or blit. */
+    TransferWrite          /**< Destination of a copy, blit or fill. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct RenderGraphState
+ * @brief The stages, accesses and layout with which a resource was or will be used.
+ */
+struct RenderGraphState {
+    VkPipelineStageFlags stageMask = 0;                /**< Pipeline stages of the use, zero if unused. */
+    VkAccessFlags accessMask = 0;                      /**< Memory accesses of the use. */
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;  /**< Layout of an image, ignored for buffers. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Index of a resource within the render graph that declared it.
+ */
+using RenderGraphResource = uint32_t;
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct RenderGraphUse
+ * @brief One resource that a pass reads or writes.
+ */
+struct RenderGraphUse {
+    RenderGraphResource resource;  /**< The resource. */
+    RenderGraphAccess access;      /**< How the pass touches it. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct TransientImageDesc
+ * @brief Description of an image that the render graph creates and only passes use.
+ *
+ * The usage flags are not part of the description; they are gathered from the
+ * accesses that the passes declare.
+ */
+struct TransientImageDesc {
+    VkFormat format = VK_FORMAT_UNDEFINED;                    /**< Format of the image. */
+    VkExtent2D extent = {0, 0};                               /**< Size of the image, zero for the extent passed to compile. */
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;    /**< Sample count of the image. */
+    VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; /**< Aspects covered by the view of the image. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Retrieves the stages, accesses and layout that an access implies.
+ *
+ * @param access The access.
+ * @return The state of a resource while the access takes place.
+ */
+RenderGraphState getAccessState(RenderGraphAccess access);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Checks if an access modifies the resource.
+ *
+ * @param access The access.
+ * @return True for attachment, storage and transfer writes.
+ */
+bool isWriteAccess(RenderGraphAccess access);
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class RenderGraph
+ * @brief Records the passes of a frame in order with the barriers between them derived from their declared uses.
+ *
+ * Passes are added in submission order along with the resources they read and write,
+ * so a pass can only consume what an earlier pass produced. compile then:
+ *
+ * - Culls every pass whose writes never reach a resource marked with markOutput.
+ * - Tracks the state of each resource through the remaining passes and emits one
+ *   vkCmdPipelineBarrier in front of a pass at most. A read only waits on the last
+ *   write if that write is not yet visible to its stages, reads never wait on each
+ *   other, and a write after reads is an execution dependency with no memory access.
+ *   Hazards on buffers and on images whose layout stays the same are merged into a
+ *   single global memory barrier; only layout changes need image barriers.
+ * - Creates the transient images and places every image whose lifetime, the range of
+ *   passes that use it, does not overlap another into the same VMA allocation. The
+ *   first use of an aliased image discards its contents and waits for the last use
+ *   of the image that occupied the memory before it, cyclically across frames.
+ *   Images that are only ever attachments are created as transient attachments, and
+ *   memory holding nothing else is lazily allocated where the device offers it, so
+ *   tile based GPUs keep them on chip.
+ *
+ * Imported images are owned by the caller, which hands over their handles before each
+ * execute, along with the state they arrive in and the state they must be left in.
+ * Imported buffers are only tracked by name, since global memory barriers do not need
+ * their handles. Hazards between frames on imported resources are the caller's
+ * responsibility; the fence of a frame covers per-frame buffers.
+ *
+ * Barriers are computed once per compile and replayed by every execute, so the graph
+ * is built once and compiled again only when the extent of its transient images changes.
+ */
+class RenderGraph {
+public:
+    /**
+     * @brief Records the commands of a pass.
+     *
+     * The graph is passed along so that the pass can fetch the images it declared.
+     */
+    using ExecuteCallback = std::function<void(VkCommandBuffer, const RenderGraph&)>;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Constructor for RenderGraph.
+     *
+     * @param device The Vulkan logical device handle.
+     * @param allocatorManager A reference to the AllocatorManager that backs the transient images.
+     */
+    RenderGraph(VkDevice device, AllocatorManager& allocatorManager);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destructor for RenderGraph.
+     *
+     * Destroys the transient images and frees their memory.
+     */
+    ~RenderGraph();
+// --------------------------------------------------------------------------------
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Declares an image that the graph creates when it is compiled.
+     *
+     * @param name The name of the image, used in error messages.
+     * @param desc The description of the image.
+     * @return The resource of the image.
+     * @throws std::invalid_argument If the format is undefined.
+     */
+    RenderGraphResource createImage(const std::string& name, const TransientImageDesc& desc);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Declares an image owned by the caller, such as a swap chain image.
+     *
+     * @param name The name of the image, used in error messages.
+     * @param aspectMask The aspects transitioned by image barriers.
+     * @param initialState The state of the image when the command buffer starts, whose
+     *        stages are the ones the first barrier waits on.
+     * @param finalState The state the image is left in, ignored if its stage mask is zero.
+     * @return The resource of the image.
+     */
+    RenderGraphResource importImage(const std::string& name, VkImageAspectFlags aspectMask,
+                                    const RenderGraphState& initialState,
+                                    const RenderGraphState& finalState);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Declares a buffer or a group of buffers owned by the caller.
+     *
+     * @param name The name of the buffer, used in error messages.
+     * @return The resource of the buffer.
+     */
+    RenderGraphResource importBuffer(const std::string& name);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Appends a pass to the graph.
+     *
+     * A resource listed twice is used with the combined stages and accesses of both entries.
+     *
+     * @param name The name of the pass, used in error messages.
+     * @param uses The resources the pass reads and writes.
+     * @param execute The callback that records the pass.
+     * @throws std::out_of_range If a use names an unknown resource.
+     * @throws std::invalid_argument If a transient image is read before a pass writes it,
+     *         or one image is used in two layouts by the same pass.
+     */
+    void addPass(const std::string& name, const std::vector<RenderGraphUse>& uses, ExecuteCallback execute);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Marks a resource as a result of the frame, so the passes writing it are kept.
+     *
+     * @param resource The resource.
+     * @throws std::out_of_range If the resource is unknown.
+     */
+    void markOutput(RenderGraphResource resource);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Culls unused passes, computes the barriers and creates the transient images.
+     *
+     * Any previously created transient images are destroyed first, so the caller must
+     * make sure no frame in flight still uses them.
+     *
+     * @param extent The extent of transient images declared without one.
+     * @throws std::runtime_error If an image or its memory cannot be created.
+     */
+    void compile(VkExtent2D extent);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Hands over the handle of an imported image for the next execute.
+     *
+     * @param resource The imported image.
+     * @param image The image.
+     * @param view The view of the image, returned by getImageView.
+     * @throws std::out_of_range If the resource is unknown.
+     * @throws std::invalid_argument If the resource is not an imported image.
+     */
+    void setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view = VK_NULL_HANDLE);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records every compiled pass preceded by its barrier.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     * @throws std::runtime_error If the graph is not compiled or a barrier needs an imported image without a handle.
+     */
+    void execute(VkCommandBuffer commandBuffer);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the image of a resource.
+     *
+     * @param resource The transient or imported image.
+     * @return The image handle.
+     * @throws std::out_of_range If the resource is unknown.
+     * @throws std::runtime_error If the image does not exist.
+     */
+    VkImage getImage(RenderGraphResource resource) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the view of an image resource.
+     *
+     * @param resource The transient or imported image.
+     * @return The image view handle.
+     * @throws std::out_of_range If the resource is unknown.
+     * @throws std::runtime_error If the image has no view.
+     */
+    VkImageView getImageView(RenderGraphResource resource) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of passes that survived culling.
+     *
+     * @return The number of passes recorded by execute.
+     */
+    uint32_t getCompiledPassCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of pipeline barriers recorded by execute.
+     *
+     * @return The number of vkCmdPipelineBarrier calls per execute.
+     */
+    uint32_t getBarrierCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the memory that backs the transient images.
+     *
+     * @return The sum of the sizes of the aliased allocations in bytes.
+     */
+    VkDeviceSize getTransientMemorySize() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks if a transient image lives in lazily allocated memory.
+     *
+     * @param resource The resource.
+     * @return True if the image is only used as an attachment and the device offered lazily
+     *         allocated memory for it, false for imported resources.
+     * @throws std::out_of_range If the resource is unknown.
+     */
+    bool isLazilyAllocated(RenderGraphResource resource) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the memory the transient images would need without aliasing.
+     *
+     * @return The sum of the sizes of the transient images in bytes.
+     */
+    VkDeviceSize getUnaliasedMemorySize() const;
+// ================================================================================
+private:
+    /**
+     * @brief A transient, imported image or imported buffer.
+     */
+    struct Resource {
+        std::string name;                           /**< Name of the resource. */
+        bool isImage = false;                       /**< True for images. */
+        bool imported = false;                      /**< True if the caller owns the resource. */
+        TransientImageDesc desc;                    /**< Description of a transient image. */
+        VkImageAspectFlags aspectMask = 0;          /**< Aspects transitioned by image barriers. */
+        RenderGraphState initialState;              /**< State of an imported resource at the start of a frame. */
+        RenderGraphState finalState;                /**< State an imported image is left in. */
+        bool output = false;                        /**< True if marked with markOutput. */
+        VkImageUsageFlags usage = 0;                /**< Usage gathered from the compiled passes, plus the transient bit. */
+        VkImage image = VK_NULL_HANDLE;             /**< The image, set by compile or setImportedImage. */
+        VkImageView view = VK_NULL_HANDLE;          /**< The view of the image. */
+        VkMemoryRequirements requirements{};        /**< Memory requirements of a transient image. */
+        uint32_t firstPass = UINT32_MAX;            /**< First compiled pass using the resource. */
+        uint32_t lastPass = 0;                      /**< Last compiled pass using the resource. */
+    };
+
+    /**
+     * @brief A resource as one pass uses it, with duplicate uses merged.
+     */
+    struct PassUse {
+        RenderGraphResource resource;               /**< The resource. */
+        RenderGraphState state;                     /**< Combined state of every use. */
+        bool write = false;                         /**< True if any use writes. */
+        VkImageUsageFlags usage = 0;                /**< Image usage implied by the uses. */
+    };
+
+    /**
+     * @brief A pass and the barrier recorded in front of it.
+     */
+    struct Pass {
+        std::string name;                           /**< Name of the pass. */
+        std::vector<PassUse> uses;                  /**< Merged uses of the pass. */
+        ExecuteCallback execute;                    /**< Callback that records the pass. */
+        bool culled = false;                        /**< True if no output depends on the pass. */
+    };
+
+    /**
+     * @brief A layout transition of one image within a barrier.
+     */
+    struct ImageTransition {
+        RenderGraphResource resource;               /**< The image. */
+        VkAccessFlags srcAccessMask = 0;            /**< Writes made available by the transition. */
+        VkAccessFlags dstAccessMask = 0;            /**< Accesses the transition is made visible to. */
+        VkImageLayout oldLayout;                    /**< Layout before the transition. */
+        VkImageLayout newLayout;                    /**< Layout after the transition. */
+    };
+
+    /**
+     * @brief The merged dependencies recorded by one vkCmdPipelineBarrier.
+     */
+    struct Barrier {
+        VkPipelineStageFlags srcStageMask = 0;      /**< Stages waited on. */
+        VkPipelineStageFlags dstStageMask = 0;      /**< Stages that wait. */
+        VkAccessFlags srcAccessMask = 0;            /**< Writes made available by the global memory barrier. */
+        VkAccessFlags dstAccessMask = 0;            /**< Accesses the global memory barrier makes them visible to. */
+        std::vector<ImageTransition> transitions;   /**< Image layout transitions. */
+    };
+
+    /**
+     * @brief The state of a resource while the compiled passes are simulated.
+     */
+    struct TrackedState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED; /**< Current layout. */
+        VkPipelineStageFlags writeStages = 0;       /**< Stages of the last write or transition. */
+        VkAccessFlags writeAccess = 0;              /**< Memory accesses of the last write. */
+        VkPipelineStageFlags readStages = 0;        /**< Stages that read since the last write. */
+        VkPipelineStageFlags visibleStages = 0;     /**< Stages the last write is visible to. */
+        VkAccessFlags visibleAccess = 0;            /**< Accesses the last write is visible to. */
+    };
+
+    /**
+     * @brief One allocation and the transient images bound to it.
+     */
+    struct AliasedMemory {
+        VmaAllocation allocation = VK_NULL_HANDLE;  /**< The shared memory. */
+        VkMemoryRequirements requirements{};        /**< Combined requirements of every image. */
+        std::vector<RenderGraphResource> images;    /**< The images in the order their lifetimes start. */
+        bool lazilyAllocated = false;               /**< True if the memory is lazily allocated. */
+    };
+
+    VkDevice device;                                /**< Vulkan logical device handle. */
+    AllocatorManager& allocatorManager;             /**< The memory allocator manager for the transient images. */
+    std::vector<Resource> resources;                /**< Every declared resource. */
+    std::vector<Pass> passes;                       /**< Every pass in submission order. */
+    std::vector<uint32_t> compiledPasses;           /**< Indices of the passes that survived culling. */
+    std::vector<Barrier> passBarriers;              /**< Barrier in front of each compiled pass. */
+    Barrier finalBarrier;                           /**< Barrier that moves imported images to their final state. */
+    std::vector<AliasedMemory> aliasedMemory;       /**< Memory shared by transient images. */
+    bool compiled = false;                          /**< True once compile succeeded. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Validates a resource index.
+     *
+     * @param resource The resource.
+     * @throws std::out_of_range If the resource is unknown.
+     */
+    void checkResource(RenderGraphResource resource) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Flags the passes that no output depends on.
+     */
+    void cullPasses();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the transient images and binds images with disjoint lifetimes to shared memory.
+     *
+     * @param extent The extent of transient images declared without one.
+     * @throws std::runtime_error If an image, its memory or its view cannot be created.
+     */
+    void createTransientImages(VkExtent2D extent);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the transient images and frees their memory.
+     */
+    void destroyTransientImages();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Simulates the compiled passes from the start of a frame and derives their barriers.
+     *
+     * @param initialStates The state of every resource at the start of the frame.
+     * @param endStates Receives the state of every resource after the last pass.
+     */
+    void buildBarriers(const std::vector<TrackedState>& initialStates, std::vector<TrackedState>& endStates);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Adds the dependency a use needs on the tracked state of its resource to a barrier.
+     *
+     * @param barrier The barrier recorded in front of the use.
+     * @param tracked The state of the resource, updated to include the use.
+     * @param resource The resource.
+     * @param state The state of the use.
+     * @param write True if the use writes.
+     */
+    void addDependency(Barrier& barrier, TrackedState& tracked, RenderGraphResource resource,
+                       const RenderGraphState& state, bool write) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records a barrier if it has any dependency.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     * @param barrier The barrier.
+     * @throws std::runtime_error If a transitioned image has no handle.
+     */
+    void recordBarrier(VkCommandBuffer commandBuffer, const Barrier& barrier) const;
+};
+// ================================================================================
+// ================================================================================
+#endif /* render_graph_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,250 @@
+// ================================================================================
+// ================================================================================
+// - File:    streaming.hpp
+// - Purpose: This file contains a background asset streamer that loads mesh files
+//            on a worker thread and uploads them under a per-frame budget.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef streaming_HPP
+#define streaming_HPP
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "memory.hpp"
+#include "graphics.hpp"
+#include "mesh.hpp"
+#include "mesh_file.hpp"
+// ================================================================================
+// ================================================================================
+
+static constexpr VkDeviceSize DEFAULT_UPLOAD_BYTES_PER_FRAME = 4 << 20;  /**< Staging bytes copied per frame. */
+static constexpr uint32_t DEFAULT_UPLOAD_COPIES_PER_FRAME = 64;          /**< Copy regions recorded per frame. */
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Residency state of a streamed mesh.
+ */
+enum class Residency {
+    Requested,  /**< Queued for, or being read by, the loader thread. */
+    Uploading,  /**< Ranges are reserved and copies are being recorded across frames. */
+    Resident,   /**< Every copy has completed and the mesh may be drawn. */
+    Failed      /**< The file could not be loaded or did not fit, see getError. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class AssetStreamer
+ * @brief Streams mesh files into the MeshRegistry without stalling the render thread.
+ *
+ * A loader thread maps each requested file, validates it and touches its pages so
+ * that the render thread never waits on disk. The render thread calls recordUploads
+ * once per frame, which copies at most the byte and copy budget of the frame into
+ * that frame's persistently mapped staging buffer and records the transfers into
+ * the frame's command buffer. A mesh larger than the budget is split across as many
+ * frames as it needs. Once the fence of the frame that recorded its last copy has
+ * been waited on, the mesh becomes resident and can be drawn. When the shared buffers
+ * of the MeshRegistry are host visible, the same budget is written into them directly
+ * and nothing is staged or recorded.
+ *
+ * The MeshRegistry is only touched from the render thread, so it needs no locking.
+ */
+class AssetStreamer {
+public:
+    /**
+     * @brief Constructor for AssetStreamer.
+     *
+     * @param allocatorManager A reference to the AllocatorManager responsible for memory allocation.
+     * @param meshRegistry The registry that streamed meshes are added to.
+     * @param uploadBytesPerFrame The largest number of bytes copied in one frame.
+     * @param uploadCopiesPerFrame The largest number of copy regions recorded in one frame.
+     * @throws std::invalid_argument If either budget is zero.
+     * @throws std::runtime_error If the staging buffers cannot be created.
+     */
+    AssetStreamer(AllocatorManager& allocatorManager,
+                  MeshRegistry& meshRegistry,
+                  VkDeviceSize uploadBytesPerFrame = DEFAULT_UPLOAD_BYTES_PER_FRAME,
+                  uint32_t uploadCopiesPerFrame = DEFAULT_UPLOAD_COPIES_PER_FRAME);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destructor for AssetStreamer.
+     *
+     * Stops the loader thread and destroys the staging buffers. The device must be
+     * idle, since frames in flight may still read from the staging buffers.
+     */
+    ~AssetStreamer();
+// --------------------------------------------------------------------------------
+
+    AssetStreamer(const AssetStreamer&) = delete;
+    AssetStreamer& operator=(const AssetStreamer&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Queues a mesh file for streaming.
+     *
+     * @param filename The path to a mesh file written by MeshConverter.
+     * @return The request identifier used to query the residency of the mesh.
+     */
+    uint32_t requestMesh(const std::string& filename);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the residency state of a request.
+     *
+     * @param requestId The identifier returned by requestMesh.
+     * @return The current residency state.
+     * @throws std::out_of_range If the request does not exist.
+     */
+    Residency getResidency(uint32_t requestId) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the handle of a resident mesh.
+     *
+     * @param requestId The identifier returned by requestMesh.
+     * @return The handle of the mesh in the shared buffers.
+     * @throws std::out_of_range If the request does not exist or is not resident.
+     */
+    MeshHandle getMesh(uint32_t requestId) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the reason a request failed.
+     *
+     * @param requestId The identifier returned by requestMesh.
+     * @return The error message, empty unless the request failed.
+     * @throws std::out_of_range If the request does not exist.
+     */
+    std::string getError(uint32_t requestId) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of requests that are not yet resident or failed.
+     *
+     * @return The number of outstanding requests.
+     */
+    size_t getPendingCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Promotes completed uploads and records the copies of this frame.
+     *
+     * Must be called outside a render pass, after the in flight fence of the frame
+     * has been waited on, since that wait is what guarantees that the copies recorded
+     * the last time this frame index was used have completed. The transfer writes are
+     * not made visible to vertex input or compute shaders; the render graph does that
+     * for the passes that read the mesh registry.
+     *
+     * @param commandBuffer The command buffer of the frame being recorded.
+     * @param frameIndex The index of the frame being recorded.
+     * @throws std::out_of_range If the frame index is out of bounds.
+     */
+    void recordUploads(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the number of bytes copied by the last recordUploads call.
+     *
+     * @return The number of bytes, never more than the per-frame budget.
+     */
+    VkDeviceSize getLastUploadBytes() const;
+// ================================================================================
+private:
+    /**
+     * @brief State of a request that is visible to both threads.
+     */
+    struct StreamEntry {
+        std::string filename;                      /**< Path of the mesh file. */
+        Residency residency = Residency::Requested; /**< Current residency state. */
+        MeshHandle mesh;                           /**< Handle in the shared buffers, once reserved. */
+        std::string error;                         /**< Reason the request failed. */
+    };
+
+    /**
+     * @brief A mapped file on its way into the shared buffers.
+     */
+    struct PendingUpload {
+        uint32_t requestId = 0;                    /**< The request the upload belongs to. */
+        std::unique_ptr<MappedMeshFile> file;      /**< The mapping the blobs are copied from. */
+        MeshHandle mesh;                           /**< Ranges reserved for the mesh. */
+        VkDeviceSize vertexBytes = 0;              /**< Size of the vertex blob. */
+        VkDeviceSize indexBytes = 0;               /**< Size of the index blob. */
+        VkDeviceSize meshletBytes = 0;             /**< Size of the meshlet blob, zero without one. */
+        VkDeviceSize copiedBytes = 0;              /**< Bytes of every blob copied so far, in file order. */
+    };
+
+    AllocatorManager& allocatorManager;            /**< The memory allocator manager for handling buffer memory. */
+    MeshRegistry& meshRegistry;                    /**< Registry that owns the shared buffers. */
+    VkDeviceSize uploadBytesPerFrame;              /**< Byte budget of one frame. */
+    uint32_t uploadCopiesPerFrame;                 /**< Copy region budget of one frame. */
+    VkDeviceSize lastUploadBytes = 0;              /**< Bytes copied by the last recordUploads call. */
+
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> stagingBuffers{};          /**< Per-frame staging buffers. */
+    std::array<VmaAllocation, MAX_FRAMES_IN_FLIGHT> stagingAllocations{}; /**< Allocations of the staging buffers. */
+    std::array<unsigned char*, MAX_FRAMES_IN_FLIGHT> stagingMapped{};     /**< Persistent mappings of the staging buffers. */
+    std::array<std::vector<uint32_t>, MAX_FRAMES_IN_FLIGHT> completingRequests; /**< Requests whose last copy each frame recorded. */
+
+    mutable std::mutex streamMutex;                /**< Guards entries, requestQueue, loadedQueue and stopping. */
+    std::condition_variable requestReady;          /**< Wakes the loader thread when a request is queued. */
+    std::unordered_map<uint32_t, StreamEntry> entries; /**< Every request keyed by identifier. */
+    std::deque<uint32_t> requestQueue;             /**< Requests waiting for the loader thread. */
+    std::deque<PendingUpload> loadedQueue;         /**< Files mapped by the loader thread, waiting for ranges. */
+    std::deque<PendingUpload> uploadQueue;         /**< Uploads in progress, only touched by the render thread. */
+    uint32_t nextRequestId = 0;                    /**< Identifier assigned to the next request. */
+    bool stopping = false;                         /**< Set to make the loader thread exit. */
+    std::thread loaderThread;                      /**< Thread that maps and validates files. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Loop run by the loader thread.
+     *
+     * Any exception thrown while loading a file fails that request, the thread keeps running.
+     */
+    void loaderLoop();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Moves files mapped by the loader thread into the upload queue and reserves their ranges.
+     */
+    void reserveLoadedMeshes();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Marks a request as failed.
+     *
+     * @param requestId The request that failed.
+     * @param error The reason it failed.
+     */
+    void fail(uint32_t requestId, const std::string& error);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys every staging buffer that was created.
+     */
+    void destroyBuffers();
+};
+// ================================================================================
+// ================================================================================
+#endif /* streaming_HPP */
+// ================================================================================
+// ================================================================================
+// eof
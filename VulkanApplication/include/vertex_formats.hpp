@@ -0,0 +1,342 @@
+// ================================================================================
+// ================================================================================
+// - File:    vertex_formats.hpp
+// - Purpose: This file contains a family of compact vertex layouts generated from
+//            a compile time template, and the conversion from the float Vertex.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef vertex_formats_HPP
+#define vertex_formats_HPP
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "graphics.hpp"
+#include "vertex_layout.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Encoding of the 2D vertex position.
+ */
+enum class PositionFormat {
+    Float32,  /**< Two 32 bit floats, 8 bytes. */
+    Float16,  /**< Two 16 bit floats, 4 bytes. */
+    Snorm16   /**< Two 16 bit signed normalized integers, 4 bytes. Positions must lie in [-1, 1]. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Encoding of the vertex color.
+ */
+enum class ColorFormat {
+    Float32,  /**< Three 32 bit floats, 12 bytes. */
+    Unorm8    /**< Four 8 bit unsigned normalized integers, 4 bytes, with alpha set to one. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Encoding of the optional vertex normal.
+ */
+enum class NormalFormat {
+    None,           /**< The layout has no normal. */
+    Octahedral16,   /**< Octahedral mapping in two 16 bit signed normalized integers, 4 bytes. */
+    Octahedral8     /**< Octahedral mapping in two 8 bit signed normalized integers, 2 bytes. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Shader location of the normal, placed after the instance attributes at locations 2 to 6.
+ */
+static constexpr uint32_t NORMAL_ATTRIBUTE_LOCATION = 7;
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Converts a float to an IEEE 754 half precision float, rounding to nearest even.
+ *
+ * @param value The value to convert.
+ * @return The bits of the half precision float.
+ */
+uint16_t packHalf(float value);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Converts an IEEE 754 half precision float to a float.
+ *
+ * @param bits The bits of the half precision float.
+ * @return The value as a float.
+ */
+float unpackHalf(uint16_t bits);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Quantizes a value in [-1, 1] to a 16 bit signed normalized integer.
+ *
+ * @param value The value to quantize, clamped to [-1, 1].
+ * @return The signed normalized integer.
+ */
+int16_t packSnorm16(float value);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Quantizes a value in [-1, 1] to an 8 bit signed normalized integer.
+ *
+ * @param value The value to quantize, clamped to [-1, 1].
+ * @return The signed normalized integer.
+ */
+int8_t packSnorm8(float value);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Quantizes a value in [0, 1] to an 8 bit unsigned normalized integer.
+ *
+ * @param value The value to quantize, clamped to [0, 1].
+ * @return The unsigned normalized integer.
+ */
+uint8_t packUnorm8(float value);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Maps a unit vector onto the octahedron and unfolds it into the [-1, 1] square.
+ *
+ * @param normal The vector to encode. It does not need to be normalized.
+ * @return The octahedral coordinates of the direction.
+ */
+glm::vec2 encodeOctahedral(const glm::vec3& normal);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Recovers a unit vector from its octahedral coordinates.
+ *
+ * @param encoded The octahedral coordinates in [-1, 1].
+ * @return The normalized direction.
+ */
+glm::vec3 decodeOctahedral(const glm::vec2& encoded);
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Storage type of each position encoding. The VkFormat follows from the type.
+ */
+template <PositionFormat F> struct PositionTraits;
+
+template <> struct PositionTraits<PositionFormat::Float32> {
+    using Type = glm::vec2;
+    static Type encode(const glm::vec2& pos) { return pos; }
+};
+
+template <> struct PositionTraits<PositionFormat::Float16> {
+    using Type = Half2;
+    static Type encode(const glm::vec2& pos) { return {packHalf(pos.x), packHalf(pos.y)}; }
+};
+
+template <> struct PositionTraits<PositionFormat::Snorm16> {
+    using Type = Snorm16x2;
+    static Type encode(const glm::vec2& pos) { return {packSnorm16(pos.x), packSnorm16(pos.y)}; }
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Storage type of each color encoding. The VkFormat follows from the type.
+ */
+template <ColorFormat F> struct ColorTraits;
+
+template <> struct ColorTraits<ColorFormat::Float32> {
+    using Type = glm::vec3;
+    static Type encode(const glm::vec3& color) { return color; }
+};
+
+template <> struct ColorTraits<ColorFormat::Unorm8> {
+    using Type = Unorm8x4;
+    static Type encode(const glm::vec3& color) {
+        return {packUnorm8(color.x), packUnorm8(color.y), packUnorm8(color.z), 255};
+    }
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Storage type of each normal encoding. The VkFormat follows from the type.
+ */
+template <NormalFormat F> struct NormalTraits;
+
+template <> struct NormalTraits<NormalFormat::Octahedral16> {
+    using Type = Snorm16x2;
+    static Type encode(const glm::vec3& normal) {
+        glm::vec2 encoded = encodeOctahedral(normal);
+        return {packSnorm16(encoded.x), packSnorm16(encoded.y)};
+    }
+};
+
+template <> struct NormalTraits<NormalFormat::Octahedral8> {
+    using Type = Snorm8x2;
+    static Type encode(const glm::vec3& normal) {
+        glm::vec2 encoded = encodeOctahedral(normal);
+        return {packSnorm8(encoded.x), packSnorm8(encoded.y)};
+    }
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Data members of a quantized vertex, with the normal omitted when it is not encoded.
+ */
+template <PositionFormat P, ColorFormat C, NormalFormat N>
+struct QuantizedVertexStorage {
+    typename PositionTraits<P>::Type pos;   /**< Encoded position. */
+    typename ColorTraits<C>::Type color;    /**< Encoded color. */
+    typename NormalTraits<N>::Type normal;  /**< Encoded octahedral normal. */
+};
+
+template <PositionFormat P, ColorFormat C>
+struct QuantizedVertexStorage<P, C, NormalFormat::None> {
+    typename PositionTraits<P>::Type pos;   /**< Encoded position. */
+    typename ColorTraits<C>::Type color;    /**< Encoded color. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct QuantizedVertex
+ * @brief A vertex layout whose attribute encodings are chosen at compile time.
+ *
+ * The attributes are read by the same shaders as Vertex, since every encoding
+ * used here is converted to floats by the vertex input stage: positions land at
+ * location 0 and colors at location 1. The optional normal lands at
+ * NORMAL_ATTRIBUTE_LOCATION as octahedral coordinates that the shader decodes.
+ * Binding and attribute descriptions are generated at compile time from the
+ * storage types the template arguments select.
+ *
+ * @tparam P The position encoding.
+ * @tparam C The color encoding.
+ * @tparam N The normal encoding.
+ */
+template <PositionFormat P, ColorFormat C, NormalFormat N = NormalFormat::None>
+struct QuantizedVertex : QuantizedVertexStorage<P, C, N> {
+    static constexpr PositionFormat POSITION_FORMAT = P;              /**< The position encoding. */
+    static constexpr ColorFormat COLOR_FORMAT = C;                    /**< The color encoding. */
+    static constexpr NormalFormat NORMAL_FORMAT = N;                  /**< The normal encoding. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the binding description for the vertex input.
+     *
+     * @return A VkVertexInputBindingDescription struct that describes binding 0 at vertex rate.
+     */
+    static constexpr VkVertexInputBindingDescription getBindingDescription() {
+        return makeBindingDescription<QuantizedVertex>(0);
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the attribute descriptions for the vertex input.
+     *
+     * @return A std::array of VkVertexInputAttributeDescription structs that describe the vertex attributes.
+     */
+    static constexpr auto getAttributeDescriptions() {
+        using Storage = QuantizedVertexStorage<P, C, N>;
+        if constexpr (N == NormalFormat::None) {
+            return makeAttributeDescriptions(0, VERTEX_MEMBER(Storage, pos), VERTEX_MEMBER(Storage, color));
+        } else {
+            return makeAttributeDescriptions(0, VERTEX_MEMBER(Storage, pos), VERTEX_MEMBER(Storage, color),
+                                             VERTEX_MEMBER_AT(Storage, normal, NORMAL_ATTRIBUTE_LOCATION));
+        }
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Encodes a float vertex.
+     *
+     * @param vertex The float vertex to encode.
+     * @param normal The normal of the vertex, ignored when the layout has no normal.
+     * @return The encoded vertex.
+     */
+    static QuantizedVertex fromVertex(const Vertex& vertex, const glm::vec3& normal = glm::vec3(0.0f, 0.0f, 1.0f)) {
+        QuantizedVertex result;
+        result.pos = PositionTraits<P>::encode(vertex.pos);
+        result.color = ColorTraits<C>::encode(vertex.color);
+        if constexpr (N != NormalFormat::None) {
+            result.normal = NormalTraits<N>::encode(normal);
+        } else {
+            (void) normal;
+        }
+        return result;
+    }
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Checks that every position can be stored as snorm16 without clamping.
+ *
+ * Meshes with a larger extent must be scaled into [-1, 1], with the inverse scale
+ * folded into the model or instance transform.
+ *
+ * @param vertices The float vertices.
+ * @throws std::invalid_argument If a position lies outside [-1, 1].
+ */
+void validateSnormPositions(const std::vector<Vertex>& vertices);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Encodes float vertices into a quantized layout.
+ *
+ * @tparam VertexT A QuantizedVertex instantiation.
+ * @param vertices The float vertices.
+ * @return The encoded vertices.
+ * @throws std::invalid_argument If a position lies outside [-1, 1] and VertexT stores snorm16 positions.
+ */
+template <typename VertexT>
+std::vector<VertexT> convertVertices(const std::vector<Vertex>& vertices) {
+    if constexpr (VertexT::POSITION_FORMAT == PositionFormat::Snorm16) {
+        validateSnormPositions(vertices);
+    }
+
+    std::vector<VertexT> result;
+    result.reserve(vertices.size());
+    for (const Vertex& vertex : vertices) {
+        result.push_back(VertexT::fromVertex(vertex));
+    }
+    return result;
+}
+// ================================================================================
+// ================================================================================
+
+using FullVertex = QuantizedVertex<PositionFormat::Float32, ColorFormat::Float32>;   /**< 20 bytes, lossless. */
+using HalfVertex = QuantizedVertex<PositionFormat::Float16, ColorFormat::Unorm8>;    /**< 8 bytes. */
+using Snorm16Vertex = QuantizedVertex<PositionFormat::Snorm16, ColorFormat::Unorm8>; /**< 8 bytes. */
+
+static_assert(sizeof(FullVertex) == 20, "FullVertex must not contain padding");
+static_assert(sizeof(HalfVertex) == 8, "HalfVertex must not contain padding");
+static_assert(sizeof(Snorm16Vertex) == 8, "Snorm16Vertex must not contain padding");
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief The layout stored in the shared vertex buffer, selected by the VERTEX_FORMAT CMake option.
+ */
+#if defined(VERTEX_FORMAT_HALF)
+using RenderVertex = HalfVertex;
+#elif defined(VERTEX_FORMAT_SNORM16)
+using RenderVertex = Snorm16Vertex;
+#else
+using RenderVertex = FullVertex;
+#endif
+// ================================================================================
+// ================================================================================
+#endif /* vertex_formats_HPP */
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,178 @@
+// ================================================================================
+// ================================================================================
+// - File:    vertex_layout.hpp
+// - Purpose: This file contains compile time generation of Vulkan binding and
+//            attribute descriptions from the member list of a vertex struct.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef vertex_layout_HPP
+#define vertex_layout_HPP
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Packed attribute types whose encoding cannot be told apart from their storage alone.
+ *
+ * An int16_t pair may hold snorm16 or sint16 data, so each encoding gets its own
+ * type and its own VkFormat mapping.
+ */
+struct Half2     { uint16_t x, y; };        /**< Two half floats, VK_FORMAT_R16G16_SFLOAT. */
+struct Half4     { uint16_t x, y, z, w; };  /**< Four half floats, VK_FORMAT_R16G16B16A16_SFLOAT. */
+struct Snorm16x2 { int16_t x, y; };         /**< Two snorm16 values, VK_FORMAT_R16G16_SNORM. */
+struct Snorm16x4 { int16_t x, y, z, w; };   /**< Four snorm16 values, VK_FORMAT_R16G16B16A16_SNORM. */
+struct Snorm8x2  { int8_t x, y; };          /**< Two snorm8 values, VK_FORMAT_R8G8_SNORM. */
+struct Snorm8x4  { int8_t x, y, z, w; };    /**< Four snorm8 values, VK_FORMAT_R8G8B8A8_SNORM. */
+struct Unorm8x4  { uint8_t x, y, z, w; };   /**< Four unorm8 values, VK_FORMAT_R8G8B8A8_UNORM. */
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Maps a vertex member type to the VkFormat of the attribute that reads it.
+ *
+ * FORMAT is the format of one attribute location and LOCATIONS is the number of
+ * consecutive locations the member occupies, which is larger than one for
+ * matrices. Using a type without a specialization fails to compile.
+ *
+ * @tparam T The type of the vertex member.
+ */
+template <typename T>
+struct VertexFormatOf {
+    static_assert(sizeof(T) == 0, "No VkFormat is registered for this vertex member type");
+};
+
+#define REGISTER_VERTEX_FORMAT(TYPE, VK_FORMAT, COUNT)                          \
+    template <> struct VertexFormatOf<TYPE> {                                  \
+        static constexpr VkFormat FORMAT = VK_FORMAT;                          \
+        static constexpr uint32_t LOCATIONS = COUNT;                           \
+        static constexpr uint32_t LOCATION_STRIDE = sizeof(TYPE) / COUNT;      \
+    }
+
+REGISTER_VERTEX_FORMAT(float,      VK_FORMAT_R32_SFLOAT,          1);
+REGISTER_VERTEX_FORMAT(glm::vec2,  VK_FORMAT_R32G32_SFLOAT,       1);
+REGISTER_VERTEX_FORMAT(glm::vec3,  VK_FORMAT_R32G32B32_SFLOAT,    1);
+REGISTER_VERTEX_FORMAT(glm::vec4,  VK_FORMAT_R32G32B32A32_SFLOAT, 1);
+REGISTER_VERTEX_FORMAT(int32_t,    VK_FORMAT_R32_SINT,            1);
+REGISTER_VERTEX_FORMAT(glm::ivec2, VK_FORMAT_R32G32_SINT,         1);
+REGISTER_VERTEX_FORMAT(glm::ivec3, VK_FORMAT_R32G32B32_SINT,      1);
+REGISTER_VERTEX_FORMAT(glm::ivec4, VK_FORMAT_R32G32B32A32_SINT,   1);
+REGISTER_VERTEX_FORMAT(uint32_t,   VK_FORMAT_R32_UINT,            1);
+REGISTER_VERTEX_FORMAT(glm::uvec2, VK_FORMAT_R32G32_UINT,         1);
+REGISTER_VERTEX_FORMAT(glm::uvec3, VK_FORMAT_R32G32B32_UINT,      1);
+REGISTER_VERTEX_FORMAT(glm::uvec4, VK_FORMAT_R32G32B32A32_UINT,   1);
+REGISTER_VERTEX_FORMAT(glm::mat3,  VK_FORMAT_R32G32B32_SFLOAT,    3);
+REGISTER_VERTEX_FORMAT(glm::mat4,  VK_FORMAT_R32G32B32A32_SFLOAT, 4);
+REGISTER_VERTEX_FORMAT(Half2,      VK_FORMAT_R16G16_SFLOAT,       1);
+REGISTER_VERTEX_FORMAT(Half4,      VK_FORMAT_R16G16B16A16_SFLOAT, 1);
+REGISTER_VERTEX_FORMAT(Snorm16x2,  VK_FORMAT_R16G16_SNORM,        1);
+REGISTER_VERTEX_FORMAT(Snorm16x4,  VK_FORMAT_R16G16B16A16_SNORM,  1);
+REGISTER_VERTEX_FORMAT(Snorm8x2,   VK_FORMAT_R8G8_SNORM,          1);
+REGISTER_VERTEX_FORMAT(Snorm8x4,   VK_FORMAT_R8G8B8A8_SNORM,      1);
+REGISTER_VERTEX_FORMAT(Unorm8x4,   VK_FORMAT_R8G8B8A8_UNORM,      1);
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Location value that places a member directly after the previous one.
+ */
+static constexpr uint32_t NEXT_VERTEX_LOCATION = UINT32_MAX;
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief A vertex member whose type, offset and first location are known at compile time.
+ *
+ * Instances are produced by the VERTEX_MEMBER and VERTEX_MEMBER_AT macros.
+ *
+ * @tparam T The type of the vertex member.
+ */
+template <typename T>
+struct VertexMember {
+    uint32_t offset;                          /**< Byte offset of the member within the vertex. */
+    uint32_t location;                        /**< First shader location, or NEXT_VERTEX_LOCATION. */
+};
+
+/**
+ * @brief Describes a member that follows the previous member's locations.
+ */
+#define VERTEX_MEMBER(VERTEX, MEMBER)                                          \
+    VertexMember<decltype(VERTEX::MEMBER)>{                                    \
+        static_cast<uint32_t>(offsetof(VERTEX, MEMBER)), NEXT_VERTEX_LOCATION}
+
+/**
+ * @brief Describes a member that starts at an explicit shader location.
+ */
+#define VERTEX_MEMBER_AT(VERTEX, MEMBER, LOCATION)                             \
+    VertexMember<decltype(VERTEX::MEMBER)>{                                    \
+        static_cast<uint32_t>(offsetof(VERTEX, MEMBER)), LOCATION}
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Builds the binding description of a vertex struct.
+ *
+ * @tparam VertexT The vertex struct.
+ * @param binding The binding index.
+ * @param inputRate Whether the binding advances per vertex or per instance.
+ * @return The binding description, with the stride taken from the size of VertexT.
+ */
+template <typename VertexT>
+constexpr VkVertexInputBindingDescription makeBindingDescription(
+        uint32_t binding, VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX) {
+    return {binding, static_cast<uint32_t>(sizeof(VertexT)), inputRate};
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Builds the attribute descriptions of a list of vertex members.
+ *
+ * Members are assigned locations in order, starting at location 0 unless the first
+ * member gives an explicit location. Members that span several locations, such as
+ * matrices, produce one description per location. The size of the returned array
+ * is computed from the member types, so it can never disagree with the list.
+ *
+ * @param binding The binding index the members are read from.
+ * @param members The members, produced by VERTEX_MEMBER or VERTEX_MEMBER_AT.
+ * @return One attribute description per occupied location.
+ */
+template <typename... Ts>
+constexpr std::array<VkVertexInputAttributeDescription, (VertexFormatOf<Ts>::LOCATIONS + ... + 0)>
+makeAttributeDescriptions(uint32_t binding, VertexMember<Ts>... members) {
+    std::array<VkVertexInputAttributeDescription, (VertexFormatOf<Ts>::LOCATIONS + ... + 0)> descriptions{};
+    size_t index = 0;
+    uint32_t nextLocation = 0;
+
+    auto append = [&](auto member, VkFormat format, uint32_t locations, uint32_t stride) {
+        uint32_t location = member.location == NEXT_VERTEX_LOCATION ? nextLocation : member.location;
+        for (uint32_t i = 0; i < locations; i++) {
+            descriptions[index].location = location + i;
+            descriptions[index].binding = binding;
+            descriptions[index].format = format;
+            descriptions[index].offset = member.offset + i * stride;
+            index++;
+        }
+        nextLocation = location + locations;
+    };
+    (append(members, VertexFormatOf<Ts>::FORMAT, VertexFormatOf<Ts>::LOCATIONS,
+            VertexFormatOf<Ts>::LOCATION_STRIDE), ...);
+
+    return descriptions;
+}
+// ================================================================================
+// ================================================================================
+#endif /* vertex_layout_HPP */
+// ================================================================================
+// ================================================================================
+// eof
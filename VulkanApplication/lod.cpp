@@ -0,0 +1,426 @@
+// ================================================================================
+// ================================================================================
+// - File:    lod.cpp
+// - Purpose: This file contains the implementation of the LOD chain builder and
+//            the screen space LOD selection.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/lod.hpp"
+#include "include/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Weight of the plane that pins an open edge, relative to its squared length.
+ *
+ * Open edges carry no triangle on one side, so without this plane a border vertex
+ * could slide off the outline at no cost.
+ */
+static constexpr double BOUNDARY_WEIGHT = 10.0;
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct Quadric
+ * @brief A weighted sum of squared plane distances, stored as the upper triangle of a symmetric 4x4 matrix.
+ */
+struct Quadric {
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+    double b2 = 0.0, bc = 0.0, bd = 0.0;
+    double c2 = 0.0, cd = 0.0;
+    double d2 = 0.0;
+    double weight = 0.0;   /**< Sum of the weights of the planes. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Builds the quadric of one plane.
+ *
+ * @param normal The unit normal of the plane.
+ * @param point A point on the plane.
+ * @param weight The weight of the plane.
+ * @return The weighted quadric.
+ */
+static Quadric makePlaneQuadric(const glm::vec3& normal, const glm::vec3& point, double weight) {
+    double a = normal.x;
+    double b = normal.y;
+    double c = normal.z;
+    double d = -(a * point.x + b * point.y + c * point.z);
+
+    Quadric q;
+    q.a2 = weight * a * a; q.ab = weight * a * b; q.ac = weight * a * c; q.ad = weight * a * d;
+    q.b2 = weight * b * b; q.bc = weight * b * c; q.bd = weight * b * d;
+    q.c2 = weight * c * c; q.cd = weight * c * d;
+    q.d2 = weight * d * d;
+    q.weight = weight;
+    return q;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Adds one quadric to another.
+ *
+ * @param target The quadric accumulated into.
+ * @param q The quadric added.
+ */
+static void addQuadric(Quadric& target, const Quadric& q) {
+    target.a2 += q.a2; target.ab += q.ab; target.ac += q.ac; target.ad += q.ad;
+    target.b2 += q.b2; target.bc += q.bc; target.bd += q.bd;
+    target.c2 += q.c2; target.cd += q.cd;
+    target.d2 += q.d2;
+    target.weight += q.weight;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Evaluates the mean squared plane distance of the sum of two quadrics at a point.
+ *
+ * @param q The first quadric.
+ * @param r The second quadric.
+ * @param p The point.
+ * @return The weighted sum of squared distances divided by the total weight.
+ */
+static double evaluateQuadrics(const Quadric& q, const Quadric& r, const glm::vec3& p) {
+    double x = p.x;
+    double y = p.y;
+    double z = p.z;
+    double weight = q.weight + r.weight;
+    if (weight <= 0.0) {
+        return 0.0;
+    }
+    double error = (q.a2 + r.a2) * x * x + 2.0 * (q.ab + r.ab) * x * y + 2.0 * (q.ac + r.ac) * x * z +
+                   2.0 * (q.ad + r.ad) * x + (q.b2 + r.b2) * y * y + 2.0 * (q.bc + r.bc) * y * z +
+                   2.0 * (q.bd + r.bd) * y + (q.c2 + r.c2) * z * z + 2.0 * (q.cd + r.cd) * z +
+                   (q.d2 + r.d2);
+    return std::max(error, 0.0) / weight;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Checks that an index list holds whole triangles that address existing vertices.
+ *
+ * @param indices The triangle list.
+ * @param vertexCount The number of vertices.
+ * @throws std::invalid_argument If the index count is not a multiple of three or an index is out of range.
+ */
+static void validateTriangles(const std::vector<uint16_t>& indices, size_t vertexCount) {
+    if (indices.size() % 3 != 0) {
+        throw std::invalid_argument("Index count " + std::to_string(indices.size()) +
+                                    " is not a multiple of three!");
+    }
+    for (uint16_t index : indices) {
+        if (index >= vertexCount) {
+            throw std::invalid_argument("Index " + std::to_string(index) + " addresses one of only " +
+                                        std::to_string(vertexCount) + " vertices!");
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct Collapse
+ * @brief A candidate move of one vertex onto a neighbour, queued by its error.
+ *
+ * The versions are compared against the vertices when the collapse is popped, so
+ * candidates whose ends have changed since they were queued are discarded.
+ */
+struct Collapse {
+    double cost;             /**< Mean squared plane distance after the collapse. */
+    uint32_t from;           /**< Vertex that is removed. */
+    uint32_t to;             /**< Vertex that is kept. */
+    uint32_t fromVersion;    /**< Version of the removed vertex when queued. */
+    uint32_t toVersion;      /**< Version of the kept vertex when queued. */
+
+    bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+// ================================================================================
+// ================================================================================
+
+
+std::vector<uint16_t> simplifyMesh(const std::vector<uint16_t>& indices,
+                                   const std::vector<glm::vec3>& positions,
+                                   size_t targetIndexCount,
+                                   float& resultError) {
+    validateTriangles(indices, positions.size());
+    resultError = 0.0f;
+
+    const size_t vertexCount = positions.size();
+    const size_t triangleCount = indices.size() / 3;
+    std::vector<uint32_t> corners(indices.begin(), indices.end());
+    std::vector<bool> deadTriangles(triangleCount, false);
+    std::vector<std::vector<uint32_t>> adjacency(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+
+    // Step 1: Accumulate the area weighted plane of every triangle and count the triangles of every edge
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    auto edgeKey = [](uint32_t a, uint32_t b) {
+        return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    };
+    std::vector<glm::vec3> normals(triangleCount, glm::vec3(0.0f));
+    for (size_t t = 0; t < triangleCount; t++) {
+        const glm::vec3& p0 = positions[corners[t * 3]];
+        glm::vec3 normal = glm::cross(positions[corners[t * 3 + 1]] - p0, positions[corners[t * 3 + 2]] - p0);
+        float doubleArea = glm::length(normal);
+        if (doubleArea > 0.0f) {
+            normals[t] = normal / doubleArea;
+            Quadric plane = makePlaneQuadric(normals[t], p0, 0.5 * doubleArea);
+            for (int corner = 0; corner < 3; corner++) {
+                addQuadric(quadrics[corners[t * 3 + corner]], plane);
+            }
+        }
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t a = corners[t * 3 + corner];
+            uint32_t b = corners[t * 3 + (corner + 1) % 3];
+            adjacency[a].push_back(static_cast<uint32_t>(t));
+            edgeUses[edgeKey(a, b)]++;
+        }
+    }
+
+    // Step 2: Pin open edges with a plane through the edge perpendicular to its triangle
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t a = corners[t * 3 + corner];
+            uint32_t b = corners[t * 3 + (corner + 1) % 3];
+            if (edgeUses[edgeKey(a, b)] != 1) {
+                continue;
+            }
+            glm::vec3 edge = positions[b] - positions[a];
+            glm::vec3 normal = glm::cross(edge, normals[t]);
+            float length = glm::length(normal);
+            if (length > 0.0f) {
+                Quadric plane = makePlaneQuadric(normal / length, positions[a],
+                                                 BOUNDARY_WEIGHT * glm::dot(edge, edge));
+                addQuadric(quadrics[a], plane);
+                addQuadric(quadrics[b], plane);
+            }
+        }
+    }
+
+    // Step 3: Queue both directions of every edge
+    std::vector<uint32_t> versions(vertexCount, 0);
+    std::vector<bool> removed(vertexCount, false);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+    auto pushCollapse = [&](uint32_t from, uint32_t to) {
+        double cost = evaluateQuadrics(quadrics[from], quadrics[to], positions[to]);
+        queue.push(Collapse{cost, from, to, versions[from], versions[to]});
+    };
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t a = corners[t * 3 + corner];
+            uint32_t b = corners[t * 3 + (corner + 1) % 3];
+            if (a != b) {
+                pushCollapse(a, b);
+                pushCollapse(b, a);
+            }
+        }
+    }
+
+    // Rejects collapses that flip a triangle or pinch the surface into a non-manifold edge
+    std::vector<uint32_t> fromNeighbours;
+    std::vector<uint32_t> toNeighbours;
+    auto isValidCollapse = [&](uint32_t from, uint32_t to) {
+        fromNeighbours.clear();
+        toNeighbours.clear();
+        uint32_t sharedTriangles = 0;
+        for (uint32_t t : adjacency[from]) {
+            if (deadTriangles[t]) {
+                continue;
+            }
+            const uint32_t* tri = &corners[t * 3];
+            fromNeighbours.insert(fromNeighbours.end(), tri, tri + 3);
+            if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                sharedTriangles++;
+                continue;
+            }
+            glm::vec3 p[3];
+            for (int corner = 0; corner < 3; corner++) {
+                p[corner] = positions[tri[corner]];
+            }
+            glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            for (int corner = 0; corner < 3; corner++) {
+                if (tri[corner] == from) {
+                    p[corner] = positions[to];
+                }
+            }
+            glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+            if (glm::dot(before, after) <= 0.0f) {
+                return false;
+            }
+        }
+        for (uint32_t t : adjacency[to]) {
+            if (!deadTriangles[t]) {
+                toNeighbours.insert(toNeighbours.end(), &corners[t * 3], &corners[t * 3] + 3);
+            }
+        }
+
+        // Only the vertices opposite the collapsed edge may neighbour both ends
+        std::sort(fromNeighbours.begin(), fromNeighbours.end());
+        fromNeighbours.erase(std::unique(fromNeighbours.begin(), fromNeighbours.end()), fromNeighbours.end());
+        std::sort(toNeighbours.begin(), toNeighbours.end());
+        toNeighbours.erase(std::unique(toNeighbours.begin(), toNeighbours.end()), toNeighbours.end());
+        uint32_t sharedNeighbours = 0;
+        for (uint32_t vertex : fromNeighbours) {
+            if (vertex != from && vertex != to &&
+                std::binary_search(toNeighbours.begin(), toNeighbours.end(), vertex)) {
+                sharedNeighbours++;
+            }
+        }
+        return sharedNeighbours <= sharedTriangles;
+    };
+
+    // Step 4: Apply the cheapest valid collapse until the target is reached
+    size_t liveIndexCount = indices.size();
+    double worstCost = 0.0;
+    while (liveIndexCount > targetIndexCount && !queue.empty()) {
+        Collapse collapse = queue.top();
+        queue.pop();
+        uint32_t from = collapse.from;
+        uint32_t to = collapse.to;
+        if (removed[from] || removed[to] || versions[from] != collapse.fromVersion ||
+            versions[to] != collapse.toVersion || !isValidCollapse(from, to)) {
+            continue;
+        }
+
+        worstCost = std::max(worstCost, collapse.cost);
+        addQuadric(quadrics[to], quadrics[from]);
+        removed[from] = true;
+        versions[to]++;
+
+        for (uint32_t t : adjacency[from]) {
+            if (deadTriangles[t]) {
+                continue;
+            }
+            uint32_t* tri = &corners[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                deadTriangles[t] = true;
+                liveIndexCount -= 3;
+                continue;
+            }
+            for (int corner = 0; corner < 3; corner++) {
+                if (tri[corner] == from) {
+                    tri[corner] = to;
+                }
+            }
+            adjacency[to].push_back(t);
+        }
+        adjacency[from].clear();
+
+        // Drop dead triangles from the kept vertex and requeue its edges against the merged quadric
+        std::vector<uint32_t>& toTriangles = adjacency[to];
+        toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(),
+                                         [&](uint32_t t) { return deadTriangles[t]; }),
+                          toTriangles.end());
+        for (uint32_t t : toTriangles) {
+            for (int corner = 0; corner < 3; corner++) {
+                uint32_t other = corners[t * 3 + corner];
+                if (other != to) {
+                    pushCollapse(to, other);
+                    pushCollapse(other, to);
+                }
+            }
+        }
+    }
+
+    std::vector<uint16_t> simplified;
+    simplified.reserve(liveIndexCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (!deadTriangles[t]) {
+            for (int corner = 0; corner < 3; corner++) {
+                simplified.push_back(static_cast<uint16_t>(corners[t * 3 + corner]));
+            }
+        }
+    }
+    resultError = static_cast<float>(std::sqrt(worstCost));
+    return simplified;
+}
+// --------------------------------------------------------------------------------
+
+LodChain buildLodChain(const std::vector<uint16_t>& indices,
+                       const std::vector<glm::vec3>& positions,
+                       uint32_t maxLods) {
+    if (maxLods == 0) {
+        throw std::invalid_argument("A LOD chain requires at least one level!");
+    }
+    validateTriangles(indices, positions.size());
+
+    LodChain chain;
+    chain.indices = indices;
+    chain.lods.push_back(MeshLod{0, static_cast<uint32_t>(indices.size()), 0.0f});
+
+    std::vector<uint16_t> current = indices;
+    float error = 0.0f;
+    while (chain.lods.size() < maxLods && current.size() > 3) {
+        size_t target = static_cast<size_t>(current.size() / 3 * LOD_REDUCTION) * 3;
+        float levelError = 0.0f;
+        std::vector<uint16_t> next = simplifyMesh(current, positions, target, levelError);
+        if (next.empty() || next.size() > current.size() * MIN_LOD_REDUCTION) {
+            break;
+        }
+        optimizeVertexCache(next, positions.size());
+
+        // Each level is simplified from the previous one, so their errors add up
+        error += levelError;
+        chain.lods.push_back(MeshLod{static_cast<uint32_t>(chain.indices.size()),
+                                     static_cast<uint32_t>(next.size()), error});
+        chain.indices.insert(chain.indices.end(), next.begin(), next.end());
+        current.swap(next);
+    }
+    return chain;
+}
+// --------------------------------------------------------------------------------
+
+LodCamera makeLodCamera(const glm::mat4& view, const glm::mat4& proj, float viewportHeight) {
+    // The view matrix is a rotation followed by a translation, so the camera sits at -R^T * t
+    glm::vec3 translation(view[3]);
+    LodCamera camera;
+    camera.position = -glm::vec3(glm::dot(glm::vec3(view[0]), translation),
+                                 glm::dot(glm::vec3(view[1]), translation),
+                                 glm::dot(glm::vec3(view[2]), translation));
+    camera.pixelsPerUnit = std::fabs(proj[1][1]) * 0.5f * viewportHeight;
+    return camera;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t selectLod(const MeshLod* lods, uint32_t lodCount, const glm::vec4& bounds,
+                   const glm::mat4& transform, const LodCamera& camera, float pixelError) {
+    if (lodCount <= 1 || camera.pixelsPerUnit <= 0.0f) {
+        return 0;
+    }
+
+    float scale = std::max(glm::length(glm::vec3(transform[0])),
+                           std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+    glm::vec3 center(transform * glm::vec4(glm::vec3(bounds), 1.0f));
+    float distance = glm::length(center - camera.position) - bounds.w * scale;
+    if (!(distance > 0.0f)) {
+        return 0;
+    }
+
+    // Levels grow coarser and their errors grow with them, so take the last one that is small enough
+    uint32_t selected = 0;
+    for (uint32_t i = 1; i < lodCount; i++) {
+        float projectedError = lods[i].error * scale / distance * camera.pixelsPerUnit;
+        if (projectedError > pixelError) {
+            break;
+        }
+        selected = i;
+    }
+    return selected;
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -16,6 +16,8 @@
 #include <iostream>
 #include <stdexcept>
 #include <memory>
+#include <string>
+#include <vector>
 // ================================================================================
 // ================================================================================ 
 
@@ -56,8 +58,41 @@ int main(int argc, const char * argv[]) {
     
     // Call Application 
     try {
+        // --depth-prepass lays down depth before shading, --msaa <samples> sets the preferred
+        // sample count with 1 turning multisampling off, --memory-stats <file> writes the
+        // allocator's JSON stats on exit, and every other argument names a mesh file
+        bool depthPrepass = false;
+        VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_4_BIT;
+        std::string memoryStatsFile;
+        std::vector<std::string> meshFiles;
+        for (int i = 1; i < argc; i++) {
+            std::string argument = argv[i];
+            if (argument == "--depth-prepass") {
+                depthPrepass = true;
+            } else if (argument == "--msaa" && i + 1 < argc) {
+                // Sample count flags are single bits whose value equals the number of samples
+                int samples = std::stoi(argv[++i]);
+                if (samples < 1 || samples > 64 || (samples & (samples - 1)) != 0) {
+                    throw std::invalid_argument("--msaa expects a power of two between 1 and 64!");
+                }
+                msaaSamples = static_cast<VkSampleCountFlagBits>(samples);
+            } else if (argument == "--memory-stats" && i + 1 < argc) {
+                memoryStatsFile = argv[++i];
+            } else {
+                meshFiles.push_back(argv[i]);
+            }
+        }
+
         GLFWwindow* window = create_window(750, 900, "Vulkan Application", false);
-        VulkanApplication triangle(window, vertices, indices);
+        VulkanApplication triangle(window, vertices, indices, depthPrepass, msaaSamples);
+        if (!memoryStatsFile.empty()) {
+            triangle.writeMemoryStatsOnExit(memoryStatsFile);
+        }
+
+        // Any mesh files named on the command line stream in while the application renders
+        for (const std::string& meshFile : meshFiles) {
+            triangle.streamMesh(meshFile);
+        }
 
         triangle.run();
 
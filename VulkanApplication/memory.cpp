@@ -14,29 +14,201 @@
 #define VMA_IMPLEMENTATION
 #include <vk_mem_alloc.h>
 #include "include/memory.hpp"
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <utility>
 // ================================================================================ 
 // ================================================================================
 
-AllocatorManager::AllocatorManager(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance) :
-    device(device){
+// Allocation names in the JSON stats, indexed by AllocationCategory
+static const char* const ALLOCATION_CATEGORY_NAMES[ALLOCATION_CATEGORY_COUNT] = {
+    "vertex", "index", "uniform", "staging", "image", "storage", "other"
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Derives the category of a buffer from its memory class and usage.
+ *
+ * Staging is decided by the memory class, since device local buffers such as the
+ * meshlet buffer also carry TRANSFER_SRC to be copied during defragmentation.
+ *
+ * @param usage The usage flags of the buffer.
+ * @param memoryClass The class the buffer was created with.
+ * @return The category, with vertex, index, uniform and storage usage taking precedence in that order.
+ */
+static AllocationCategory categorizeBuffer(VkBufferUsageFlags usage, MemoryClass memoryClass) {
+    if (memoryClass == MemoryClass::Upload) {
+        return AllocationCategory::Staging;
+    }
+    if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT) {
+        return AllocationCategory::Vertex;
+    }
+    if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
+        return AllocationCategory::Index;
+    }
+    if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
+        return AllocationCategory::Uniform;
+    }
+    if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) {
+        return AllocationCategory::Storage;
+    }
+    return AllocationCategory::Other;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Describes how the memory of a buffer class is chosen, apart from its pool.
+ *
+ * @param memoryClass The class of the buffer.
+ * @param directWrite True if the main device local heap is host visible.
+ * @return The VMA_MEMORY_USAGE_AUTO value and host access flags of the class.
+ */
+static VmaAllocationCreateInfo describeMemoryClass(MemoryClass memoryClass, bool directWrite) {
+    VmaAllocationCreateInfo allocInfo = {};
+    switch (memoryClass) {
+        case MemoryClass::DeviceLocal:
+            allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            break;
+        case MemoryClass::DirectWrite:
+            // VMA may still pick memory the host cannot map, which isHostVisible reports
+            allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            if (directWrite) {
+                allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                  VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT;
+            }
+            break;
+        case MemoryClass::HostWrite:
+        case MemoryClass::Uniform:
+            allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+            allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+            break;
+        case MemoryClass::Upload:
+            allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+            allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+            break;
+    }
+    return allocInfo;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Creates a VMA pool in the memory type a class of buffers would be given.
+ *
+ * @param allocator The VMA allocator.
+ * @param usage The usage of the buffers the pool holds.
+ * @param memoryClass The class of those buffers.
+ * @param poolInfo The pool description, whose memory type index is filled in.
+ * @param name The name of the pool in the JSON stats.
+ * @param memoryTypeIndex Receives the memory type of the pool.
+ * @return The new pool.
+ * @throws std::runtime_error If no memory type fits or the pool cannot be created.
+ */
+static VmaPool createClassPool(VmaAllocator allocator, VkBufferUsageFlags usage, MemoryClass memoryClass,
+                               VmaPoolCreateInfo poolInfo, const char* name, uint32_t& memoryTypeIndex) {
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = 0x10000;  // Any size works, only the usage decides the memory types
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    // Pools never hold DirectWrite buffers
+    VmaAllocationCreateInfo allocInfo = describeMemoryClass(memoryClass, false);
+    if (vmaFindMemoryTypeIndexForBufferInfo(allocator, &bufferInfo, &allocInfo,
+                                            &poolInfo.memoryTypeIndex) != VK_SUCCESS) {
+        throw std::runtime_error(std::string("Failed to find a memory type for the ") + name + " pool!");
+    }
+
+    VmaPool pool = VK_NULL_HANDLE;
+    if (vmaCreatePool(allocator, &poolInfo, &pool) != VK_SUCCESS) {
+        throw std::runtime_error(std::string("Failed to create the ") + name + " pool!");
+    }
+    vmaSetPoolName(allocator, pool, name);
+    memoryTypeIndex = poolInfo.memoryTypeIndex;
+    return pool;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Checks whether the host can map the largest device local heap.
+ *
+ * Unified memory and resizable BAR expose a host visible memory type on that heap. The
+ * 256 MiB BAR window of other discrete GPUs is a heap of its own and does not count.
+ *
+ * @param properties The memory properties of the physical device.
+ * @return True if some memory type is device local and host visible on the largest device local heap.
+ */
+static bool hasHostVisibleDeviceHeap(const VkPhysicalDeviceMemoryProperties& properties) {
+    uint32_t largestHeap = properties.memoryHeapCount;
+    for (uint32_t i = 0; i < properties.memoryHeapCount; i++) {
+        if ((properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) &&
+            (largestHeap == properties.memoryHeapCount ||
+             properties.memoryHeaps[i].size > properties.memoryHeaps[largestHeap].size)) {
+            largestHeap = i;
+        }
+    }
+
+    const VkMemoryPropertyFlags directFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+        if ((properties.memoryTypes[i].propertyFlags & directFlags) == directFlags &&
+            properties.memoryTypes[i].heapIndex == largestHeap) {
+            return true;
+        }
+    }
+    return false;
+}
+// ================================================================================
+// ================================================================================
+
+AllocatorManager::AllocatorManager(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance,
+                                   bool memoryBudget) :
+    device(device),
+    memoryBudgetEnabled(memoryBudget) {
     VmaAllocatorCreateInfo allocatorInfo = {};
     allocatorInfo.physicalDevice = physicalDevice;
     allocatorInfo.device = device;
     allocatorInfo.instance = instance;
+    // Devices are required to support Vulkan 1.2, so VMA can query the budget through core entry points
+    allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_2;
+    if (memoryBudget) {
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
 
     if (vmaCreateAllocator(&allocatorInfo, &allocator) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create VMA allocator!");
     }
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+    directWriteEnabled = hasHostVisibleDeviceHeap(*memoryProperties);
+
+    try {
+        createPools();
+    } catch (const std::runtime_error&) {
+        destroyPools();
+        vmaDestroyAllocator(allocator);
+        throw;
+    }
 }
 // --------------------------------------------------------------------------------
 
 AllocatorManager::~AllocatorManager() {
+    if (!exitStatsFile.empty()) {
+        try {
+            writeStatsJson(exitStatsFile);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    if (defragmentationContext != VK_NULL_HANDLE) {
+        endDefragmentation();
+    }
+    destroyPools();
     vmaDestroyAllocator(allocator);
 }
 // --------------------------------------------------------------------------------
 
-void AllocatorManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage, 
+void AllocatorManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, MemoryClass memoryClass, 
                                     VkBuffer& buffer, VmaAllocation& allocation) {
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -44,12 +216,23 @@ void AllocatorManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    VmaAllocationCreateInfo allocInfo = {};
-    allocInfo.usage = memoryUsage;
+    VmaAllocationCreateInfo allocInfo = describeMemoryClass(memoryClass, directWriteEnabled);
+    if (memoryClass == MemoryClass::Upload) {
+        allocInfo.pool = uploadPool;
+    } else if (memoryClass == MemoryClass::Uniform) {
+        allocInfo.pool = uniformPool;
+    }
 
-    if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr) != VK_SUCCESS) {
+    VkResult result = vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr);
+    // A full ring, an oversized upload or an unusual memory type falls back to the default pools
+    if (result != VK_SUCCESS && allocInfo.pool != VK_NULL_HANDLE) {
+        allocInfo.pool = VK_NULL_HANDLE;
+        result = vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr);
+    }
+    if (result != VK_SUCCESS) {
         throw std::runtime_error("Failed to create buffer!");
     }
+    track(allocation, categorizeBuffer(usage, memoryClass), allocInfo.pool == VK_NULL_HANDLE);
 }
 // --------------------------------------------------------------------------------
 
@@ -65,12 +248,96 @@ void AllocatorManager::unmapMemory(VmaAllocation allocation) {
 }
 // --------------------------------------------------------------------------------
 
+void AllocatorManager::flushAllocation(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size) {
+    if (vmaFlushAllocation(allocator, allocation, offset, size) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to flush allocation!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool AllocatorManager::isHostVisible(VmaAllocation allocation) const {
+    VkMemoryPropertyFlags properties;
+    vmaGetAllocationMemoryProperties(allocator, allocation, &properties);
+    return (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::writeBuffer(VmaAllocation allocation, VkDeviceSize offset, const void* data,
+                                   VkDeviceSize size) {
+    // Maps, copies, flushes and unmaps, and holds off defragmentation so a movable buffer is never moved while mapped
+    std::lock_guard<std::mutex> lock(defragmentationMutex);
+    if (vmaCopyMemoryToAllocation(allocator, data, allocation, offset, size) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to write buffer!");
+    }
+}
+// --------------------------------------------------------------------------------
+
 void AllocatorManager::destroyBuffer(VkBuffer buffer, VmaAllocation allocation) {
+    // Waits for a running defragmentation pass, which may be moving this allocation
+    std::lock_guard<std::mutex> lock(defragmentationMutex);
+    untrack(allocation);
     vmaDestroyBuffer(allocator, buffer, allocation);
 }
 // --------------------------------------------------------------------------------
 
+void AllocatorManager::createImage(const VkImageCreateInfo& imageInfo, VmaMemoryUsage memoryUsage,
+                                   VkImage& image, VmaAllocation& allocation) {
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = memoryUsage;
+
+    if (vmaCreateImage(allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create image!");
+    }
+    track(allocation, AllocationCategory::Image, true);
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::destroyImage(VkImage image, VmaAllocation allocation) {
+    std::lock_guard<std::mutex> lock(defragmentationMutex);
+    untrack(allocation);
+    vmaDestroyImage(allocator, image, allocation);
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::allocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags requiredFlags,
+                                      VmaAllocation& allocation) {
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.requiredFlags = requiredFlags;
+
+    if (vmaAllocateMemory(allocator, &requirements, &allocInfo, &allocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate memory!");
+    }
+    // Only transient images are bound to unbound allocations
+    track(allocation, AllocationCategory::Image, true);
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::bindImageMemory(VmaAllocation allocation, VkImage image) {
+    if (vmaBindImageMemory(allocator, allocation, image) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to bind image memory!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::freeMemory(VmaAllocation allocation) {
+    std::lock_guard<std::mutex> lock(defragmentationMutex);
+    untrack(allocation);
+    vmaFreeMemory(allocator, allocation);
+}
+// --------------------------------------------------------------------------------
+
 void AllocatorManager::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkQueue graphicsQueue, VkCommandPool commandPool) {
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands(commandPool);
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+
+    endSingleTimeCommands(commandBuffer, graphicsQueue, commandPool);
+}
+// --------------------------------------------------------------------------------
+
+VkCommandBuffer AllocatorManager::beginSingleTimeCommands(VkCommandPool commandPool) {
     VkCommandBufferAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -78,18 +345,24 @@ void AllocatorManager::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDevi
     allocInfo.commandBufferCount = 1;
 
     VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate single time command buffer!");
+    }
 
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-    VkBufferCopy copyRegion = {};
-    copyRegion.size = size;
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+        throw std::runtime_error("Failed to begin single time command buffer!");
+    }
+    return commandBuffer;
+}
+// --------------------------------------------------------------------------------
 
+void AllocatorManager::endSingleTimeCommands(VkCommandBuffer commandBuffer, VkQueue graphicsQueue, 
+                                             VkCommandPool commandPool) {
     vkEndCommandBuffer(commandBuffer);
 
     VkSubmitInfo submitInfo = {};
@@ -97,16 +370,391 @@ void AllocatorManager::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDevi
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
+    VkResult result = vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    if (result == VK_SUCCESS) {
+        vkQueueWaitIdle(graphicsQueue);
+    }
 
     vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit single time command buffer!");
+    }
 }
 // --------------------------------------------------------------------------------
 
 VmaAllocator AllocatorManager::getAllocator() const { 
     return allocator; 
 }
+// --------------------------------------------------------------------------------
+
+bool AllocatorManager::isMemoryBudgetEnabled() const {
+    return memoryBudgetEnabled;
+}
+// --------------------------------------------------------------------------------
+
+bool AllocatorManager::isDirectWriteEnabled() const {
+    return directWriteEnabled;
+}
+// --------------------------------------------------------------------------------
+
+std::vector<HeapBudget> AllocatorManager::getHeapBudgets() const {
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+
+    std::vector<VmaBudget> vmaBudgets(memoryProperties->memoryHeapCount);
+    vmaGetHeapBudgets(allocator, vmaBudgets.data());
+
+    std::vector<HeapBudget> budgets(vmaBudgets.size());
+    for (size_t i = 0; i < budgets.size(); i++) {
+        budgets[i].usage = vmaBudgets[i].usage;
+        budgets[i].budget = vmaBudgets[i].budget;
+        budgets[i].blockBytes = vmaBudgets[i].statistics.blockBytes;
+        budgets[i].allocationBytes = vmaBudgets[i].statistics.allocationBytes;
+        budgets[i].flags = memoryProperties->memoryHeaps[i].flags;
+    }
+    return budgets;
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::setBudgetThresholds(std::vector<float> thresholds, BudgetCallback callback) {
+    for (float threshold : thresholds) {
+        if (!(threshold > 0.0f)) {
+            throw std::invalid_argument("Memory budget thresholds must be positive!");
+        }
+    }
+    std::sort(thresholds.begin(), thresholds.end());
+    budgetThresholds = std::move(thresholds);
+    budgetCallback = std::move(callback);
+    budgetLevels.clear();
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::updateBudgets() {
+    // VMA fetches the driver's budget whenever the frame index changes
+    vmaSetCurrentFrameIndex(allocator, ++frameNumber);
+    if (budgetThresholds.empty() || !budgetCallback) {
+        return;
+    }
+
+    std::vector<HeapBudget> budgets = getHeapBudgets();
+    budgetLevels.resize(budgets.size(), 0);
+    for (size_t i = 0; i < budgets.size(); i++) {
+        const HeapBudget& heap = budgets[i];
+        size_t level = 0;
+        while (level < budgetThresholds.size() &&
+               static_cast<double>(heap.usage) >= budgetThresholds[level] * static_cast<double>(heap.budget)) {
+            level++;
+        }
+
+        // Only a rise is reported, falling back below a threshold arms it again
+        if (level > budgetLevels[i] && heap.budget > 0) {
+            budgetCallback(static_cast<uint32_t>(i), heap, budgetThresholds[level - 1]);
+        }
+        budgetLevels[i] = level;
+    }
+}
+// --------------------------------------------------------------------------------
+
+MemoryStats AllocatorManager::getMemoryStats() const {
+    MemoryStats stats;
+    {
+        std::lock_guard<std::mutex> lock(trackingMutex);
+        for (const auto& [allocation, tracked] : trackedAllocations) {
+            VmaAllocationInfo info;
+            vmaGetAllocationInfo(allocator, allocation, &info);
+            CategoryStats& categoryStats = stats.categories[static_cast<size_t>(tracked.category)];
+            categoryStats.allocationCount++;
+            categoryStats.bytes += info.size;
+        }
+    }
+
+    VmaTotalStatistics totals;
+    vmaCalculateStatistics(allocator, &totals);
+    const VmaDetailedStatistics& total = totals.total;
+    stats.allocationCount = total.statistics.allocationCount;
+    stats.blockCount = total.statistics.blockCount;
+    stats.allocationBytes = total.statistics.allocationBytes;
+    stats.blockBytes = total.statistics.blockBytes;
+    stats.largestFreeRange = total.unusedRangeCount > 0 ? total.unusedRangeSizeMax : 0;
+
+    // Free memory split across many small ranges cannot hold a large allocation
+    VkDeviceSize freeBytes = stats.blockBytes - stats.allocationBytes;
+    if (freeBytes > 0) {
+        stats.fragmentation = 1.0f - static_cast<float>(static_cast<double>(stats.largestFreeRange) /
+                                                        static_cast<double>(freeBytes));
+    }
+    return stats;
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::writeStatsJson(const std::string& filename) const {
+    char* statsString = nullptr;
+    vmaBuildStatsString(allocator, &statsString, VK_TRUE);
+
+    std::ofstream file(filename);
+    if (file) {
+        file << statsString;
+    }
+    vmaFreeStatsString(allocator, statsString);
+    if (!file) {
+        throw std::runtime_error("Failed to write memory stats to " + filename + "!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::setExitStatsFile(const std::string& filename) {
+    exitStatsFile = filename;
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::registerMovableBuffer(VkBuffer buffer, VmaAllocation allocation, VkDeviceSize size,
+                                             VkBufferUsageFlags usage, RelocationCallback onMoved) {
+    const VkBufferUsageFlags copyUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if ((usage & copyUsage) != copyUsage) {
+        throw std::invalid_argument("Movable buffers must be usable as copy source and destination!");
+    }
+    {
+        std::lock_guard<std::mutex> lock(trackingMutex);
+        auto it = trackedAllocations.find(allocation);
+        if (it == trackedAllocations.end() || !it->second.defaultPool) {
+            throw std::invalid_argument("Movable buffers must be created by createBuffer in a default pool!");
+        }
+    }
+    std::lock_guard<std::mutex> lock(defragmentationMutex);
+    movableBuffers[allocation] = {buffer, size, usage, std::move(onMoved)};
+}
+// --------------------------------------------------------------------------------
+
+float AllocatorManager::getMovableFragmentation() const {
+    // Step 1: Find the memory types that hold a registered buffer
+    std::array<bool, VK_MAX_MEMORY_TYPES> movableTypes{};
+    {
+        std::lock_guard<std::mutex> lock(defragmentationMutex);
+        for (const auto& [allocation, movable] : movableBuffers) {
+            VmaAllocationInfo info;
+            vmaGetAllocationInfo(allocator, allocation, &info);
+            movableTypes[info.memoryType] = true;
+        }
+    }
+
+    // Step 2: VMA totals each memory type with its custom pools, so take theirs out
+    VmaTotalStatistics totals;
+    vmaCalculateStatistics(allocator, &totals);
+    const std::pair<VmaPool, uint32_t> pools[] = {{uploadPool, uploadPoolMemoryType},
+                                                  {uniformPool, uniformPoolMemoryType}};
+    float worst = 0.0f;
+    for (uint32_t type = 0; type < VK_MAX_MEMORY_TYPES; type++) {
+        if (!movableTypes[type]) {
+            continue;
+        }
+        const VmaDetailedStatistics& typeStats = totals.memoryType[type];
+        VkDeviceSize blockBytes = typeStats.statistics.blockBytes;
+        VkDeviceSize allocationBytes = typeStats.statistics.allocationBytes;
+        for (const auto& [pool, poolType] : pools) {
+            if (pool != VK_NULL_HANDLE && poolType == type) {
+                VmaDetailedStatistics poolStats;
+                vmaCalculatePoolStatistics(allocator, pool, &poolStats);
+                blockBytes -= poolStats.statistics.blockBytes;
+                allocationBytes -= poolStats.statistics.allocationBytes;
+            }
+        }
+
+        // A pool sharing the type may own the largest free range, which only errs towards leaving the type alone
+        VkDeviceSize freeBytes = blockBytes - allocationBytes;
+        VkDeviceSize largestFreeRange = typeStats.unusedRangeCount > 0 ? typeStats.unusedRangeSizeMax : 0;
+        largestFreeRange = std::min(largestFreeRange, freeBytes);
+        if (freeBytes > 0) {
+            worst = std::max(worst, 1.0f - static_cast<float>(static_cast<double>(largestFreeRange) /
+                                                              static_cast<double>(freeBytes)));
+        }
+    }
+    return worst;
+}
+// --------------------------------------------------------------------------------
+
+bool AllocatorManager::beginDefragmentation() {
+    std::lock_guard<std::mutex> lock(defragmentationMutex);
+    if (defragmentationContext != VK_NULL_HANDLE) {
+        return false;
+    }
+
+    VmaDefragmentationInfo defragmentationInfo = {};
+    defragmentationInfo.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+    defragmentationInfo.maxBytesPerPass = DEFRAG_MAX_BYTES_PER_PASS;
+    defragmentationInfo.maxAllocationsPerPass = DEFRAG_MAX_ALLOCATIONS_PER_PASS;
+    if (vmaBeginDefragmentation(allocator, &defragmentationInfo, &defragmentationContext) != VK_SUCCESS) {
+        defragmentationContext = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to begin defragmentation!");
+    }
+    return true;
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::defragment(VkCommandPool commandPool, VkQueue queue, std::chrono::microseconds timeBudget) {
+    std::lock_guard<std::mutex> lock(defragmentationMutex);
+    const auto start = std::chrono::steady_clock::now();
+    while (defragmentationContext != VK_NULL_HANDLE) {
+        VmaDefragmentationPassMoveInfo pass = {};
+        VkResult result = vmaBeginDefragmentationPass(allocator, defragmentationContext, &pass);
+        if (result == VK_SUCCESS) {
+            endDefragmentation();
+            return;
+        }
+        if (result != VK_INCOMPLETE) {
+            endDefragmentation();
+            throw std::runtime_error("Failed to begin a defragmentation pass!");
+        }
+
+        // Step 1: Bind a new buffer to the destination of every registered buffer, VMA keeps the rest in place
+        std::vector<std::pair<VmaAllocation, VkBuffer>> moved;
+        for (uint32_t i = 0; i < pass.moveCount; i++) {
+            VmaDefragmentationMove& move = pass.pMoves[i];
+            auto it = movableBuffers.find(move.srcAllocation);
+            VkBuffer newBuffer = VK_NULL_HANDLE;
+            if (it != movableBuffers.end()) {
+                VkBufferCreateInfo bufferInfo = {};
+                bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+                bufferInfo.size = it->second.size;
+                bufferInfo.usage = it->second.usage;
+                bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                if (vkCreateBuffer(device, &bufferInfo, nullptr, &newBuffer) != VK_SUCCESS) {
+                    newBuffer = VK_NULL_HANDLE;
+                } else if (vmaBindBufferMemory(allocator, move.dstTmpAllocation, newBuffer) != VK_SUCCESS) {
+                    vkDestroyBuffer(device, newBuffer, nullptr);
+                    newBuffer = VK_NULL_HANDLE;
+                }
+            }
+            if (newBuffer == VK_NULL_HANDLE) {
+                move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+            moved.emplace_back(move.srcAllocation, newBuffer);
+        }
+
+        // Step 2: Copy the contents with one submission, which waits for every frame in flight
+        if (!moved.empty()) {
+            try {
+                VkCommandBuffer commandBuffer = beginSingleTimeCommands(commandPool);
+
+                VkMemoryBarrier barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+                for (const auto& [allocation, newBuffer] : moved) {
+                    const MovableBuffer& movable = movableBuffers.at(allocation);
+                    VkBufferCopy copyRegion = {};
+                    copyRegion.size = movable.size;
+                    vkCmdCopyBuffer(commandBuffer, movable.buffer, newBuffer, 1, &copyRegion);
+                }
+
+                // Later frames reach the copies through submission order
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+                endSingleTimeCommands(commandBuffer, queue, commandPool);
+            } catch (const std::runtime_error&) {
+                for (const auto& [allocation, newBuffer] : moved) {
+                    vkDestroyBuffer(device, newBuffer, nullptr);
+                }
+                for (uint32_t i = 0; i < pass.moveCount; i++) {
+                    pass.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                }
+                vmaEndDefragmentationPass(allocator, defragmentationContext, &pass);
+                endDefragmentation();
+                throw;
+            }
+        }
+
+        // Step 3: The queue is idle, so the old buffers can go before VMA frees their memory
+        for (const auto& [allocation, newBuffer] : moved) {
+            MovableBuffer& movable = movableBuffers.at(allocation);
+            vkDestroyBuffer(device, movable.buffer, nullptr);
+            movable.buffer = newBuffer;
+            movable.onMoved(newBuffer);
+        }
+        result = vmaEndDefragmentationPass(allocator, defragmentationContext, &pass);
+
+        // A pass of unmovable allocations only would be offered again, so it ends the defragmentation too
+        if (result == VK_SUCCESS || moved.empty()) {
+            endDefragmentation();
+            return;
+        }
+        if (std::chrono::steady_clock::now() - start >= timeBudget) {
+            return;
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool AllocatorManager::isDefragmenting() const {
+    std::lock_guard<std::mutex> lock(defragmentationMutex);
+    return defragmentationContext != VK_NULL_HANDLE;
+}
+// --------------------------------------------------------------------------------
+
+const VmaDefragmentationStats& AllocatorManager::getLastDefragmentationStats() const {
+    return lastDefragmentationStats;
+}
+// ================================================================================
+
+void AllocatorManager::createPools() {
+    // One block that is never outgrown lets the linear algorithm wrap around like a ring buffer
+    VmaPoolCreateInfo uploadInfo = {};
+    uploadInfo.flags = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT;
+    uploadInfo.blockSize = UPLOAD_POOL_SIZE;
+    uploadInfo.minBlockCount = 1;
+    uploadInfo.maxBlockCount = 1;
+    uploadPool = createClassPool(allocator, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryClass::Upload,
+                                 uploadInfo, "upload ring", uploadPoolMemoryType);
+
+    VmaPoolCreateInfo uniformInfo = {};
+    uniformInfo.blockSize = UNIFORM_POOL_BLOCK_SIZE;
+    uniformPool = createClassPool(allocator, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                  MemoryClass::Uniform, uniformInfo, "uniform", uniformPoolMemoryType);
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::destroyPools() {
+    if (uniformPool != VK_NULL_HANDLE) {
+        vmaDestroyPool(allocator, uniformPool);
+        uniformPool = VK_NULL_HANDLE;
+    }
+    if (uploadPool != VK_NULL_HANDLE) {
+        vmaDestroyPool(allocator, uploadPool);
+        uploadPool = VK_NULL_HANDLE;
+    }
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::track(VmaAllocation allocation, AllocationCategory category, bool defaultPool) {
+    vmaSetAllocationName(allocator, allocation, ALLOCATION_CATEGORY_NAMES[static_cast<size_t>(category)]);
+    std::lock_guard<std::mutex> lock(trackingMutex);
+    trackedAllocations[allocation] = {category, defaultPool};
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::untrack(VmaAllocation allocation) {
+    if (allocation == VK_NULL_HANDLE) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(trackingMutex);
+        trackedAllocations.erase(allocation);
+    }
+    // The caller holds defragmentationMutex, so no pass is moving the allocation and later
+    // passes simply no longer see it
+    movableBuffers.erase(allocation);
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::endDefragmentation() {
+    vmaEndDefragmentation(allocator, defragmentationContext, &lastDefragmentationStats);
+    defragmentationContext = VK_NULL_HANDLE;
+}
 // ================================================================================
 // ================================================================================
 // eof
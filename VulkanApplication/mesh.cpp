@@ -0,0 +1,484 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh.cpp
+// - Purpose: This file contains the implementation of the MeshRegistry class.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/mesh.hpp"
+#include "include/vertex_formats.hpp"
+
+#include <algorithm>
+#include <cstring>  // memcpy
+#include <stdexcept>
+#include <string>
+// ================================================================================
+// ================================================================================
+
+
+MeshHandle getLodHandle(const MeshHandle& mesh, uint32_t lod) {
+    if (lod >= mesh.lodCount) {
+        throw std::out_of_range("Mesh " + std::to_string(mesh.id) + " has no level of detail " +
+                                std::to_string(lod) + "!");
+    }
+    if (lod == 0) {
+        return mesh;
+    }
+
+    MeshHandle handle = mesh;
+    handle.firstIndex = mesh.firstIndex + mesh.lods[lod].firstIndex;
+    handle.indexCount = mesh.lods[lod].indexCount;
+    handle.meshletCount = 0;
+    return handle;
+}
+// ================================================================================
+// ================================================================================
+
+
+MeshRegistry::MeshRegistry(AllocatorManager& allocatorManager,
+                           VkCommandPool commandPool,
+                           VkQueue graphicsQueue,
+                           VkDeviceSize maxVertices,
+                           VkDeviceSize maxIndices,
+                           VkDeviceSize maxMeshlets)
+    : allocatorManager(allocatorManager),
+      commandPool(commandPool),
+      graphicsQueue(graphicsQueue),
+      maxVertices(maxVertices),
+      maxIndices(maxIndices),
+      maxMeshlets(maxMeshlets) {
+    // Virtual block sizes are expressed in vertices, indices and meshlets, not bytes
+    VmaVirtualBlockCreateInfo blockInfo = {};
+    blockInfo.size = maxVertices;
+    if (vmaCreateVirtualBlock(&blockInfo, &vertexBlock) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create vertex virtual block!");
+    }
+
+    blockInfo.size = maxIndices;
+    if (vmaCreateVirtualBlock(&blockInfo, &indexBlock) != VK_SUCCESS) {
+        vmaDestroyVirtualBlock(vertexBlock);
+        throw std::runtime_error("Failed to create index virtual block!");
+    }
+
+    blockInfo.size = maxMeshlets;
+    if (vmaCreateVirtualBlock(&blockInfo, &meshletBlock) != VK_SUCCESS) {
+        vmaDestroyVirtualBlock(indexBlock);
+        vmaDestroyVirtualBlock(vertexBlock);
+        throw std::runtime_error("Failed to create meshlet virtual block!");
+    }
+
+    // The shared buffers are copy sources so defragmentation can move them, and host visible
+    // where the device allows it so uploads skip the staging copy
+    const VkBufferUsageFlags copyUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    const VkBufferUsageFlags vertexUsage = copyUsage | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    const VkBufferUsageFlags indexUsage = copyUsage | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    const VkBufferUsageFlags meshletUsage = copyUsage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    try {
+        allocatorManager.createBuffer(maxVertices * sizeof(RenderVertex), vertexUsage,
+                                      MemoryClass::DirectWrite, vertexBuffer, vertexBufferAllocation);
+        allocatorManager.createBuffer(maxIndices * sizeof(uint16_t), indexUsage,
+                                      MemoryClass::DirectWrite, indexBuffer, indexBufferAllocation);
+        allocatorManager.createBuffer(maxMeshlets * sizeof(Meshlet), meshletUsage,
+                                      MemoryClass::DirectWrite, meshletBuffer, meshletBufferAllocation);
+    } catch (const std::runtime_error&) {
+        if (vertexBuffer != VK_NULL_HANDLE) {
+            allocatorManager.destroyBuffer(vertexBuffer, vertexBufferAllocation);
+        }
+        if (indexBuffer != VK_NULL_HANDLE) {
+            allocatorManager.destroyBuffer(indexBuffer, indexBufferAllocation);
+        }
+        vmaDestroyVirtualBlock(meshletBlock);
+        vmaDestroyVirtualBlock(indexBlock);
+        vmaDestroyVirtualBlock(vertexBlock);
+        throw;
+    }
+
+    // VMA may place the buffers out of the host's reach even where the device offers it
+    directWrite = allocatorManager.isHostVisible(vertexBufferAllocation) &&
+                  allocatorManager.isHostVisible(indexBufferAllocation) &&
+                  allocatorManager.isHostVisible(meshletBufferAllocation);
+
+    allocatorManager.registerMovableBuffer(vertexBuffer, vertexBufferAllocation, maxVertices * sizeof(RenderVertex),
+                                           vertexUsage, [this](VkBuffer buffer) { vertexBuffer = buffer; });
+    allocatorManager.registerMovableBuffer(indexBuffer, indexBufferAllocation, maxIndices * sizeof(uint16_t),
+                                           indexUsage, [this](VkBuffer buffer) { indexBuffer = buffer; });
+    allocatorManager.registerMovableBuffer(meshletBuffer, meshletBufferAllocation, maxMeshlets * sizeof(Meshlet),
+                                           meshletUsage, [this](VkBuffer buffer) { meshletBuffer = buffer; });
+}
+// --------------------------------------------------------------------------------
+
+MeshRegistry::~MeshRegistry() {
+    for (const auto& [id, record] : meshes) {
+        releaseRecord(record);
+    }
+    for (const auto& record : retiredMeshes) {
+        releaseRecord(record);
+    }
+    meshes.clear();
+    retiredMeshes.clear();
+
+    if (vertexBlock != VK_NULL_HANDLE) {
+        vmaDestroyVirtualBlock(vertexBlock);
+    }
+    if (indexBlock != VK_NULL_HANDLE) {
+        vmaDestroyVirtualBlock(indexBlock);
+    }
+    if (meshletBlock != VK_NULL_HANDLE) {
+        vmaDestroyVirtualBlock(meshletBlock);
+    }
+    if (vertexBuffer != VK_NULL_HANDLE) {
+        allocatorManager.destroyBuffer(vertexBuffer, vertexBufferAllocation);
+    }
+    if (indexBuffer != VK_NULL_HANDLE) {
+        allocatorManager.destroyBuffer(indexBuffer, indexBufferAllocation);
+    }
+    if (meshletBuffer != VK_NULL_HANDLE) {
+        allocatorManager.destroyBuffer(meshletBuffer, meshletBufferAllocation);
+    }
+}
+// --------------------------------------------------------------------------------
+
+MeshHandle MeshRegistry::addMesh(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices) {
+    if (vertices.empty() || indices.empty()) {
+        throw std::invalid_argument("A mesh requires at least one vertex and one index!");
+    }
+
+    // Reorder triangles and vertices for the post-transform cache and vertex fetch
+    std::vector<Vertex> optimizedVertices = vertices;
+    std::vector<uint16_t> optimizedIndices = indices;
+    lastOptimizationReport = optimizeMesh(optimizedVertices, optimizedIndices);
+    std::vector<glm::vec3> positions = positionsOf(optimizedVertices);
+    std::vector<Meshlet> meshlets = buildMeshlets(optimizedIndices, positions);
+
+    // Coarser levels index the same vertices and are stored after the full triangle list
+    LodChain lodChain = buildLodChain(optimizedIndices, positions);
+
+    // Encode the vertices into the layout selected at compile time before any range is reserved
+    std::vector<RenderVertex> encodedVertices = convertVertices<RenderVertex>(optimizedVertices);
+
+    // Bound the mesh by a sphere centered on its axis aligned box, which is tight enough for culling
+    glm::vec2 minPos = optimizedVertices[0].pos;
+    glm::vec2 maxPos = optimizedVertices[0].pos;
+    for (const Vertex& vertex : optimizedVertices) {
+        minPos = glm::min(minPos, vertex.pos);
+        maxPos = glm::max(maxPos, vertex.pos);
+    }
+    glm::vec2 center = 0.5f * (minPos + maxPos);
+    float radius = 0.0f;
+    for (const Vertex& vertex : optimizedVertices) {
+        radius = glm::max(radius, glm::length(vertex.pos - center));
+    }
+
+    return registerMesh(encodedVertices.data(), static_cast<uint32_t>(encodedVertices.size()),
+                        lodChain.indices.data(), static_cast<uint32_t>(lodChain.indices.size()),
+                        meshlets.data(), static_cast<uint32_t>(meshlets.size()), glm::vec4(center, 0.0f, radius),
+                        lodChain.lods);
+}
+// --------------------------------------------------------------------------------
+
+MeshHandle MeshRegistry::addMesh(const MappedMeshFile& file) {
+    if (!isCompatible(file)) {
+        throw std::runtime_error("Mesh file vertex layout does not match the VERTEX_FORMAT of this build "
+                                 "or its meshlets are invalid, convert the asset again with the matching --format!");
+    }
+
+    const MeshFileHeader& header = file.getHeader();
+    glm::vec4 bounds = file.hasBounds()
+        ? file.getBounds()
+        : glm::vec4(0.0f, 0.0f, 0.0f, std::numeric_limits<float>::infinity());
+    return registerMesh(file.getVertexData(), header.vertexCount,
+                        static_cast<const uint16_t*>(file.getIndexData()), header.indexCount,
+                        static_cast<const Meshlet*>(file.getMeshletData()), header.meshletCount, bounds);
+}
+// --------------------------------------------------------------------------------
+
+bool MeshRegistry::isCompatible(const MappedMeshFile& file) {
+    constexpr VkVertexInputBindingDescription binding = RenderVertex::getBindingDescription();
+    constexpr auto attributes = RenderVertex::getAttributeDescriptions();
+    if (!file.matchesLayout(binding, attributes.data(), attributes.size())) {
+        return false;
+    }
+    if (!file.hasMeshlets()) {
+        return true;
+    }
+
+    const MeshFileHeader& header = file.getHeader();
+    return header.meshletSize == static_cast<uint64_t>(header.meshletCount) * sizeof(Meshlet) &&
+           validateMeshlets(static_cast<const Meshlet*>(file.getMeshletData()), header.meshletCount,
+                            header.indexCount);
+}
+// --------------------------------------------------------------------------------
+
+MeshHandle MeshRegistry::reserveMesh(uint32_t vertexCount, uint32_t indexCount, const glm::vec4& bounds,
+                                     uint32_t meshletCount, const std::vector<MeshLod>& lods) {
+    if (vertexCount == 0 || indexCount == 0) {
+        throw std::invalid_argument("A mesh requires at least one vertex and one index!");
+    }
+    if (lods.size() > MAX_MESH_LODS) {
+        throw std::invalid_argument("A mesh can have at most " + std::to_string(MAX_MESH_LODS) +
+                                    " levels of detail!");
+    }
+    for (const MeshLod& lod : lods) {
+        if (lod.indexCount == 0 || lod.firstIndex > indexCount || lod.indexCount > indexCount - lod.firstIndex) {
+            throw std::invalid_argument("Level of detail leaves the index range of the mesh!");
+        }
+    }
+    if (!lods.empty() && lods[0].firstIndex != 0) {
+        throw std::invalid_argument("The full detail level must start the index range of the mesh!");
+    }
+
+    MeshRecord record;
+
+    VmaVirtualAllocationCreateInfo allocInfo = {};
+    allocInfo.size = vertexCount;
+    VkDeviceSize vertexOffset = 0;
+    if (vmaVirtualAllocate(vertexBlock, &allocInfo, &record.vertexRange, &vertexOffset) != VK_SUCCESS) {
+        throw std::runtime_error(std::string("Shared vertex buffer cannot hold ") +
+                                 std::to_string(vertexCount) + " more vertices!");
+    }
+
+    allocInfo.size = indexCount;
+    VkDeviceSize firstIndex = 0;
+    if (vmaVirtualAllocate(indexBlock, &allocInfo, &record.indexRange, &firstIndex) != VK_SUCCESS) {
+        vmaVirtualFree(vertexBlock, record.vertexRange);
+        throw std::runtime_error(std::string("Shared index buffer cannot hold ") +
+                                 std::to_string(indexCount) + " more indices!");
+    }
+
+    VkDeviceSize firstMeshlet = 0;
+    if (meshletCount != 0) {
+        allocInfo.size = meshletCount;
+        if (vmaVirtualAllocate(meshletBlock, &allocInfo, &record.meshletRange, &firstMeshlet) != VK_SUCCESS) {
+            vmaVirtualFree(indexBlock, record.indexRange);
+            vmaVirtualFree(vertexBlock, record.vertexRange);
+            throw std::runtime_error(std::string("Shared meshlet buffer cannot hold ") +
+                                     std::to_string(meshletCount) + " more meshlets!");
+        }
+    }
+
+    record.handle.id = nextMeshId++;
+    record.handle.firstIndex = static_cast<uint32_t>(firstIndex);
+    record.handle.vertexOffset = static_cast<int32_t>(vertexOffset);
+    record.handle.indexCount = lods.empty() ? indexCount : lods[0].indexCount;
+    record.handle.vertexCount = vertexCount;
+    record.handle.firstMeshlet = static_cast<uint32_t>(firstMeshlet);
+    record.handle.meshletCount = meshletCount;
+    record.handle.bounds = bounds;
+    if (lods.empty()) {
+        record.handle.lods[0] = MeshLod{0, indexCount, 0.0f};
+    } else {
+        record.handle.lodCount = static_cast<uint32_t>(lods.size());
+        std::copy(lods.begin(), lods.end(), record.handle.lods.begin());
+    }
+
+    meshes.emplace(record.handle.id, record);
+    return record.handle;
+}
+// --------------------------------------------------------------------------------
+
+void MeshRegistry::removeMesh(uint32_t meshId) {
+    auto it = meshes.find(meshId);
+    if (it == meshes.end()) {
+        throw std::out_of_range("Mesh " + std::to_string(meshId) + " does not exist!");
+    }
+
+    MeshRecord record = it->second;
+    record.retireFrame = frameNumber + MAX_FRAMES_IN_FLIGHT;
+    retiredMeshes.push_back(record);
+    meshes.erase(it);
+}
+// --------------------------------------------------------------------------------
+
+void MeshRegistry::processRetiredMeshes() {
+    frameNumber++;
+
+    auto it = retiredMeshes.begin();
+    while (it != retiredMeshes.end()) {
+        if (it->retireFrame <= frameNumber) {
+            releaseRecord(*it);
+            it = retiredMeshes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+const MeshHandle& MeshRegistry::getMesh(uint32_t meshId) const {
+    auto it = meshes.find(meshId);
+    if (it == meshes.end()) {
+        throw std::out_of_range("Mesh " + std::to_string(meshId) + " does not exist!");
+    }
+    return it->second.handle;
+}
+// --------------------------------------------------------------------------------
+
+bool MeshRegistry::containsMesh(uint32_t meshId) const {
+    return meshes.find(meshId) != meshes.end();
+}
+// --------------------------------------------------------------------------------
+
+size_t MeshRegistry::getMeshCount() const {
+    return meshes.size();
+}
+// --------------------------------------------------------------------------------
+
+void MeshRegistry::bind(VkCommandBuffer commandBuffer) const {
+    VkBuffer vertexBuffers[] = { vertexBuffer };
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, getIndexType());
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer MeshRegistry::getVertexBuffer() const {
+    return vertexBuffer;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer MeshRegistry::getIndexBuffer() const {
+    return indexBuffer;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer MeshRegistry::getMeshletBuffer() const {
+    return meshletBuffer;
+}
+// --------------------------------------------------------------------------------
+
+bool MeshRegistry::isDirectWrite() const {
+    return directWrite;
+}
+// --------------------------------------------------------------------------------
+
+void MeshRegistry::writeShared(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size) {
+    VmaAllocation allocation;
+    if (buffer == vertexBuffer) {
+        allocation = vertexBufferAllocation;
+    } else if (buffer == indexBuffer) {
+        allocation = indexBufferAllocation;
+    } else if (buffer == meshletBuffer) {
+        allocation = meshletBufferAllocation;
+    } else {
+        throw std::invalid_argument("Buffer is not a shared mesh buffer!");
+    }
+    allocatorManager.writeBuffer(allocation, offset, data, size);
+}
+// --------------------------------------------------------------------------------
+
+VkIndexType MeshRegistry::getIndexType() const {
+    return VK_INDEX_TYPE_UINT16;
+}
+// --------------------------------------------------------------------------------
+
+const MeshOptimizationReport& MeshRegistry::getLastOptimizationReport() const {
+    return lastOptimizationReport;
+}
+// ================================================================================
+
+void MeshRegistry::releaseRecord(const MeshRecord& record) {
+    vmaVirtualFree(vertexBlock, record.vertexRange);
+    vmaVirtualFree(indexBlock, record.indexRange);
+    if (record.meshletRange != VK_NULL_HANDLE) {
+        vmaVirtualFree(meshletBlock, record.meshletRange);
+    }
+}
+// --------------------------------------------------------------------------------
+
+MeshHandle MeshRegistry::registerMesh(const void* vertexData, uint32_t vertexCount,
+                                      const uint16_t* indexData, uint32_t indexCount,
+                                      const Meshlet* meshletData, uint32_t meshletCount, const glm::vec4& bounds,
+                                      const std::vector<MeshLod>& lods) {
+    MeshHandle handle = reserveMesh(vertexCount, indexCount, bounds, meshletCount, lods);
+
+    try {
+        upload({
+            {vertexData, vertexCount * sizeof(RenderVertex), vertexBuffer, handle.vertexOffset * sizeof(RenderVertex)},
+            {indexData, indexCount * sizeof(uint16_t), indexBuffer, handle.firstIndex * sizeof(uint16_t)},
+            {meshletData, meshletCount * sizeof(Meshlet), meshletBuffer, handle.firstMeshlet * sizeof(Meshlet)},
+        });
+    } catch (const std::runtime_error&) {
+        // Nothing can reference the mesh yet, so its ranges are freed immediately
+        releaseRecord(meshes.at(handle.id));
+        meshes.erase(handle.id);
+        throw;
+    }
+    return handle;
+}
+// --------------------------------------------------------------------------------
+
+void MeshRegistry::upload(const std::vector<UploadRegion>& regions) {
+    // Host visible shared buffers are written in place, without a staging buffer or a submission
+    if (directWrite) {
+        for (const UploadRegion& region : regions) {
+            if (region.size != 0) {
+                writeShared(region.dstBuffer, region.dstOffset, region.data, region.size);
+            }
+        }
+        return;
+    }
+
+    VkDeviceSize totalBytes = 0;
+    for (const UploadRegion& region : regions) {
+        totalBytes += region.size;
+    }
+
+    // Step 1: Create one staging buffer that holds every region back to back
+    VkBuffer stagingBuffer;
+    VmaAllocation stagingBufferAllocation;
+    allocatorManager.createBuffer(totalBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                  MemoryClass::Upload, stagingBuffer, stagingBufferAllocation);
+
+    // Step 2: Map memory and copy the mesh data to the staging buffer
+    void* data;
+    try {
+        allocatorManager.mapMemory(stagingBufferAllocation, &data);
+    } catch (const std::runtime_error&) {
+        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation);
+        throw;
+    }
+    VkDeviceSize stagingOffset = 0;
+    for (const UploadRegion& region : regions) {
+        if (region.size != 0) {
+            memcpy(static_cast<char*>(data) + stagingOffset, region.data, static_cast<size_t>(region.size));
+            stagingOffset += region.size;
+        }
+    }
+    allocatorManager.unmapMemory(stagingBufferAllocation);
+
+    // Step 3: Copy every region into its shared buffer with a single submission
+    try {
+        VkCommandBuffer commandBuffer = allocatorManager.beginSingleTimeCommands(commandPool);
+
+        stagingOffset = 0;
+        for (const UploadRegion& region : regions) {
+            if (region.size == 0) {
+                continue;
+            }
+            VkBufferCopy copyRegion = {};
+            copyRegion.srcOffset = stagingOffset;
+            copyRegion.dstOffset = region.dstOffset;
+            copyRegion.size = region.size;
+            vkCmdCopyBuffer(commandBuffer, stagingBuffer, region.dstBuffer, 1, &copyRegion);
+            stagingOffset += region.size;
+        }
+
+        allocatorManager.endSingleTimeCommands(commandBuffer, graphicsQueue, commandPool);
+    } catch (const std::runtime_error&) {
+        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation);
+        throw;
+    }
+
+    // Step 4: Clean up the staging buffer
+    allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,323 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh_file.cpp
+// - Purpose: This file contains the implementation of the MappedMeshFile class and
+//            the mesh file writer.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/mesh_file.hpp"
+
+#include <cstring>  // memcmp, memcpy
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Rounds an offset up to MESH_FILE_ALIGNMENT.
+ */
+static uint64_t alignOffset(uint64_t offset) {
+    return (offset + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Checks that a section is aligned and lies entirely inside the file.
+ */
+static bool sectionInFile(uint64_t offset, uint64_t size, uint64_t fileSize) {
+    return offset % MESH_FILE_ALIGNMENT == 0 && offset <= fileSize && size <= fileSize - offset;
+}
+// ================================================================================
+// ================================================================================
+
+
+MappedMeshFile::MappedMeshFile(const std::string& filename)
+    : filename(filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open mesh file " + filename + "!");
+    }
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size < static_cast<off_t>(sizeof(MeshFileHeader))) {
+        close(fd);
+        throw std::runtime_error("Mesh file " + filename + " is too small to hold a header!");
+    }
+    fileSize = static_cast<size_t>(fileInfo.st_size);
+
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map mesh file " + filename + "!");
+    }
+    data = static_cast<const unsigned char*>(mapping);
+
+    // The blobs are read front to back exactly once, so ask for aggressive read ahead
+    madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+    try {
+        validate();
+    } catch (const std::runtime_error&) {
+        unmap();
+        throw;
+    }
+}
+// --------------------------------------------------------------------------------
+
+MappedMeshFile::~MappedMeshFile() {
+    unmap();
+}
+// --------------------------------------------------------------------------------
+
+MappedMeshFile::MappedMeshFile(MappedMeshFile&& other) noexcept
+    : filename(std::move(other.filename)),
+      data(std::exchange(other.data, nullptr)),
+      fileSize(std::exchange(other.fileSize, 0)) {}
+// --------------------------------------------------------------------------------
+
+MappedMeshFile& MappedMeshFile::operator=(MappedMeshFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        filename = std::move(other.filename);
+        data = std::exchange(other.data, nullptr);
+        fileSize = std::exchange(other.fileSize, 0);
+    }
+    return *this;
+}
+// --------------------------------------------------------------------------------
+
+const MeshFileHeader& MappedMeshFile::getHeader() const {
+    return *reinterpret_cast<const MeshFileHeader*>(data);
+}
+// --------------------------------------------------------------------------------
+
+std::vector<MeshFileAttribute> MappedMeshFile::getAttributes() const {
+    const MeshFileHeader& header = getHeader();
+    std::vector<MeshFileAttribute> attributes(header.attributeCount);
+    memcpy(attributes.data(), data + header.attributeOffset, header.attributeCount * sizeof(MeshFileAttribute));
+    return attributes;
+}
+// --------------------------------------------------------------------------------
+
+bool MappedMeshFile::matchesLayout(const VkVertexInputBindingDescription& binding,
+                                   const VkVertexInputAttributeDescription* attributes,
+                                   size_t attributeCount) const {
+    const MeshFileHeader& header = getHeader();
+    if (header.vertexStride != binding.stride || header.attributeCount != attributeCount) {
+        return false;
+    }
+
+    std::vector<MeshFileAttribute> stored = getAttributes();
+    for (size_t i = 0; i < attributeCount; i++) {
+        bool found = false;
+        for (const MeshFileAttribute& attribute : stored) {
+            if (attribute.location == attributes[i].location &&
+                attribute.format == static_cast<uint32_t>(attributes[i].format) &&
+                attribute.offset == attributes[i].offset) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+// --------------------------------------------------------------------------------
+
+const void* MappedMeshFile::getVertexData() const {
+    return data + getHeader().vertexOffset;
+}
+// --------------------------------------------------------------------------------
+
+const void* MappedMeshFile::getIndexData() const {
+    return data + getHeader().indexOffset;
+}
+// --------------------------------------------------------------------------------
+
+bool MappedMeshFile::hasBounds() const {
+    return (getHeader().flags & MESH_FILE_HAS_BOUNDS) != 0;
+}
+// --------------------------------------------------------------------------------
+
+glm::vec4 MappedMeshFile::getBounds() const {
+    const float* bounds = getHeader().bounds;
+    return glm::vec4(bounds[0], bounds[1], bounds[2], bounds[3]);
+}
+// --------------------------------------------------------------------------------
+
+bool MappedMeshFile::hasMeshlets() const {
+    return (getHeader().flags & MESH_FILE_HAS_MESHLETS) != 0;
+}
+// --------------------------------------------------------------------------------
+
+const void* MappedMeshFile::getMeshletData() const {
+    return hasMeshlets() ? data + getHeader().meshletOffset : nullptr;
+}
+// --------------------------------------------------------------------------------
+
+size_t MappedMeshFile::getFileSize() const {
+    return fileSize;
+}
+// ================================================================================
+
+void MappedMeshFile::validate() const {
+    const MeshFileHeader& header = getHeader();
+    if (memcmp(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) != 0) {
+        throw std::runtime_error(filename + " is not a mesh file!");
+    }
+    if (header.version != MESH_FILE_VERSION || header.headerSize != sizeof(MeshFileHeader)) {
+        throw std::runtime_error("Mesh file " + filename + " has unsupported version " +
+                                 std::to_string(header.version) + "!");
+    }
+    if (header.indexType != VK_INDEX_TYPE_UINT16) {
+        throw std::runtime_error("Mesh file " + filename + " must store 16 bit indices!");
+    }
+    if (header.vertexCount == 0 || header.indexCount == 0 || header.vertexStride == 0) {
+        throw std::runtime_error("Mesh file " + filename + " holds no geometry!");
+    }
+    if (header.attributeCount == 0 || header.attributeCount > MAX_MESH_FILE_ATTRIBUTES) {
+        throw std::runtime_error("Mesh file " + filename + " has an invalid attribute count!");
+    }
+
+    // Compare sizes in 64 bits so that the products cannot wrap
+    if (header.vertexSize != static_cast<uint64_t>(header.vertexCount) * header.vertexStride ||
+        header.indexSize != static_cast<uint64_t>(header.indexCount) * sizeof(uint16_t)) {
+        throw std::runtime_error("Mesh file " + filename + " has inconsistent section sizes!");
+    }
+
+    bool inFile = sectionInFile(header.attributeOffset, header.attributeCount * sizeof(MeshFileAttribute), fileSize) &&
+                  sectionInFile(header.vertexOffset, header.vertexSize, fileSize) &&
+                  sectionInFile(header.indexOffset, header.indexSize, fileSize);
+    if (inFile && (header.flags & MESH_FILE_HAS_MESHLETS) != 0) {
+        inFile = header.meshletCount != 0 && sectionInFile(header.meshletOffset, header.meshletSize, fileSize);
+    }
+    if (!inFile) {
+        throw std::runtime_error("Mesh file " + filename + " is truncated or has misaligned sections!");
+    }
+
+    for (const MeshFileAttribute& attribute : getAttributes()) {
+        if (attribute.offset >= header.vertexStride) {
+            throw std::runtime_error("Mesh file " + filename + " has an attribute outside the vertex stride!");
+        }
+    }
+
+    // An out of range index would read past the mesh in the shared vertex buffer
+    const uint16_t* indices = static_cast<const uint16_t*>(getIndexData());
+    uint16_t maxIndex = 0;
+    for (uint32_t i = 0; i < header.indexCount; i++) {
+        maxIndex = indices[i] > maxIndex ? indices[i] : maxIndex;
+    }
+    if (maxIndex >= header.vertexCount) {
+        throw std::runtime_error("Mesh file " + filename + " references vertex " +
+                                 std::to_string(maxIndex) + " of " + std::to_string(header.vertexCount) + "!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+void MappedMeshFile::unmap() {
+    if (data != nullptr) {
+        munmap(const_cast<unsigned char*>(data), fileSize);
+        data = nullptr;
+        fileSize = 0;
+    }
+}
+// ================================================================================
+// ================================================================================
+
+size_t writeMeshFile(const std::string& filename, const MeshFileContents& contents) {
+    if (contents.vertexData == nullptr || contents.vertexCount == 0 ||
+        contents.indexData == nullptr || contents.indexCount == 0 || contents.attributes.empty()) {
+        throw std::runtime_error("Cannot write mesh file " + filename + " without geometry!");
+    }
+
+    MeshFileHeader header = {};
+    memcpy(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC));
+    header.version = MESH_FILE_VERSION;
+    header.headerSize = sizeof(MeshFileHeader);
+    header.vertexCount = contents.vertexCount;
+    header.vertexStride = contents.vertexStride;
+    header.indexCount = contents.indexCount;
+    header.indexType = VK_INDEX_TYPE_UINT16;
+    header.attributeCount = static_cast<uint32_t>(contents.attributes.size());
+
+    // Lay the sections out back to back, each starting on an aligned offset
+    header.attributeOffset = alignOffset(sizeof(MeshFileHeader));
+    header.vertexOffset = alignOffset(header.attributeOffset + contents.attributes.size() * sizeof(MeshFileAttribute));
+    header.vertexSize = static_cast<uint64_t>(contents.vertexCount) * contents.vertexStride;
+    header.indexOffset = alignOffset(header.vertexOffset + header.vertexSize);
+    header.indexSize = static_cast<uint64_t>(contents.indexCount) * sizeof(uint16_t);
+    uint64_t end = header.indexOffset + header.indexSize;
+
+    if (contents.hasBounds) {
+        header.flags |= MESH_FILE_HAS_BOUNDS;
+        header.bounds[0] = contents.bounds.x;
+        header.bounds[1] = contents.bounds.y;
+        header.bounds[2] = contents.bounds.z;
+        header.bounds[3] = contents.bounds.w;
+    }
+    if (contents.meshletData != nullptr && contents.meshletCount != 0) {
+        header.flags |= MESH_FILE_HAS_MESHLETS;
+        header.meshletCount = contents.meshletCount;
+        header.meshletOffset = alignOffset(end);
+        header.meshletSize = contents.meshletSize;
+        end = header.meshletOffset + header.meshletSize;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open " + filename + " for writing!");
+    }
+
+    const char padding[MESH_FILE_ALIGNMENT] = {};
+    auto writeSection = [&](uint64_t offset, const void* bytes, uint64_t size) {
+        file.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(file.tellp())));
+        file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+    };
+    writeSection(0, &header, sizeof(header));
+    writeSection(header.attributeOffset, contents.attributes.data(),
+                 contents.attributes.size() * sizeof(MeshFileAttribute));
+    writeSection(header.vertexOffset, contents.vertexData, header.vertexSize);
+    writeSection(header.indexOffset, contents.indexData, header.indexSize);
+    if (header.flags & MESH_FILE_HAS_MESHLETS) {
+        writeSection(header.meshletOffset, contents.meshletData, header.meshletSize);
+    }
+
+    if (!file) {
+        throw std::runtime_error("Failed to write mesh file " + filename + "!");
+    }
+    return static_cast<size_t>(end);
+}
+// --------------------------------------------------------------------------------
+
+std::vector<MeshFileAttribute> toMeshFileAttributes(const VkVertexInputAttributeDescription* attributes,
+                                                    size_t attributeCount) {
+    std::vector<MeshFileAttribute> records(attributeCount);
+    for (size_t i = 0; i < attributeCount; i++) {
+        records[i].location = attributes[i].location;
+        records[i].format = static_cast<uint32_t>(attributes[i].format);
+        records[i].offset = attributes[i].offset;
+        records[i].reserved = 0;
+    }
+    return records;
+}
+// ================================================================================
+// ================================================================================
+// eof
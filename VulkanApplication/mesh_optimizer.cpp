@@ -0,0 +1,354 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh_optimizer.cpp
+// - Purpose: This file contains the implementation of the vertex cache, overdraw
+//            and vertex fetch optimization passes.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Checks that the list holds whole triangles whose indices address existing vertices.
+ */
+static void validateTriangleList(const std::vector<uint16_t>& indices, size_t vertexCount) {
+    if (indices.size() % 3 != 0) {
+        throw std::invalid_argument("Index count " + std::to_string(indices.size()) +
+                                    " is not a multiple of three!");
+    }
+    for (uint16_t index : indices) {
+        if (index >= vertexCount) {
+            throw std::invalid_argument("Index " + std::to_string(index) + " addresses one of only " +
+                                        std::to_string(vertexCount) + " vertices!");
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Scores a vertex by its position in the modelled LRU cache and its remaining triangles.
+ *
+ * The three most recent vertices get a fixed score so that the triangle just emitted
+ * does not dominate, the rest decay with their age, and a valence boost pulls in
+ * vertices that are close to finished so that they do not leave lonely triangles behind.
+ */
+static float forsythVertexScore(int cachePosition, uint32_t remainingTriangles) {
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            float scaler = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+    return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+}
+// ================================================================================
+// ================================================================================
+
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<uint16_t>& indices, size_t vertexCount,
+                                         uint32_t cacheSize) {
+    if (indices.size() % 3 != 0) {
+        throw std::invalid_argument("Index count " + std::to_string(indices.size()) +
+                                    " is not a multiple of three!");
+    }
+
+    VertexCacheStatistics statistics;
+    if (indices.empty() || vertexCount == 0) {
+        return statistics;
+    }
+
+    // A vertex is in the FIFO if fewer than cacheSize vertices were inserted since it was
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    for (uint16_t index : indices) {
+        if (time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            statistics.transformedVertices++;
+        }
+    }
+
+    statistics.acmr = static_cast<float>(statistics.transformedVertices) / static_cast<float>(indices.size() / 3);
+    statistics.atvr = static_cast<float>(statistics.transformedVertices) / static_cast<float>(vertexCount);
+    return statistics;
+}
+// --------------------------------------------------------------------------------
+
+void optimizeVertexCache(std::vector<uint16_t>& indices, size_t vertexCount) {
+    validateTriangleList(indices, vertexCount);
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Step 1: Build the triangles adjacent to each vertex in compressed row form
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint16_t index : indices) {
+        remaining[index]++;
+    }
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::partial_sum(remaining.begin(), remaining.end(), adjacencyOffsets.begin() + 1);
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    // Step 2: Score every vertex and triangle with an empty cache
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScores[v] = forsythVertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] +
+                            vertexScores[indices[t * 3 + 2]];
+    }
+
+    size_t bestTriangle = static_cast<size_t>(
+        std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+
+    std::vector<uint16_t> output;
+    output.reserve(indices.size());
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+    size_t deadEndCursor = 0;
+
+    // Step 3: Emit the best triangle, update the cache, and rescore only what the cache touched
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        if (bestTriangle == std::numeric_limits<size_t>::max()) {
+            // Nothing in the cache has triangles left, so continue with the next unused triangle
+            while (emitted[deadEndCursor]) {
+                deadEndCursor++;
+            }
+            bestTriangle = deadEndCursor;
+        }
+
+        const uint16_t* triangle = &indices[bestTriangle * 3];
+        output.insert(output.end(), triangle, triangle + 3);
+        emitted[bestTriangle] = true;
+
+        nextCache.clear();
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t vertex = triangle[corner];
+            nextCache.push_back(vertex);
+
+            // Remove the triangle from the vertex's live adjacency range
+            uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+            uint32_t* end = begin + remaining[vertex];
+            uint32_t* found = std::find(begin, end, static_cast<uint32_t>(bestTriangle));
+            if (found != end) {
+                std::swap(*found, *(end - 1));
+                remaining[vertex]--;
+            }
+        }
+        for (uint32_t vertex : cache) {
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        for (size_t i = 0; i < nextCache.size(); i++) {
+            uint32_t vertex = nextCache[i];
+            cachePositions[vertex] = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+            vertexScores[vertex] = forsythVertexScore(cachePositions[vertex], remaining[vertex]);
+        }
+
+        bestTriangle = std::numeric_limits<size_t>::max();
+        float bestScore = -1.0f;
+        for (uint32_t vertex : nextCache) {
+            for (uint32_t a = 0; a < remaining[vertex]; a++) {
+                uint32_t t = adjacency[adjacencyOffsets[vertex] + a];
+                float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] +
+                              vertexScores[indices[t * 3 + 2]];
+                triangleScores[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        if (nextCache.size() > FORSYTH_CACHE_SIZE) {
+            nextCache.resize(FORSYTH_CACHE_SIZE);
+        }
+        cache.swap(nextCache);
+    }
+
+    indices.swap(output);
+}
+// --------------------------------------------------------------------------------
+
+bool optimizeOverdraw(std::vector<uint16_t>& indices, const std::vector<glm::vec3>& positions, float threshold) {
+    validateTriangleList(indices, positions.size());
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return false;
+    }
+    const float acmrBefore = analyzeVertexCache(indices, positions.size()).acmr;
+
+    // Step 1: Hard boundaries lie wherever a triangle misses the cache on all three vertices
+    std::vector<uint32_t> timestamps(positions.size(), 0);
+    uint32_t time = ANALYSIS_CACHE_SIZE + 1;
+    auto countMisses = [&](size_t t) {
+        uint32_t misses = 0;
+        for (int corner = 0; corner < 3; corner++) {
+            uint16_t index = indices[t * 3 + corner];
+            if (time - timestamps[index] > ANALYSIS_CACHE_SIZE) {
+                timestamps[index] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    };
+
+    std::vector<size_t> hardStarts = {0};
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (countMisses(t) == 3 && t != 0) {
+            hardStarts.push_back(t);
+        }
+    }
+    hardStarts.push_back(triangleCount);
+
+    // Step 2: Soft boundaries split a hard cluster as soon as the part since the last split,
+    // simulated from a cold cache, is within threshold of the ACMR of the whole hard cluster.
+    // Every cluster then costs about the same wherever it ends up in the order.
+    std::vector<size_t> clusterStarts;
+    for (size_t h = 0; h + 1 < hardStarts.size(); h++) {
+        const size_t begin = hardStarts[h];
+        const size_t end = hardStarts[h + 1];
+
+        time += ANALYSIS_CACHE_SIZE + 1;
+        uint32_t hardMisses = 0;
+        for (size_t t = begin; t < end; t++) {
+            hardMisses += countMisses(t);
+        }
+        const float limit = threshold * static_cast<float>(hardMisses) / static_cast<float>(end - begin);
+
+        time += ANALYSIS_CACHE_SIZE + 1;
+        clusterStarts.push_back(begin);
+        size_t softStart = begin;
+        uint32_t softMisses = 0;
+        for (size_t t = begin; t < end; t++) {
+            softMisses += countMisses(t);
+            if (t + 1 < end && static_cast<float>(softMisses) <= limit * static_cast<float>(t + 1 - softStart)) {
+                clusterStarts.push_back(t + 1);
+                softStart = t + 1;
+                softMisses = 0;
+                time += ANALYSIS_CACHE_SIZE + 1;
+            }
+        }
+    }
+    if (clusterStarts.size() < 2) {
+        return false;
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Step 3: Sort key of a cluster is how far its centroid lies along its mean normal
+    glm::vec3 meshCentroid(0.0f);
+    for (uint16_t index : indices) {
+        meshCentroid += positions[index];
+    }
+    meshCentroid = meshCentroid / static_cast<float>(indices.size());
+
+    const size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<float> sortKeys(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; c++) {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+            const glm::vec3& p0 = positions[indices[t * 3]];
+            const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+            const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+            glm::vec3 weightedNormal = glm::cross(p1 - p0, p2 - p0);
+            float triangleArea = glm::length(weightedNormal);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += weightedNormal;
+            area += triangleArea;
+        }
+        float normalLength = glm::length(normal);
+        if (area > 0.0f && normalLength > 0.0f) {
+            sortKeys[c] = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+        }
+    }
+
+    auto [minKey, maxKey] = std::minmax_element(sortKeys.begin(), sortKeys.end());
+    if (*maxKey - *minKey <= std::numeric_limits<float>::epsilon() * (std::fabs(*maxKey) + 1.0f)) {
+        // Every cluster faces the same way, as in a flat mesh, so no order is better than another
+        return false;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) {
+        return sortKeys[a] > sortKeys[b];
+    });
+
+    std::vector<uint16_t> reordered;
+    reordered.reserve(indices.size());
+    for (size_t c : order) {
+        reordered.insert(reordered.end(), indices.begin() + clusterStarts[c] * 3,
+                         indices.begin() + clusterStarts[c + 1] * 3);
+    }
+
+    // Step 4: Keep the new order only if it costs little vertex cache efficiency
+    if (analyzeVertexCache(reordered, positions.size()).acmr > acmrBefore * threshold) {
+        return false;
+    }
+    indices.swap(reordered);
+    return true;
+}
+// --------------------------------------------------------------------------------
+
+std::vector<uint32_t> buildVertexFetchRemap(std::vector<uint16_t>& indices, size_t vertexCount) {
+    validateTriangleList(indices, vertexCount);
+
+    std::vector<uint32_t> newIndices(vertexCount, std::numeric_limits<uint32_t>::max());
+    std::vector<uint32_t> remap;
+    remap.reserve(vertexCount);
+    for (uint16_t& index : indices) {
+        if (newIndices[index] == std::numeric_limits<uint32_t>::max()) {
+            newIndices[index] = static_cast<uint32_t>(remap.size());
+            remap.push_back(index);
+        }
+        index = static_cast<uint16_t>(newIndices[index]);
+    }
+    return remap;
+}
+// ================================================================================
+// ================================================================================
+// eof
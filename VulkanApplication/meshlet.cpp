@@ -0,0 +1,167 @@
+// ================================================================================
+// ================================================================================
+// - File:    meshlet.cpp
+// - Purpose: This file contains the implementation of the meshlet builder.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/meshlet.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Smallest dot product of a triangle normal with the cone axis that still allows cone culling.
+ *
+ * Wider cones cull so rarely that the test is not worth running.
+ */
+static constexpr float MIN_CONE_DOT = 0.1f;
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Computes the bounding sphere and normal cone of one meshlet.
+ *
+ * @param meshlet The meshlet whose firstIndex, indexCount and vertexCount are set.
+ * @param indices The triangle list of the mesh.
+ * @param positions The position of every vertex.
+ */
+static void computeMeshletBounds(Meshlet& meshlet, const std::vector<uint16_t>& indices,
+                                 const std::vector<glm::vec3>& positions) {
+    const uint16_t* first = indices.data() + meshlet.firstIndex;
+
+    // Step 1: Bound the triangles by a sphere centered on their axis aligned box
+    glm::vec3 minPos = positions[first[0]];
+    glm::vec3 maxPos = minPos;
+    for (uint32_t i = 1; i < meshlet.indexCount; i++) {
+        minPos = glm::min(minPos, positions[first[i]]);
+        maxPos = glm::max(maxPos, positions[first[i]]);
+    }
+    glm::vec3 center = 0.5f * (minPos + maxPos);
+    float radius = 0.0f;
+    for (uint32_t i = 0; i < meshlet.indexCount; i++) {
+        radius = glm::max(radius, glm::length(positions[first[i]] - center));
+    }
+    meshlet.sphere = glm::vec4(center, radius);
+
+    // Step 2: Average the unit normals of the triangles, skipping degenerate ones
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.indexCount / 3);
+    glm::vec3 axis(0.0f);
+    for (uint32_t i = 0; i < meshlet.indexCount; i += 3) {
+        const glm::vec3& a = positions[first[i]];
+        glm::vec3 normal = glm::cross(positions[first[i + 1]] - a, positions[first[i + 2]] - a);
+        float area = glm::length(normal);
+        if (area > 0.0f) {
+            normals.push_back(normal / area);
+            axis += normals.back();
+        }
+    }
+
+    // Step 3: The cone must contain every normal, else its cutoff disables the test
+    meshlet.cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    float axisLength = glm::length(axis);
+    if (normals.empty() || axisLength == 0.0f) {
+        return;
+    }
+    axis /= axisLength;
+    float minDot = 1.0f;
+    for (const glm::vec3& normal : normals) {
+        minDot = glm::min(minDot, glm::dot(normal, axis));
+    }
+    if (minDot > MIN_CONE_DOT) {
+        meshlet.cone = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+    }
+}
+// ================================================================================
+// ================================================================================
+
+
+std::vector<Meshlet> buildMeshlets(const std::vector<uint16_t>& indices,
+                                   const std::vector<glm::vec3>& positions,
+                                   uint32_t maxVertices,
+                                   uint32_t maxTriangles) {
+    if (maxVertices < 3 || maxTriangles == 0) {
+        throw std::invalid_argument("A meshlet must be able to hold at least one triangle!");
+    }
+    if (indices.size() % 3 != 0) {
+        throw std::invalid_argument("Index count " + std::to_string(indices.size()) +
+                                    " is not a multiple of three!");
+    }
+    for (uint16_t index : indices) {
+        if (index >= positions.size()) {
+            throw std::invalid_argument("Index " + std::to_string(index) + " addresses one of only " +
+                                        std::to_string(positions.size()) + " vertices!");
+        }
+    }
+
+    std::vector<Meshlet> meshlets;
+    if (indices.empty()) {
+        return meshlets;
+    }
+
+    // A vertex belongs to the current meshlet if it is stamped with the meshlet's number plus one
+    std::vector<uint32_t> stamps(positions.size(), 0);
+    Meshlet current{};
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        uint32_t stamp = static_cast<uint32_t>(meshlets.size()) + 1;
+        uint32_t newVertices = 0;
+        for (int corner = 0; corner < 3; corner++) {
+            uint16_t index = indices[i + corner];
+            bool repeated = (corner > 0 && indices[i] == index) || (corner > 1 && indices[i + 1] == index);
+            if (stamps[index] != stamp && !repeated) {
+                newVertices++;
+            }
+        }
+
+        if (current.indexCount != 0 &&
+            (current.vertexCount + newVertices > maxVertices || current.indexCount / 3 + 1 > maxTriangles)) {
+            meshlets.push_back(current);
+            current = Meshlet{};
+            current.firstIndex = static_cast<uint32_t>(i);
+            stamp++;
+            newVertices = 0;
+            for (int corner = 0; corner < 3; corner++) {
+                uint16_t index = indices[i + corner];
+                bool repeated = (corner > 0 && indices[i] == index) || (corner > 1 && indices[i + 1] == index);
+                newVertices += repeated ? 0 : 1;
+            }
+        }
+
+        for (int corner = 0; corner < 3; corner++) {
+            stamps[indices[i + corner]] = stamp;
+        }
+        current.vertexCount += newVertices;
+        current.indexCount += 3;
+    }
+    meshlets.push_back(current);
+
+    for (Meshlet& meshlet : meshlets) {
+        computeMeshletBounds(meshlet, indices, positions);
+    }
+    return meshlets;
+}
+// --------------------------------------------------------------------------------
+
+bool validateMeshlets(const Meshlet* meshlets, size_t meshletCount, uint32_t indexCount) {
+    for (size_t i = 0; i < meshletCount; i++) {
+        const Meshlet& meshlet = meshlets[i];
+        if (meshlet.indexCount == 0 || meshlet.indexCount % 3 != 0 || meshlet.firstIndex % 3 != 0 ||
+            meshlet.firstIndex > indexCount || meshlet.indexCount > indexCount - meshlet.firstIndex) {
+            return false;
+        }
+    }
+    return true;
+}
+// ================================================================================
+// ================================================================================
+// eof
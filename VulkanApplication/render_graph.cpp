@@ -0,0 +1,667 @@
+// ================================================================================
+// ================================================================================
+// - File:    render_graph.cpp
+// - Purpose: This file contains the implementation of the RenderGraph class.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/render_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Every access flag that modifies memory, the only ones a barrier has to make available.
+ */
+static constexpr VkAccessFlags WRITE_ACCESS_MASK = VK_ACCESS_SHADER_WRITE_BIT |
+                                                   VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                                   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                                   VK_ACCESS_TRANSFER_WRITE_BIT |
+                                                   VK_ACCESS_HOST_WRITE_BIT |
+                                                   VK_ACCESS_MEMORY_WRITE_BIT;
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Retrieves the image usage an access requires.
+ *
+ * @param access The access.
+ * @return The usage flag, zero for accesses that only apply to buffers.
+ */
+static VkImageUsageFlags getAccessUsage(RenderGraphAccess access) {
+    switch (access) {
+        case RenderGraphAccess::ColorAttachmentWrite:
+            return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        case RenderGraphAccess::DepthAttachmentWrite:
+        case RenderGraphAccess::DepthAttachmentRead:
+            return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        case RenderGraphAccess::FragmentSampledRead:
+        case RenderGraphAccess::ComputeSampledRead:
+            return VK_IMAGE_USAGE_SAMPLED_BIT;
+        case RenderGraphAccess::ComputeStorageRead:
+        case RenderGraphAccess::ComputeStorageWrite:
+            return VK_IMAGE_USAGE_STORAGE_BIT;
+        case RenderGraphAccess::TransferRead:
+            return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        case RenderGraphAccess::TransferWrite:
+            return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        default:
+            return 0;
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Every usage that keeps an image inside render passes, where it may stay in tile memory.
+ */
+static constexpr VkImageUsageFlags ATTACHMENT_USAGE_MASK = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                                           VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                                           VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Checks if the lifetimes of two transient images share a pass.
+ *
+ * @param firstA The first pass using the first image.
+ * @param lastA The last pass using the first image.
+ * @param firstB The first pass using the second image.
+ * @param lastB The last pass using the second image.
+ * @return True if neither image is dead before the other one is first used.
+ */
+static bool lifetimesOverlap(uint32_t firstA, uint32_t lastA, uint32_t firstB, uint32_t lastB) {
+    return firstA <= lastB && firstB <= lastA;
+}
+// ================================================================================
+// ================================================================================
+
+RenderGraphState getAccessState(RenderGraphAccess access) {
+    const VkPipelineStageFlags fragmentTests = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                               VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    switch (access) {
+        case RenderGraphAccess::ColorAttachmentWrite:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        case RenderGraphAccess::DepthAttachmentWrite:
+            return {fragmentTests,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        case RenderGraphAccess::DepthAttachmentRead:
+            return {fragmentTests, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+        case RenderGraphAccess::FragmentSampledRead:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        case RenderGraphAccess::ComputeSampledRead:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        case RenderGraphAccess::ComputeStorageRead:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+        case RenderGraphAccess::ComputeStorageWrite:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_GENERAL};
+        case RenderGraphAccess::IndirectRead:
+            return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                    VK_IMAGE_LAYOUT_UNDEFINED};
+        case RenderGraphAccess::VertexInputRead:
+            return {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                    VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT,
+                    VK_IMAGE_LAYOUT_UNDEFINED};
+        case RenderGraphAccess::TransferRead:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+        case RenderGraphAccess::TransferWrite:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+    }
+    throw std::invalid_argument("Unknown render graph access!");
+}
+// --------------------------------------------------------------------------------
+
+bool isWriteAccess(RenderGraphAccess access) {
+    return (getAccessState(access).accessMask & WRITE_ACCESS_MASK) != 0;
+}
+// ================================================================================
+// ================================================================================
+
+RenderGraph::RenderGraph(VkDevice device, AllocatorManager& allocatorManager)
+    : device(device),
+      allocatorManager(allocatorManager) {}
+// --------------------------------------------------------------------------------
+
+RenderGraph::~RenderGraph() {
+    destroyTransientImages();
+}
+// --------------------------------------------------------------------------------
+
+RenderGraphResource RenderGraph::createImage(const std::string& name, const TransientImageDesc& desc) {
+    if (desc.format == VK_FORMAT_UNDEFINED) {
+        throw std::invalid_argument("Transient image " + name + " has no format!");
+    }
+
+    Resource resource;
+    resource.name = name;
+    resource.isImage = true;
+    resource.desc = desc;
+    resource.aspectMask = desc.aspectMask;
+    resources.push_back(resource);
+    compiled = false;
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+RenderGraphResource RenderGraph::importImage(const std::string& name, VkImageAspectFlags aspectMask,
+                                             const RenderGraphState& initialState,
+                                             const RenderGraphState& finalState) {
+    Resource resource;
+    resource.name = name;
+    resource.isImage = true;
+    resource.imported = true;
+    resource.aspectMask = aspectMask;
+    resource.initialState = initialState;
+    resource.finalState = finalState;
+    resources.push_back(resource);
+    compiled = false;
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+RenderGraphResource RenderGraph::importBuffer(const std::string& name) {
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resources.push_back(resource);
+    compiled = false;
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::addPass(const std::string& name, const std::vector<RenderGraphUse>& uses,
+                          ExecuteCallback execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+
+    for (const RenderGraphUse& use : uses) {
+        checkResource(use.resource);
+        const Resource& resource = resources[use.resource];
+
+        RenderGraphState state = getAccessState(use.access);
+        if (!resource.isImage) {
+            state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        } else if (state.layout == VK_IMAGE_LAYOUT_UNDEFINED) {
+            throw std::invalid_argument("Pass " + name + " uses image " + resource.name +
+                                        " with a buffer only access!");
+        }
+
+        auto merged = std::find_if(pass.uses.begin(), pass.uses.end(),
+                                   [&](const PassUse& p) { return p.resource == use.resource; });
+        if (merged == pass.uses.end()) {
+            pass.uses.push_back({use.resource, state, isWriteAccess(use.access), getAccessUsage(use.access)});
+            continue;
+        }
+        if (merged->state.layout != state.layout) {
+            throw std::invalid_argument("Pass " + name + " uses image " + resource.name + " in two layouts!");
+        }
+        merged->state.stageMask |= state.stageMask;
+        merged->state.accessMask |= state.accessMask;
+        merged->write = merged->write || isWriteAccess(use.access);
+        merged->usage |= getAccessUsage(use.access);
+    }
+
+    // The contents of a transient image only exist once a pass has produced them
+    for (const PassUse& use : pass.uses) {
+        const Resource& resource = resources[use.resource];
+        if (resource.imported || use.write) {
+            continue;
+        }
+        bool produced = std::any_of(passes.begin(), passes.end(), [&](const Pass& earlier) {
+            return std::any_of(earlier.uses.begin(), earlier.uses.end(), [&](const PassUse& p) {
+                return p.resource == use.resource && p.write;
+            });
+        });
+        if (!produced) {
+            throw std::invalid_argument("Pass " + name + " reads transient image " + resource.name +
+                                        " before any pass writes it!");
+        }
+    }
+
+    passes.push_back(std::move(pass));
+    compiled = false;
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::markOutput(RenderGraphResource resource) {
+    checkResource(resource);
+    resources[resource].output = true;
+    compiled = false;
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::compile(VkExtent2D extent) {
+    destroyTransientImages();
+    compiled = false;
+
+    // Step 1: Drop the passes no output depends on and find the lifetime of every resource
+    cullPasses();
+    compiledPasses.clear();
+    for (Resource& resource : resources) {
+        resource.firstPass = UINT32_MAX;
+        resource.lastPass = 0;
+        resource.usage = 0;
+    }
+    for (uint32_t i = 0; i < passes.size(); i++) {
+        if (passes[i].culled) {
+            continue;
+        }
+        uint32_t compiledIndex = static_cast<uint32_t>(compiledPasses.size());
+        compiledPasses.push_back(i);
+        for (const PassUse& use : passes[i].uses) {
+            Resource& resource = resources[use.resource];
+            resource.firstPass = std::min(resource.firstPass, compiledIndex);
+            resource.lastPass = std::max(resource.lastPass, compiledIndex);
+            resource.usage |= use.usage;
+        }
+    }
+
+    // Step 2: Create the transient images and alias the ones that are never alive together
+    createTransientImages(extent);
+
+    // Step 3: Simulate the frame once to learn the state every transient image is left in
+    std::vector<TrackedState> initialStates(resources.size());
+    for (size_t i = 0; i < resources.size(); i++) {
+        const Resource& resource = resources[i];
+        if (resource.imported) {
+            initialStates[i].layout = resource.initialState.layout;
+            initialStates[i].writeStages = resource.initialState.stageMask;
+            initialStates[i].writeAccess = resource.initialState.accessMask & WRITE_ACCESS_MASK;
+        }
+    }
+    std::vector<TrackedState> endStates;
+    buildBarriers(initialStates, endStates);
+
+    // Step 4: The first use of an aliased image waits for the image that used the memory before it,
+    // which for the first image is the last one of the previous frame
+    for (const AliasedMemory& memory : aliasedMemory) {
+        for (size_t i = 0; i < memory.images.size(); i++) {
+            RenderGraphResource previous = memory.images[(i + memory.images.size() - 1) % memory.images.size()];
+            TrackedState& initial = initialStates[memory.images[i]];
+            initial.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            initial.writeStages = endStates[previous].writeStages | endStates[previous].readStages;
+            initial.writeAccess = endStates[previous].writeAccess;
+        }
+    }
+    buildBarriers(initialStates, endStates);
+    compiled = true;
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view) {
+    checkResource(resource);
+    Resource& imported = resources[resource];
+    if (!imported.imported || !imported.isImage) {
+        throw std::invalid_argument("Resource " + imported.name + " is not an imported image!");
+    }
+    imported.image = image;
+    imported.view = view;
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer) {
+    if (!compiled) {
+        throw std::runtime_error("Render graph is executed before it is compiled!");
+    }
+
+    for (size_t i = 0; i < compiledPasses.size(); i++) {
+        recordBarrier(commandBuffer, passBarriers[i]);
+        passes[compiledPasses[i]].execute(commandBuffer, *this);
+    }
+    recordBarrier(commandBuffer, finalBarrier);
+}
+// --------------------------------------------------------------------------------
+
+VkImage RenderGraph::getImage(RenderGraphResource resource) const {
+    checkResource(resource);
+    if (resources[resource].image == VK_NULL_HANDLE) {
+        throw std::runtime_error("Render graph image " + resources[resource].name + " does not exist!");
+    }
+    return resources[resource].image;
+}
+// --------------------------------------------------------------------------------
+
+VkImageView RenderGraph::getImageView(RenderGraphResource resource) const {
+    checkResource(resource);
+    if (resources[resource].view == VK_NULL_HANDLE) {
+        throw std::runtime_error("Render graph image " + resources[resource].name + " has no view!");
+    }
+    return resources[resource].view;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t RenderGraph::getCompiledPassCount() const {
+    return static_cast<uint32_t>(compiledPasses.size());
+}
+// --------------------------------------------------------------------------------
+
+uint32_t RenderGraph::getBarrierCount() const {
+    uint32_t count = finalBarrier.dstStageMask != 0 ? 1 : 0;
+    for (const Barrier& barrier : passBarriers) {
+        if (barrier.dstStageMask != 0) {
+            count++;
+        }
+    }
+    return count;
+}
+// --------------------------------------------------------------------------------
+
+VkDeviceSize RenderGraph::getTransientMemorySize() const {
+    VkDeviceSize size = 0;
+    for (const AliasedMemory& memory : aliasedMemory) {
+        size += memory.requirements.size;
+    }
+    return size;
+}
+// --------------------------------------------------------------------------------
+
+bool RenderGraph::isLazilyAllocated(RenderGraphResource resource) const {
+    checkResource(resource);
+    return std::any_of(aliasedMemory.begin(), aliasedMemory.end(), [&](const AliasedMemory& memory) {
+        return memory.lazilyAllocated &&
+               std::find(memory.images.begin(), memory.images.end(), resource) != memory.images.end();
+    });
+}
+// --------------------------------------------------------------------------------
+
+VkDeviceSize RenderGraph::getUnaliasedMemorySize() const {
+    VkDeviceSize size = 0;
+    for (const AliasedMemory& memory : aliasedMemory) {
+        for (RenderGraphResource image : memory.images) {
+            size += resources[image].requirements.size;
+        }
+    }
+    return size;
+}
+// ================================================================================
+
+void RenderGraph::checkResource(RenderGraphResource resource) const {
+    if (resource >= resources.size()) {
+        throw std::out_of_range("Render graph resource is out of bounds!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::cullPasses() {
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t i = 0; i < resources.size(); i++) {
+        needed[i] = resources[i].output;
+    }
+
+    // Walk backwards so a pass is only kept once a later kept pass, or an output, needs what it writes.
+    // Everything a kept pass touches is needed, since an attachment may be loaded rather than cleared.
+    for (size_t i = passes.size(); i-- > 0;) {
+        Pass& pass = passes[i];
+        pass.culled = std::none_of(pass.uses.begin(), pass.uses.end(), [&](const PassUse& use) {
+            return use.write && needed[use.resource];
+        });
+        if (pass.culled) {
+            continue;
+        }
+        for (const PassUse& use : pass.uses) {
+            needed[use.resource] = true;
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::createTransientImages(VkExtent2D extent) {
+    try {
+        std::vector<RenderGraphResource> images;
+        for (RenderGraphResource i = 0; i < resources.size(); i++) {
+            Resource& resource = resources[i];
+            if (resource.imported || !resource.isImage || resource.firstPass == UINT32_MAX) {
+                continue;
+            }
+
+            VkImageCreateInfo imageInfo = {};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = resource.desc.format;
+            imageInfo.extent.width = resource.desc.extent.width != 0 ? resource.desc.extent.width : extent.width;
+            imageInfo.extent.height = resource.desc.extent.height != 0 ? resource.desc.extent.height : extent.height;
+            imageInfo.extent.depth = 1;
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = resource.desc.samples;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            // Images that are only ever attachments may be backed by lazily allocated memory
+            if ((resource.usage & ~ATTACHMENT_USAGE_MASK) == 0) {
+                resource.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+            }
+            imageInfo.usage = resource.usage;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            if (vkCreateImage(device, &imageInfo, nullptr, &resource.image) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create transient image " + resource.name + "!");
+            }
+            vkGetImageMemoryRequirements(device, resource.image, &resource.requirements);
+            images.push_back(i);
+        }
+
+        // Place the largest images first, each into the first memory whose images are all dead by then
+        std::sort(images.begin(), images.end(), [&](RenderGraphResource a, RenderGraphResource b) {
+            return resources[a].requirements.size > resources[b].requirements.size;
+        });
+        for (RenderGraphResource image : images) {
+            const Resource& resource = resources[image];
+            auto memory = std::find_if(aliasedMemory.begin(), aliasedMemory.end(), [&](const AliasedMemory& m) {
+                return (m.requirements.memoryTypeBits & resource.requirements.memoryTypeBits) != 0 &&
+                       std::none_of(m.images.begin(), m.images.end(), [&](RenderGraphResource other) {
+                           return lifetimesOverlap(resource.firstPass, resource.lastPass,
+                                                   resources[other].firstPass, resources[other].lastPass);
+                       });
+            });
+            if (memory == aliasedMemory.end()) {
+                aliasedMemory.push_back({VK_NULL_HANDLE, resource.requirements, {}});
+                memory = aliasedMemory.end() - 1;
+            }
+            memory->requirements.size = std::max(memory->requirements.size, resource.requirements.size);
+            memory->requirements.alignment = std::max(memory->requirements.alignment,
+                                                      resource.requirements.alignment);
+            memory->requirements.memoryTypeBits &= resource.requirements.memoryTypeBits;
+            memory->images.push_back(image);
+        }
+
+        for (AliasedMemory& memory : aliasedMemory) {
+            std::sort(memory.images.begin(), memory.images.end(), [&](RenderGraphResource a, RenderGraphResource b) {
+                return resources[a].firstPass < resources[b].firstPass;
+            });
+            // Tile based GPUs never back lazily allocated memory, others fall back to device local memory
+            bool transient = std::all_of(memory.images.begin(), memory.images.end(), [&](RenderGraphResource image) {
+                return (resources[image].usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+            });
+            VmaAllocationCreateInfo lazyInfo = {};
+            lazyInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+            uint32_t memoryTypeIndex = 0;
+            memory.lazilyAllocated = transient &&
+                vmaFindMemoryTypeIndex(allocatorManager.getAllocator(), memory.requirements.memoryTypeBits,
+                                       &lazyInfo, &memoryTypeIndex) == VK_SUCCESS;
+            VkMemoryPropertyFlags requiredFlags = memory.lazilyAllocated ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT
+                                                                         : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            allocatorManager.allocateMemory(memory.requirements, requiredFlags, memory.allocation);
+
+            for (RenderGraphResource image : memory.images) {
+                Resource& resource = resources[image];
+                allocatorManager.bindImageMemory(memory.allocation, resource.image);
+
+                VkImageViewCreateInfo viewInfo = {};
+                viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                viewInfo.image = resource.image;
+                viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                viewInfo.format = resource.desc.format;
+                viewInfo.subresourceRange.aspectMask = resource.aspectMask;
+                viewInfo.subresourceRange.baseMipLevel = 0;
+                viewInfo.subresourceRange.levelCount = 1;
+                viewInfo.subresourceRange.baseArrayLayer = 0;
+                viewInfo.subresourceRange.layerCount = 1;
+
+                if (vkCreateImageView(device, &viewInfo, nullptr, &resource.view) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create transient image view " + resource.name + "!");
+                }
+            }
+        }
+    } catch (const std::runtime_error&) {
+        destroyTransientImages();
+        throw;
+    }
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::destroyTransientImages() {
+    for (Resource& resource : resources) {
+        if (resource.imported) {
+            continue;
+        }
+        if (resource.view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, resource.view, nullptr);
+            resource.view = VK_NULL_HANDLE;
+        }
+        if (resource.image != VK_NULL_HANDLE) {
+            vkDestroyImage(device, resource.image, nullptr);
+            resource.image = VK_NULL_HANDLE;
+        }
+    }
+    for (AliasedMemory& memory : aliasedMemory) {
+        if (memory.allocation != VK_NULL_HANDLE) {
+            allocatorManager.freeMemory(memory.allocation);
+        }
+    }
+    aliasedMemory.clear();
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::buildBarriers(const std::vector<TrackedState>& initialStates,
+                                std::vector<TrackedState>& endStates) {
+    endStates = initialStates;
+    passBarriers.assign(compiledPasses.size(), Barrier{});
+
+    for (size_t i = 0; i < compiledPasses.size(); i++) {
+        for (const PassUse& use : passes[compiledPasses[i]].uses) {
+            addDependency(passBarriers[i], endStates[use.resource], use.resource, use.state, use.write);
+        }
+    }
+
+    // Imported images are handed back in the state the caller expects, such as ready to present
+    finalBarrier = Barrier{};
+    std::vector<TrackedState> finalStates = endStates;
+    for (RenderGraphResource i = 0; i < resources.size(); i++) {
+        const Resource& resource = resources[i];
+        if (resource.imported && resource.isImage && resource.finalState.stageMask != 0) {
+            addDependency(finalBarrier, finalStates[i], i, resource.finalState, false);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::addDependency(Barrier& barrier, TrackedState& tracked, RenderGraphResource resource,
+                                const RenderGraphState& state, bool write) const {
+    // A layout change rewrites the image, so it waits for every earlier use and is waited on like a write
+    if (resources[resource].isImage && tracked.layout != state.layout) {
+        barrier.srcStageMask |= tracked.writeStages | tracked.readStages;
+        barrier.dstStageMask |= state.stageMask;
+        barrier.transitions.push_back({resource, tracked.writeAccess, state.accessMask,
+                                       tracked.layout, state.layout});
+        tracked.layout = state.layout;
+        tracked.writeStages = state.stageMask;
+        tracked.writeAccess = write ? state.accessMask & WRITE_ACCESS_MASK : 0;
+        tracked.readStages = write ? 0 : state.stageMask;
+        tracked.visibleStages = state.stageMask;
+        tracked.visibleAccess = state.accessMask;
+        return;
+    }
+
+    if (write) {
+        // Write after write needs the memory dependency, write after read only the execution one
+        if ((tracked.writeStages | tracked.readStages) != 0) {
+            barrier.srcStageMask |= tracked.writeStages | tracked.readStages;
+            barrier.srcAccessMask |= tracked.writeAccess;
+            barrier.dstStageMask |= state.stageMask;
+            barrier.dstAccessMask |= state.accessMask;
+        }
+        tracked.writeStages = state.stageMask;
+        tracked.writeAccess = state.accessMask & WRITE_ACCESS_MASK;
+        tracked.readStages = 0;
+        tracked.visibleStages = state.stageMask;
+        tracked.visibleAccess = state.accessMask;
+        return;
+    }
+
+    // A read waits only if an earlier barrier has not already made the last write visible to it
+    bool visible = (tracked.visibleStages & state.stageMask) == state.stageMask &&
+                   (tracked.visibleAccess & state.accessMask) == state.accessMask;
+    if (tracked.writeStages != 0 && !visible) {
+        barrier.srcStageMask |= tracked.writeStages;
+        barrier.srcAccessMask |= tracked.writeAccess;
+        barrier.dstStageMask |= state.stageMask;
+        barrier.dstAccessMask |= state.accessMask;
+        tracked.visibleStages |= state.stageMask;
+        tracked.visibleAccess |= state.accessMask;
+    }
+    tracked.readStages |= state.stageMask;
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::recordBarrier(VkCommandBuffer commandBuffer, const Barrier& barrier) const {
+    if (barrier.dstStageMask == 0) {
+        return;
+    }
+
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = barrier.srcAccessMask;
+    memoryBarrier.dstAccessMask = barrier.dstAccessMask;
+    const uint32_t memoryBarrierCount = (barrier.srcAccessMask | barrier.dstAccessMask) != 0 ? 1 : 0;
+
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    imageBarriers.reserve(barrier.transitions.size());
+    for (const ImageTransition& transition : barrier.transitions) {
+        const Resource& resource = resources[transition.resource];
+        if (resource.image == VK_NULL_HANDLE) {
+            throw std::runtime_error("Render graph image " + resource.name + " has no handle!");
+        }
+
+        VkImageMemoryBarrier imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.srcAccessMask = transition.srcAccessMask;
+        imageBarrier.dstAccessMask = transition.dstAccessMask;
+        imageBarrier.oldLayout = transition.oldLayout;
+        imageBarrier.newLayout = transition.newLayout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = resource.image;
+        imageBarrier.subresourceRange.aspectMask = resource.aspectMask;
+        imageBarrier.subresourceRange.baseMipLevel = 0;
+        imageBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        imageBarrier.subresourceRange.baseArrayLayer = 0;
+        imageBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        imageBarriers.push_back(imageBarrier);
+    }
+
+    // Nothing ran before the first use of a resource, so that use only waits for the start of the command buffer
+    VkPipelineStageFlags srcStageMask = barrier.srcStageMask != 0 ? barrier.srcStageMask
+                                                                  : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, srcStageMask, barrier.dstStageMask, 0,
+                         memoryBarrierCount, &memoryBarrier, 0, nullptr,
+                         static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -1,17 +1,31 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
-layout(binding = 0) uniform UniformBufferObject {
+// Every storage buffer of the renderer lives in the bindless array at binding 0
+layout(set = 0, binding = 0) readonly buffer FrameData {
     mat4 model;
     mat4 view;
     mat4 proj;
-} ubo;
+} frames[];
+
+// Mirrors DrawConstants in graphics.hpp
+layout(push_constant) uniform DrawConstants {
+    mat4 model;
+    uint objectIndex;
+    uint materialId;
+    uint frameData;
+} pc;
 
 layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 fragColor;
 
+// The depth pre-pass and the shading pass must compute bit identical depth for the EQUAL test
+invariant gl_Position;
+
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 0.0, 1.0);
+    gl_Position = frames[pc.frameData].proj * frames[pc.frameData].view *
+                  pc.model * vec4(inPosition, 0.0, 1.0);
     fragColor = inColor;
 }
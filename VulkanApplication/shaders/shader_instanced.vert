@@ -0,0 +1,33 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Every storage buffer of the renderer lives in the bindless array at binding 0
+layout(set = 0, binding = 0) readonly buffer FrameData {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} frames[];
+
+// Mirrors DrawConstants in graphics.hpp
+layout(push_constant) uniform DrawConstants {
+    mat4 model;
+    uint objectIndex;
+    uint materialId;
+    uint frameData;
+} pc;
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in mat4 instanceTransform;
+layout(location = 6) in vec4 instanceColor;
+
+layout(location = 0) out vec3 fragColor;
+
+// The depth pre-pass and the shading pass must compute bit identical depth for the EQUAL test
+invariant gl_Position;
+
+void main() {
+    gl_Position = frames[pc.frameData].proj * frames[pc.frameData].view *
+                  instanceTransform * vec4(inPosition, 0.0, 1.0);
+    fragColor = inColor * instanceColor.rgb;
+}
@@ -0,0 +1,338 @@
+// ================================================================================
+// ================================================================================
+// - File:    streaming.cpp
+// - Purpose: This file contains the implementation of the AssetStreamer class.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/streaming.hpp"
+#include "include/vertex_formats.hpp"
+
+#include <algorithm>
+#include <cstring>  // memcpy
+#include <limits>
+#include <stdexcept>
+#include <string>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Reads one byte of every page so the kernel faults the range in on the calling thread.
+ */
+static void touchPages(const void* data, size_t size) {
+    constexpr size_t TOUCH_STRIDE = 4096;
+    const volatile unsigned char* bytes = static_cast<const unsigned char*>(data);
+    unsigned char sink = 0;
+    for (size_t offset = 0; offset < size; offset += TOUCH_STRIDE) {
+        sink ^= bytes[offset];
+    }
+    (void) sink;
+}
+// ================================================================================
+// ================================================================================
+
+
+AssetStreamer::AssetStreamer(AllocatorManager& allocatorManager,
+                             MeshRegistry& meshRegistry,
+                             VkDeviceSize uploadBytesPerFrame,
+                             uint32_t uploadCopiesPerFrame)
+    : allocatorManager(allocatorManager),
+      meshRegistry(meshRegistry),
+      uploadBytesPerFrame(uploadBytesPerFrame),
+      uploadCopiesPerFrame(uploadCopiesPerFrame) {
+    if (uploadBytesPerFrame == 0 || uploadCopiesPerFrame == 0) {
+        throw std::invalid_argument("Asset streaming budgets must be larger than zero!");
+    }
+
+    // Nothing is staged when the shared buffers are written in place
+    try {
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT && !meshRegistry.isDirectWrite(); i++) {
+            void* data = nullptr;
+            allocatorManager.createBuffer(uploadBytesPerFrame, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                          MemoryClass::Upload,
+                                          stagingBuffers[i], stagingAllocations[i]);
+            allocatorManager.mapMemory(stagingAllocations[i], &data);
+            stagingMapped[i] = static_cast<unsigned char*>(data);
+        }
+    } catch (const std::runtime_error&) {
+        destroyBuffers();
+        throw;
+    }
+
+    loaderThread = std::thread(&AssetStreamer::loaderLoop, this);
+}
+// --------------------------------------------------------------------------------
+
+AssetStreamer::~AssetStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        stopping = true;
+    }
+    requestReady.notify_all();
+    loaderThread.join();
+
+    // Ranges of unfinished uploads stay reserved and are released with the registry
+    destroyBuffers();
+}
+// --------------------------------------------------------------------------------
+
+uint32_t AssetStreamer::requestMesh(const std::string& filename) {
+    uint32_t requestId;
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        requestId = nextRequestId++;
+        entries[requestId].filename = filename;
+        requestQueue.push_back(requestId);
+    }
+    requestReady.notify_one();
+    return requestId;
+}
+// --------------------------------------------------------------------------------
+
+Residency AssetStreamer::getResidency(uint32_t requestId) const {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    auto it = entries.find(requestId);
+    if (it == entries.end()) {
+        throw std::out_of_range("Stream request " + std::to_string(requestId) + " does not exist!");
+    }
+    return it->second.residency;
+}
+// --------------------------------------------------------------------------------
+
+MeshHandle AssetStreamer::getMesh(uint32_t requestId) const {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    auto it = entries.find(requestId);
+    if (it == entries.end() || it->second.residency != Residency::Resident) {
+        throw std::out_of_range("Stream request " + std::to_string(requestId) + " is not resident!");
+    }
+    return it->second.mesh;
+}
+// --------------------------------------------------------------------------------
+
+std::string AssetStreamer::getError(uint32_t requestId) const {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    auto it = entries.find(requestId);
+    if (it == entries.end()) {
+        throw std::out_of_range("Stream request " + std::to_string(requestId) + " does not exist!");
+    }
+    return it->second.error;
+}
+// --------------------------------------------------------------------------------
+
+size_t AssetStreamer::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    return static_cast<size_t>(std::count_if(entries.begin(), entries.end(), [](const auto& entry) {
+        return entry.second.residency == Residency::Requested || entry.second.residency == Residency::Uploading;
+    }));
+}
+// --------------------------------------------------------------------------------
+
+void AssetStreamer::recordUploads(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    if (frameIndex >= MAX_FRAMES_IN_FLIGHT) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+
+    // Step 1: The fence of this frame has been waited on, so its previous copies are complete
+    if (!completingRequests[frameIndex].empty()) {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        for (uint32_t requestId : completingRequests[frameIndex]) {
+            entries[requestId].residency = Residency::Resident;
+        }
+        completingRequests[frameIndex].clear();
+    }
+
+    reserveLoadedMeshes();
+
+    // Step 2: Copy as many bytes as the budget allows, splitting a blob across frames if needed
+    VkDeviceSize budget = uploadBytesPerFrame;
+    uint32_t copiesLeft = uploadCopiesPerFrame;
+    VkDeviceSize stagingOffset = 0;
+    std::vector<VkBufferCopy> vertexCopies;
+    std::vector<VkBufferCopy> indexCopies;
+    std::vector<VkBufferCopy> meshletCopies;
+
+    while (!uploadQueue.empty() && budget > 0 && copiesLeft > 0) {
+        PendingUpload& upload = uploadQueue.front();
+
+        // The blobs are copied in file order, vertices, then indices, then meshlets
+        VkDeviceSize partCopied = upload.copiedBytes;
+        const unsigned char* source;
+        VkBuffer dstBuffer;
+        VkDeviceSize dstOffset;
+        VkDeviceSize remaining;
+        std::vector<VkBufferCopy>* copies;
+        if (partCopied < upload.vertexBytes) {
+            source = static_cast<const unsigned char*>(upload.file->getVertexData()) + partCopied;
+            dstBuffer = meshRegistry.getVertexBuffer();
+            dstOffset = upload.mesh.vertexOffset * sizeof(RenderVertex) + partCopied;
+            remaining = upload.vertexBytes - partCopied;
+            copies = &vertexCopies;
+        } else if ((partCopied -= upload.vertexBytes) < upload.indexBytes) {
+            source = static_cast<const unsigned char*>(upload.file->getIndexData()) + partCopied;
+            dstBuffer = meshRegistry.getIndexBuffer();
+            dstOffset = upload.mesh.firstIndex * sizeof(uint16_t) + partCopied;
+            remaining = upload.indexBytes - partCopied;
+            copies = &indexCopies;
+        } else {
+            partCopied -= upload.indexBytes;
+            source = static_cast<const unsigned char*>(upload.file->getMeshletData()) + partCopied;
+            dstBuffer = meshRegistry.getMeshletBuffer();
+            dstOffset = upload.mesh.firstMeshlet * sizeof(Meshlet) + partCopied;
+            remaining = upload.meshletBytes - partCopied;
+            copies = &meshletCopies;
+        }
+
+        // Host visible shared buffers are written in place, the rest goes through the staging buffer
+        VkDeviceSize chunk = std::min(remaining, budget);
+        if (meshRegistry.isDirectWrite()) {
+            meshRegistry.writeShared(dstBuffer, dstOffset, source, chunk);
+        } else {
+            memcpy(stagingMapped[frameIndex] + stagingOffset, source, static_cast<size_t>(chunk));
+            copies->push_back({stagingOffset, dstOffset, chunk});
+            stagingOffset += chunk;
+        }
+        budget -= chunk;
+        copiesLeft--;
+        upload.copiedBytes += chunk;
+
+        if (upload.copiedBytes == upload.vertexBytes + upload.indexBytes + upload.meshletBytes) {
+            // Dropping the upload unmaps the file
+            completingRequests[frameIndex].push_back(upload.requestId);
+            uploadQueue.pop_front();
+        }
+    }
+    lastUploadBytes = uploadBytesPerFrame - budget;
+
+    if (stagingOffset == 0) {
+        return;
+    }
+    allocatorManager.flushAllocation(stagingAllocations[frameIndex], 0, stagingOffset);
+
+    // Step 3: Record the copies, which the render graph makes visible to the passes reading them
+    if (!vertexCopies.empty()) {
+        vkCmdCopyBuffer(commandBuffer, stagingBuffers[frameIndex], meshRegistry.getVertexBuffer(),
+                        static_cast<uint32_t>(vertexCopies.size()), vertexCopies.data());
+    }
+    if (!indexCopies.empty()) {
+        vkCmdCopyBuffer(commandBuffer, stagingBuffers[frameIndex], meshRegistry.getIndexBuffer(),
+                        static_cast<uint32_t>(indexCopies.size()), indexCopies.data());
+    }
+    if (!meshletCopies.empty()) {
+        vkCmdCopyBuffer(commandBuffer, stagingBuffers[frameIndex], meshRegistry.getMeshletBuffer(),
+                        static_cast<uint32_t>(meshletCopies.size()), meshletCopies.data());
+    }
+}
+// --------------------------------------------------------------------------------
+
+VkDeviceSize AssetStreamer::getLastUploadBytes() const {
+    return lastUploadBytes;
+}
+// ================================================================================
+
+void AssetStreamer::loaderLoop() {
+    while (true) {
+        uint32_t requestId;
+        std::string filename;
+        {
+            std::unique_lock<std::mutex> lock(streamMutex);
+            requestReady.wait(lock, [this] { return stopping || !requestQueue.empty(); });
+            if (stopping) {
+                return;
+            }
+            requestId = requestQueue.front();
+            requestQueue.pop_front();
+            filename = entries[requestId].filename;
+        }
+
+        try {
+            PendingUpload upload;
+            upload.requestId = requestId;
+            upload.file = std::make_unique<MappedMeshFile>(filename);
+            if (!MeshRegistry::isCompatible(*upload.file)) {
+                throw std::runtime_error("Mesh file " + filename +
+                                         " does not match the VERTEX_FORMAT of this build or holds"
+                                         " invalid meshlets!");
+            }
+
+            const MeshFileHeader& header = upload.file->getHeader();
+            upload.vertexBytes = header.vertexSize;
+            upload.indexBytes = header.indexSize;
+            upload.meshletBytes = upload.file->hasMeshlets() ? header.meshletSize : 0;
+
+            // Fault the blobs in here so the copies on the render thread never wait on disk
+            touchPages(upload.file->getVertexData(), static_cast<size_t>(upload.vertexBytes));
+            touchPages(upload.file->getIndexData(), static_cast<size_t>(upload.indexBytes));
+            touchPages(upload.file->getMeshletData(), static_cast<size_t>(upload.meshletBytes));
+
+            std::lock_guard<std::mutex> lock(streamMutex);
+            loadedQueue.push_back(std::move(upload));
+        } catch (const std::exception& e) {
+            // Anything escaping here would terminate the process, so bad_alloc and
+            // filesystem errors fail the request like a bad file does
+            fail(requestId, e.what());
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void AssetStreamer::reserveLoadedMeshes() {
+    std::deque<PendingUpload> loaded;
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        loaded.swap(loadedQueue);
+    }
+
+    for (PendingUpload& upload : loaded) {
+        const MeshFileHeader& header = upload.file->getHeader();
+        glm::vec4 bounds = upload.file->hasBounds()
+            ? upload.file->getBounds()
+            : glm::vec4(0.0f, 0.0f, 0.0f, std::numeric_limits<float>::infinity());
+        try {
+            upload.mesh = meshRegistry.reserveMesh(header.vertexCount, header.indexCount, bounds,
+                                                   upload.file->hasMeshlets() ? header.meshletCount : 0);
+        } catch (const std::runtime_error& e) {
+            fail(upload.requestId, e.what());
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            StreamEntry& entry = entries[upload.requestId];
+            entry.residency = Residency::Uploading;
+            entry.mesh = upload.mesh;
+        }
+        uploadQueue.push_back(std::move(upload));
+    }
+}
+// --------------------------------------------------------------------------------
+
+void AssetStreamer::fail(uint32_t requestId, const std::string& error) {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    StreamEntry& entry = entries[requestId];
+    entry.residency = Residency::Failed;
+    entry.error = error;
+}
+// --------------------------------------------------------------------------------
+
+void AssetStreamer::destroyBuffers() {
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (stagingBuffers[i] != VK_NULL_HANDLE) {
+            if (stagingMapped[i] != nullptr) {
+                allocatorManager.unmapMemory(stagingAllocations[i]);
+                stagingMapped[i] = nullptr;
+            }
+            allocatorManager.destroyBuffer(stagingBuffers[i], stagingAllocations[i]);
+            stagingBuffers[i] = VK_NULL_HANDLE;
+        }
+    }
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,170 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_cpu_culling.cpp
+// - Purpose: Checks that every CpuFrustumCuller backend and thread count finds the
+//            same visible spheres as a plain scalar plane test.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../include/cpu_culling.hpp"
+// ================================================================================
+// ================================================================================
+
+// Spheres this close to a plane may land on either side once FMA rounds differently
+static constexpr float BOUNDARY_TOLERANCE = 1e-4f;
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Builds a frustum shaped like a perspective camera looking down -z.
+ */
+static Frustum makeFrustum() {
+    Frustum frustum;
+    const float side = 1.0f / std::sqrt(2.0f);
+    frustum.planes[0] = glm::vec4(side, 0.0f, -side, 0.0f);   // Left
+    frustum.planes[1] = glm::vec4(-side, 0.0f, -side, 0.0f);  // Right
+    frustum.planes[2] = glm::vec4(0.0f, side, -side, 0.0f);   // Bottom
+    frustum.planes[3] = glm::vec4(0.0f, -side, -side, 0.0f);  // Top
+    frustum.planes[4] = glm::vec4(0.0f, 0.0f, -1.0f, -0.5f);  // Near at z = -0.5
+    frustum.planes[5] = glm::vec4(0.0f, 0.0f, 1.0f, 50.0f);   // Far at z = -50
+    return frustum;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Scatters spheres around the frustum so that some are inside, some outside
+ *        and some straddle a plane.
+ */
+static std::vector<glm::vec4> makeSpheres(size_t count, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> lateral(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> depth(-60.0f, 5.0f);
+    std::uniform_real_distribution<float> radius(0.0f, 4.0f);
+    std::vector<glm::vec4> spheres(count);
+    for (glm::vec4& sphere : spheres) {
+        sphere = glm::vec4(lateral(generator), lateral(generator), depth(generator), radius(generator));
+    }
+    return spheres;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Distance of a sphere to the plane it is furthest outside of, in double precision.
+ *
+ * @return A negative value for a culled sphere, zero or more for a visible one.
+ */
+static double worstMargin(const Frustum& frustum, const glm::vec4& sphere) {
+    double worst = INFINITY;
+    for (const glm::vec4& plane : frustum.planes) {
+        double distance = static_cast<double>(plane.x) * sphere.x + static_cast<double>(plane.y) * sphere.y +
+                          static_cast<double>(plane.z) * sphere.z + plane.w;
+        worst = std::min(worst, distance + sphere.w);
+    }
+    return worst;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Culls the spheres with every supported backend and compares against worstMargin.
+ */
+static void expectMatchesScalar(const std::vector<glm::vec4>& spheres, uint32_t threadCount) {
+    const Frustum frustum = makeFrustum();
+    CpuFrustumCuller culler(threadCount);
+    for (const glm::vec4& sphere : spheres) {
+        culler.addObject(sphere);
+    }
+
+    for (CullBackend backend : {CullBackend::Scalar, CullBackend::SSE, CullBackend::AVX2}) {
+        if (!CpuFrustumCuller::isBackendSupported(backend)) {
+            continue;
+        }
+        culler.setBackend(backend);
+        std::vector<uint32_t> visible;
+        culler.cull(frustum, visible);
+
+        SCOPED_TRACE(std::string(CpuFrustumCuller::getBackendName(backend)) + " with " +
+                     std::to_string(spheres.size()) + " spheres on " + std::to_string(threadCount) + " thread(s)");
+        EXPECT_TRUE(std::is_sorted(visible.begin(), visible.end()));
+        size_t next = 0;
+        for (uint32_t i = 0; i < spheres.size(); i++) {
+            bool reported = next < visible.size() && visible[next] == i;
+            if (reported) {
+                next++;
+            }
+            double margin = worstMargin(frustum, spheres[i]);
+            if (std::abs(margin) > BOUNDARY_TOLERANCE) {
+                EXPECT_EQ(reported, margin >= 0.0) << "sphere " << i;
+            }
+        }
+        EXPECT_EQ(next, visible.size()) << "indices out of range or repeated";
+    }
+}
+// ================================================================================
+// ================================================================================
+
+TEST(CpuFrustumCuller, BackendsMatchScalarPlaneTest) {
+    expectMatchesScalar(makeSpheres(4096, 1), 1);
+}
+// --------------------------------------------------------------------------------
+
+TEST(CpuFrustumCuller, BackendsMatchOnEveryTailLength) {
+    // 0 to 17 objects covers an empty cull, partial SSE and AVX2 lanes and one full lane plus a tail
+    for (size_t count = 0; count <= 17; count++) {
+        expectMatchesScalar(makeSpheres(count, static_cast<uint32_t>(count) + 2), 1);
+    }
+    expectMatchesScalar(makeSpheres(1003, 3), 1);
+}
+// --------------------------------------------------------------------------------
+
+TEST(CpuFrustumCuller, ThreadsMatchScalarPlaneTest) {
+    // Chunks round up to eight objects, so the last thread gets a short or empty chunk
+    expectMatchesScalar(makeSpheres(1003, 4), 3);
+    expectMatchesScalar(makeSpheres(5, 5), 4);
+}
+// --------------------------------------------------------------------------------
+
+TEST(CpuFrustumCuller, SpheresTouchingAPlaneAreVisible) {
+    CpuFrustumCuller culler;
+    culler.addObject(glm::vec4(0.0f, 0.0f, 0.5f, 1.0f));    // Touches the near plane from outside
+    culler.addObject(glm::vec4(0.0f, 0.0f, -70.0f, 1.0f));  // Beyond the far plane
+    culler.addObject(glm::vec4(0.0f, 0.0f, -10.0f, 0.0f));  // A point in the middle
+    std::vector<uint32_t> visible;
+    EXPECT_EQ(culler.cull(makeFrustum(), visible), 2u);
+    EXPECT_EQ(visible, (std::vector<uint32_t>{0, 2}));
+}
+// --------------------------------------------------------------------------------
+
+TEST(CpuFrustumCuller, FromMatrixOfIdentityIsTheClipCube) {
+    Frustum frustum = Frustum::fromMatrix(glm::mat4(1.0f));
+    for (const glm::vec4& plane : frustum.planes) {
+        EXPECT_FLOAT_EQ(glm::length(glm::vec3(plane.x, plane.y, plane.z)), 1.0f);
+        EXPECT_FLOAT_EQ(plane.w, 1.0f);
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(CpuFrustumCuller, TransformSphereUsesTheLongestAxis) {
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, -3.0f));
+    transform = glm::scale(transform, glm::vec3(1.0f, 3.0f, 0.5f));
+    glm::vec4 sphere = transformSphere(glm::vec4(1.0f, 1.0f, 0.0f, 2.0f), transform);
+    EXPECT_FLOAT_EQ(sphere.x, 6.0f);
+    EXPECT_FLOAT_EQ(sphere.y, 3.0f);
+    EXPECT_FLOAT_EQ(sphere.z, -3.0f);
+    EXPECT_FLOAT_EQ(sphere.w, 6.0f);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,200 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_lod.cpp
+// - Purpose: Checks the LOD chain builder and the screen space error LOD selection.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../include/lod.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Builds a bumpy height field of side x side vertices, so that simplifying it costs error.
+ */
+static void makeTerrain(uint16_t side, std::vector<uint16_t>& indices, std::vector<glm::vec3>& positions) {
+    for (uint16_t y = 0; y < side; y++) {
+        for (uint16_t x = 0; x < side; x++) {
+            float height = 0.5f * std::sin(0.7f * x) * std::cos(0.5f * y);
+            positions.push_back(glm::vec3(static_cast<float>(x), static_cast<float>(y), height));
+        }
+    }
+    for (uint16_t y = 0; y + 1 < side; y++) {
+        for (uint16_t x = 0; x + 1 < side; x++) {
+            uint16_t corner = static_cast<uint16_t>(y * side + x);
+            uint16_t right = static_cast<uint16_t>(corner + 1);
+            uint16_t up = static_cast<uint16_t>(corner + side);
+            uint16_t diagonal = static_cast<uint16_t>(up + 1);
+            uint16_t quad[6] = {corner, right, diagonal, diagonal, up, corner};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Three levels whose errors grow by a factor of ten.
+ */
+static std::vector<MeshLod> makeLods() {
+    return {MeshLod{0, 600, 0.0f}, MeshLod{600, 300, 0.01f}, MeshLod{900, 150, 0.1f}};
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief A camera at the origin that covers 1000 pixels per unit at distance one.
+ */
+static LodCamera makeCamera() {
+    LodCamera camera;
+    camera.pixelsPerUnit = 1000.0f;
+    return camera;
+}
+// ================================================================================
+// ================================================================================
+
+TEST(LodChain, LevelsShrinkAndTheirErrorsGrow) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeTerrain(32, indices, positions);
+    LodChain chain = buildLodChain(indices, positions);
+
+    ASSERT_GT(chain.lods.size(), 1u);
+    ASSERT_LE(chain.lods.size(), MAX_MESH_LODS);
+    EXPECT_EQ(chain.lods[0].firstIndex, 0u);
+    EXPECT_EQ(chain.lods[0].indexCount, indices.size());
+    EXPECT_EQ(chain.lods[0].error, 0.0f);
+    EXPECT_TRUE(std::equal(indices.begin(), indices.end(), chain.indices.begin()));
+
+    uint32_t nextIndex = 0;
+    for (size_t i = 0; i < chain.lods.size(); i++) {
+        const MeshLod& lod = chain.lods[i];
+        EXPECT_EQ(lod.firstIndex, nextIndex) << "level " << i;
+        EXPECT_EQ(lod.indexCount % 3, 0u) << "level " << i;
+        nextIndex = lod.firstIndex + lod.indexCount;
+        if (i > 0) {
+            EXPECT_LE(lod.indexCount, chain.lods[i - 1].indexCount * MIN_LOD_REDUCTION) << "level " << i;
+            EXPECT_GE(lod.error, chain.lods[i - 1].error) << "level " << i;
+        }
+    }
+    EXPECT_GT(chain.lods.back().error, 0.0f);
+    EXPECT_EQ(nextIndex, chain.indices.size());
+    for (uint16_t index : chain.indices) {
+        ASSERT_LT(index, positions.size());
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(LodChain, FlatGridSimplifiesWithoutError) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeTerrain(16, indices, positions);
+    for (glm::vec3& position : positions) {
+        position.z = 0.0f;
+    }
+
+    float error = -1.0f;
+    std::vector<uint16_t> simplified = simplifyMesh(indices, positions, indices.size() / 4, error);
+    EXPECT_LE(simplified.size(), indices.size() / 2);
+    EXPECT_EQ(simplified.size() % 3, 0u);
+    EXPECT_NEAR(error, 0.0f, 1e-4f);
+    for (uint16_t index : simplified) {
+        ASSERT_LT(index, positions.size());
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(LodChain, SingleTriangleKeepsOneLevel) {
+    std::vector<glm::vec3> positions = {glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)};
+    LodChain chain = buildLodChain({0, 1, 2}, positions);
+    ASSERT_EQ(chain.lods.size(), 1u);
+    EXPECT_EQ(chain.indices, (std::vector<uint16_t>{0, 1, 2}));
+}
+// --------------------------------------------------------------------------------
+
+TEST(LodChain, RejectsInvalidInput) {
+    std::vector<glm::vec3> positions(3, glm::vec3(0.0f));
+    float error = 0.0f;
+    EXPECT_THROW(buildLodChain({0, 1, 2}, positions, 0), std::invalid_argument);
+    EXPECT_THROW(buildLodChain({0, 1}, positions), std::invalid_argument);
+    EXPECT_THROW(buildLodChain({0, 1, 3}, positions), std::invalid_argument);
+    EXPECT_THROW(simplifyMesh({0, 1, 3}, positions, 0, error), std::invalid_argument);
+}
+// --------------------------------------------------------------------------------
+
+TEST(SelectLod, CameraInsideTheBoundsUsesTheFullMesh) {
+    std::vector<MeshLod> lods = makeLods();
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    EXPECT_EQ(selectLod(lods.data(), 3, glm::vec4(0.0f, 0.0f, 0.0f, 2.0f), transform, makeCamera(), 1e9f), 0u);
+
+    // Touching the surface counts as inside, and a scale can pull the camera inside
+    EXPECT_EQ(selectLod(lods.data(), 3, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), transform, makeCamera(), 1e9f), 0u);
+    glm::mat4 scaled = glm::scale(transform, glm::vec3(4.0f));
+    EXPECT_EQ(selectLod(lods.data(), 3, glm::vec4(0.0f, 0.0f, 0.0f, 0.5f), scaled, makeCamera(), 1e9f), 0u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(SelectLod, CoarserLevelsWithDistance) {
+    std::vector<MeshLod> lods = makeLods();
+    const glm::vec4 bounds(0.0f, 0.0f, 0.0f, 1.0f);
+    uint32_t previous = 0;
+    for (float depth = 2.0f; depth < 1000.0f; depth *= 1.5f) {
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -depth));
+        uint32_t selected = selectLod(lods.data(), 3, bounds, transform, makeCamera());
+        EXPECT_GE(selected, previous) << "at depth " << depth;
+        EXPECT_LT(selected, 3u);
+        previous = selected;
+    }
+    EXPECT_EQ(previous, 2u);
+
+    // 0.01 units at distance 9 projects to just over a pixel, at distance 11 to just under
+    glm::mat4 nearer = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -10.0f));
+    glm::mat4 farther = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -12.0f));
+    EXPECT_EQ(selectLod(lods.data(), 3, bounds, nearer, makeCamera()), 0u);
+    EXPECT_EQ(selectLod(lods.data(), 3, bounds, farther, makeCamera()), 1u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(SelectLod, ScaleMagnifiesTheError) {
+    std::vector<MeshLod> lods = makeLods();
+    const glm::vec4 bounds(0.0f, 0.0f, 0.0f, 1.0f);
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -12.0f));
+    EXPECT_EQ(selectLod(lods.data(), 3, bounds, transform, makeCamera()), 1u);
+    EXPECT_EQ(selectLod(lods.data(), 3, bounds, glm::scale(transform, glm::vec3(1.0f, 2.0f, 1.0f)),
+                        makeCamera()), 0u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(SelectLod, UnknownCameraOrSingleLevelUsesTheFullMesh) {
+    std::vector<MeshLod> lods = makeLods();
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -500.0f));
+    const glm::vec4 bounds(0.0f, 0.0f, 0.0f, 1.0f);
+    EXPECT_EQ(selectLod(lods.data(), 1, bounds, transform, makeCamera()), 0u);
+    EXPECT_EQ(selectLod(lods.data(), 3, bounds, transform, LodCamera{}), 0u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(SelectLod, CameraRecoveredFromTheViewMatrix) {
+    glm::vec3 eye(3.0f, -2.0f, 7.0f);
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    LodCamera camera = makeLodCamera(view, proj, 800.0f);
+    EXPECT_NEAR(camera.position.x, eye.x, 1e-4f);
+    EXPECT_NEAR(camera.position.y, eye.y, 1e-4f);
+    EXPECT_NEAR(camera.position.z, eye.z, 1e-4f);
+    EXPECT_NEAR(camera.pixelsPerUnit, 400.0f, 1e-2f);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,312 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_mesh_file.cpp
+// - Purpose: Round trips mesh files through writeMeshFile and MappedMeshFile, and
+//            checks that the loader rejects damaged files.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/mesh_file.hpp"
+#include "../include/mesh_optimizer.hpp"
+#include "../include/meshlet.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief A quad of two triangles with a float3 position per vertex, and a fake
+ *        meshlet section, written to a temporary file for each test.
+ */
+class MeshFileTest : public ::testing::Test {
+protected:
+    std::vector<float> positions = {0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 0.0f,  1.0f, 1.0f, 0.0f,  0.0f, 1.0f, 0.0f};
+    std::vector<uint16_t> indices = {0, 1, 2, 2, 3, 0};
+    std::vector<unsigned char> meshlets = std::vector<unsigned char>(40, 0xab);
+    std::string path;
+// --------------------------------------------------------------------------------
+
+    void SetUp() override {
+        const ::testing::TestInfo* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = (std::filesystem::temp_directory_path() / (std::string("mesh_file_") + info->name() + ".vmesh")).string();
+    }
+// --------------------------------------------------------------------------------
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Describes the quad for writeMeshFile.
+     */
+    MeshFileContents makeContents() const {
+        VkVertexInputAttributeDescription position = {};
+        position.location = 0;
+        position.format = VK_FORMAT_R32G32B32_SFLOAT;
+        position.offset = 0;
+
+        MeshFileContents contents;
+        contents.vertexStride = 3 * sizeof(float);
+        contents.attributes = toMeshFileAttributes(&position, 1);
+        contents.vertexData = positions.data();
+        contents.vertexCount = static_cast<uint32_t>(positions.size() / 3);
+        contents.indexData = indices.data();
+        contents.indexCount = static_cast<uint32_t>(indices.size());
+        contents.hasBounds = true;
+        contents.bounds = glm::vec4(0.5f, 0.5f, 0.0f, 0.75f);
+        contents.meshletData = meshlets.data();
+        contents.meshletSize = meshlets.size();
+        contents.meshletCount = 2;
+        return contents;
+    }
+// --------------------------------------------------------------------------------
+
+    std::vector<unsigned char> readBytes() const {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+// --------------------------------------------------------------------------------
+
+    void writeBytes(const std::vector<unsigned char>& bytes) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes a valid file, lets the test edit its header and rewrites it.
+     */
+    template <typename Edit>
+    void writeEdited(Edit edit) {
+        writeMeshFile(path, makeContents());
+        std::vector<unsigned char> bytes = readBytes();
+        MeshFileHeader header;
+        memcpy(&header, bytes.data(), sizeof(header));
+        edit(header, bytes);
+        memcpy(bytes.data(), &header, sizeof(header));
+        writeBytes(bytes);
+    }
+};
+// ================================================================================
+// ================================================================================
+
+TEST_F(MeshFileTest, RoundTripKeepsEverySection) {
+    size_t written = writeMeshFile(path, makeContents());
+    MappedMeshFile file(path);
+
+    EXPECT_EQ(file.getFileSize(), written);
+    const MeshFileHeader& header = file.getHeader();
+    EXPECT_EQ(header.vertexCount, 4u);
+    EXPECT_EQ(header.indexCount, 6u);
+    EXPECT_EQ(header.vertexOffset % MESH_FILE_ALIGNMENT, 0u);
+    EXPECT_EQ(header.indexOffset % MESH_FILE_ALIGNMENT, 0u);
+    EXPECT_EQ(header.meshletOffset % MESH_FILE_ALIGNMENT, 0u);
+    EXPECT_EQ(memcmp(file.getVertexData(), positions.data(), positions.size() * sizeof(float)), 0);
+    EXPECT_EQ(memcmp(file.getIndexData(), indices.data(), indices.size() * sizeof(uint16_t)), 0);
+
+    ASSERT_TRUE(file.hasMeshlets());
+    EXPECT_EQ(header.meshletCount, 2u);
+    EXPECT_EQ(header.meshletSize, meshlets.size());
+    EXPECT_EQ(memcmp(file.getMeshletData(), meshlets.data(), meshlets.size()), 0);
+
+    ASSERT_TRUE(file.hasBounds());
+    EXPECT_EQ(file.getBounds(), glm::vec4(0.5f, 0.5f, 0.0f, 0.75f));
+
+    VkVertexInputBindingDescription binding = {};
+    binding.stride = 3 * sizeof(float);
+    VkVertexInputAttributeDescription position = {};
+    position.format = VK_FORMAT_R32G32B32_SFLOAT;
+    EXPECT_TRUE(file.matchesLayout(binding, &position, 1));
+    position.format = VK_FORMAT_R32G32_SFLOAT;
+    EXPECT_FALSE(file.matchesLayout(binding, &position, 1));
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, OptionalSectionsMayBeOmitted) {
+    MeshFileContents contents = makeContents();
+    contents.hasBounds = false;
+    contents.meshletData = nullptr;
+    contents.meshletCount = 0;
+    writeMeshFile(path, contents);
+
+    MappedMeshFile file(path);
+    EXPECT_FALSE(file.hasBounds());
+    EXPECT_FALSE(file.hasMeshlets());
+    EXPECT_EQ(file.getMeshletData(), nullptr);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, WriterRejectsMissingGeometry) {
+    MeshFileContents contents = makeContents();
+    contents.indexCount = 0;
+    EXPECT_THROW(writeMeshFile(path, contents), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsMissingFile) {
+    EXPECT_THROW(MappedMeshFile(path + ".missing"), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsFileSmallerThanHeader) {
+    writeBytes(std::vector<unsigned char>(sizeof(MeshFileHeader) - 1, 0));
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsBadMagic) {
+    writeEdited([](MeshFileHeader& header, std::vector<unsigned char>&) { header.magic[0] = 'X'; });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsOtherVersion) {
+    writeEdited([](MeshFileHeader& header, std::vector<unsigned char>&) { header.version = MESH_FILE_VERSION + 1; });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsTruncatedSections) {
+    // Cutting into the meshlet section, and then into the index blob
+    writeEdited([](MeshFileHeader&, std::vector<unsigned char>& bytes) { bytes.resize(bytes.size() - 1); });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+
+    writeEdited([](MeshFileHeader& header, std::vector<unsigned char>& bytes) {
+        bytes.resize(static_cast<size_t>(header.indexOffset + header.indexSize - 2));
+    });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsSectionOffsetsPastTheEnd) {
+    // A huge offset must not wrap around the bounds check
+    writeEdited([](MeshFileHeader& header, std::vector<unsigned char>&) {
+        header.vertexOffset = ~uint64_t(0) & ~(MESH_FILE_ALIGNMENT - 1);
+    });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsMisalignedSections) {
+    writeEdited([](MeshFileHeader& header, std::vector<unsigned char>&) { header.indexOffset += 2; });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsInconsistentSizes) {
+    writeEdited([](MeshFileHeader& header, std::vector<unsigned char>&) { header.vertexCount = 3; });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsOutOfRangeIndices) {
+    writeEdited([](MeshFileHeader& header, std::vector<unsigned char>& bytes) {
+        uint16_t index = 4;  // One past the last vertex
+        memcpy(bytes.data() + header.indexOffset + 2 * sizeof(uint16_t), &index, sizeof(index));
+    });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsAttributesOutsideTheStride) {
+    writeEdited([](MeshFileHeader& header, std::vector<unsigned char>& bytes) {
+        MeshFileAttribute attribute;
+        memcpy(&attribute, bytes.data() + header.attributeOffset, sizeof(attribute));
+        attribute.offset = header.vertexStride;
+        memcpy(bytes.data() + header.attributeOffset, &attribute, sizeof(attribute));
+    });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, RejectsEmptyMeshletSection) {
+    writeEdited([](MeshFileHeader& header, std::vector<unsigned char>&) { header.meshletCount = 0; });
+    EXPECT_THROW(MappedMeshFile file(path), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief A vertex with the pos member the optimizer reads, laid out like Vertex.
+ */
+struct GridVertex {
+    glm::vec2 pos;
+    glm::vec3 color;
+};
+// --------------------------------------------------------------------------------
+
+TEST_F(MeshFileTest, ConverterPipelineRoundTrips) {
+    // A 24 x 24 quad grid, large enough to need several meshlets, run through the same
+    // optimize, cluster and write steps as the mesh converter
+    constexpr uint16_t side = 25;
+    std::vector<GridVertex> vertices;
+    for (uint16_t y = 0; y < side; y++) {
+        for (uint16_t x = 0; x < side; x++) {
+            vertices.push_back({glm::vec2(x, y), glm::vec3(x / float(side), y / float(side), 0.0f)});
+        }
+    }
+    std::vector<uint16_t> gridIndices;
+    for (uint16_t y = 0; y + 1 < side; y++) {
+        for (uint16_t x = 0; x + 1 < side; x++) {
+            uint16_t corner = static_cast<uint16_t>(y * side + x);
+            uint16_t quad[6] = {corner, static_cast<uint16_t>(corner + 1), static_cast<uint16_t>(corner + side + 1),
+                                static_cast<uint16_t>(corner + side + 1), static_cast<uint16_t>(corner + side), corner};
+            gridIndices.insert(gridIndices.end(), quad, quad + 6);
+        }
+    }
+    optimizeMesh(vertices, gridIndices, true);
+    std::vector<Meshlet> clusters = buildMeshlets(gridIndices, positionsOf(vertices));
+    ASSERT_GT(clusters.size(), 1u);
+
+    VkVertexInputAttributeDescription attributes[2] = {};
+    attributes[0].location = 0;
+    attributes[0].format = VK_FORMAT_R32G32_SFLOAT;
+    attributes[0].offset = offsetof(GridVertex, pos);
+    attributes[1].location = 1;
+    attributes[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+    attributes[1].offset = offsetof(GridVertex, color);
+
+    MeshFileContents contents;
+    contents.vertexStride = sizeof(GridVertex);
+    contents.attributes = toMeshFileAttributes(attributes, 2);
+    contents.vertexData = vertices.data();
+    contents.vertexCount = static_cast<uint32_t>(vertices.size());
+    contents.indexData = gridIndices.data();
+    contents.indexCount = static_cast<uint32_t>(gridIndices.size());
+    contents.meshletData = clusters.data();
+    contents.meshletSize = clusters.size() * sizeof(Meshlet);
+    contents.meshletCount = static_cast<uint32_t>(clusters.size());
+    writeMeshFile(path, contents);
+
+    MappedMeshFile file(path);
+    VkVertexInputBindingDescription binding = {};
+    binding.stride = sizeof(GridVertex);
+    EXPECT_TRUE(file.matchesLayout(binding, attributes, 2));
+    ASSERT_EQ(file.getHeader().vertexCount, vertices.size());
+    ASSERT_EQ(file.getHeader().indexCount, gridIndices.size());
+    EXPECT_EQ(memcmp(file.getVertexData(), vertices.data(), vertices.size() * sizeof(GridVertex)), 0);
+    EXPECT_EQ(memcmp(file.getIndexData(), gridIndices.data(), gridIndices.size() * sizeof(uint16_t)), 0);
+
+    ASSERT_TRUE(file.hasMeshlets());
+    ASSERT_EQ(file.getHeader().meshletCount, clusters.size());
+    const Meshlet* loaded = static_cast<const Meshlet*>(file.getMeshletData());
+    EXPECT_TRUE(validateMeshlets(loaded, file.getHeader().meshletCount, file.getHeader().indexCount));
+    EXPECT_EQ(memcmp(loaded, clusters.data(), clusters.size() * sizeof(Meshlet)), 0);
+}
+// ================================================================================
+// ================================================================================
+// eof
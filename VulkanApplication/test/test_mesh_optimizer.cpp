@@ -0,0 +1,229 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_mesh_optimizer.cpp
+// - Purpose: Checks that the vertex cache, overdraw and vertex fetch passes keep
+//            every triangle while improving the order they are drawn in.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "../include/mesh_optimizer.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Builds a grid of side x side vertices on the z = 0 plane, two triangles per cell.
+ */
+static void makeGrid(uint16_t side, std::vector<uint16_t>& indices, std::vector<glm::vec3>& positions) {
+    for (uint16_t y = 0; y < side; y++) {
+        for (uint16_t x = 0; x < side; x++) {
+            positions.push_back(glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0f));
+        }
+    }
+    for (uint16_t y = 0; y + 1 < side; y++) {
+        for (uint16_t x = 0; x + 1 < side; x++) {
+            uint16_t corner = static_cast<uint16_t>(y * side + x);
+            uint16_t right = static_cast<uint16_t>(corner + 1);
+            uint16_t up = static_cast<uint16_t>(corner + side);
+            uint16_t diagonal = static_cast<uint16_t>(up + 1);
+            uint16_t quad[6] = {corner, right, diagonal, diagonal, up, corner};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Builds a closed sphere of stacks x slices quads, whose faces point every way.
+ */
+static void makeSphere(uint16_t stacks, uint16_t slices, std::vector<uint16_t>& indices,
+                       std::vector<glm::vec3>& positions) {
+    const float pi = 3.14159265f;
+    for (uint16_t i = 0; i <= stacks; i++) {
+        float polar = pi * static_cast<float>(i) / static_cast<float>(stacks);
+        for (uint16_t j = 0; j < slices; j++) {
+            float azimuth = 2.0f * pi * static_cast<float>(j) / static_cast<float>(slices);
+            positions.push_back(glm::vec3(std::sin(polar) * std::cos(azimuth), std::sin(polar) * std::sin(azimuth),
+                                          std::cos(polar)));
+        }
+    }
+    for (uint16_t i = 0; i < stacks; i++) {
+        for (uint16_t j = 0; j < slices; j++) {
+            uint16_t corner = static_cast<uint16_t>(i * slices + j);
+            uint16_t right = static_cast<uint16_t>(i * slices + (j + 1) % slices);
+            uint16_t down = static_cast<uint16_t>(corner + slices);
+            uint16_t diagonal = static_cast<uint16_t>(right + slices);
+            uint16_t quad[6] = {corner, down, diagonal, diagonal, right, corner};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Shuffles the triangles of a list, the worst case for the vertex cache.
+ */
+static void shuffleTriangles(std::vector<uint16_t>& indices, uint32_t seed) {
+    std::vector<std::array<uint16_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+    indices.clear();
+    for (const std::array<uint16_t, 3>& triangle : triangles) {
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Sorts the triangles of a list, each rotated to start at its smallest index.
+ *
+ * Rotating keeps the winding, so two lists compare equal only if they draw the same
+ * triangles facing the same way.
+ */
+static std::vector<std::array<uint16_t, 3>> triangleSet(const std::vector<uint16_t>& indices) {
+    std::vector<std::array<uint16_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        std::array<uint16_t, 3> triangle = {indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+// ================================================================================
+// ================================================================================
+
+TEST(MeshOptimizer, VertexCacheKeepsTrianglesAndLowersAcmr) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeGrid(40, indices, positions);
+    shuffleTriangles(indices, 1);
+    const std::vector<uint16_t> original = indices;
+
+    VertexCacheStatistics before = analyzeVertexCache(indices, positions.size());
+    optimizeVertexCache(indices, positions.size());
+    VertexCacheStatistics after = analyzeVertexCache(indices, positions.size());
+
+    EXPECT_EQ(triangleSet(indices), triangleSet(original));
+    EXPECT_LE(after.acmr, before.acmr);
+    EXPECT_LT(after.acmr, 1.0f) << "a grid should reuse most vertices";
+    EXPECT_GE(after.atvr, 1.0f);
+}
+// --------------------------------------------------------------------------------
+
+TEST(MeshOptimizer, VertexCacheNeverMakesAnOrderedMeshWorse) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeSphere(24, 32, indices, positions);
+    const std::vector<uint16_t> original = indices;
+
+    float before = analyzeVertexCache(indices, positions.size()).acmr;
+    optimizeVertexCache(indices, positions.size());
+    EXPECT_EQ(triangleSet(indices), triangleSet(original));
+    EXPECT_LE(analyzeVertexCache(indices, positions.size()).acmr, before);
+}
+// --------------------------------------------------------------------------------
+
+TEST(MeshOptimizer, OverdrawKeepsTrianglesWithinTheAcmrThreshold) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeSphere(24, 32, indices, positions);
+    shuffleTriangles(indices, 2);
+    optimizeVertexCache(indices, positions.size());
+    const std::vector<uint16_t> original = indices;
+    float before = analyzeVertexCache(indices, positions.size()).acmr;
+
+    // Clusters of a sphere face every way, so there is an order to sort them into
+    EXPECT_TRUE(optimizeOverdraw(indices, positions));
+    EXPECT_NE(indices, original);
+    EXPECT_EQ(triangleSet(indices), triangleSet(original));
+    EXPECT_LE(analyzeVertexCache(indices, positions.size()).acmr, before * DEFAULT_OVERDRAW_THRESHOLD);
+}
+// --------------------------------------------------------------------------------
+
+TEST(MeshOptimizer, OverdrawLeavesFlatMeshesUntouched) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeGrid(24, indices, positions);
+    shuffleTriangles(indices, 3);
+    optimizeVertexCache(indices, positions.size());
+    const std::vector<uint16_t> original = indices;
+
+    EXPECT_FALSE(optimizeOverdraw(indices, positions, 2.0f));
+    EXPECT_EQ(indices, original);
+}
+// --------------------------------------------------------------------------------
+
+TEST(MeshOptimizer, VertexFetchRemapIsAPermutationInFirstUseOrder) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeGrid(12, indices, positions);
+    shuffleTriangles(indices, 4);
+    const std::vector<uint16_t> original = indices;
+
+    std::vector<uint32_t> remap = buildVertexFetchRemap(indices, positions.size());
+    ASSERT_EQ(remap.size(), positions.size());
+    std::vector<uint32_t> sorted = remap;
+    std::sort(sorted.begin(), sorted.end());
+    for (uint32_t i = 0; i < sorted.size(); i++) {
+        ASSERT_EQ(sorted[i], i) << "every old vertex must appear exactly once";
+    }
+
+    // Each remapped index reads the same vertex as before, and new vertices appear in order
+    ASSERT_EQ(indices.size(), original.size());
+    uint32_t nextNew = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+        ASSERT_LT(indices[i], remap.size());
+        EXPECT_EQ(remap[indices[i]], original[i]) << "index " << i;
+        ASSERT_LE(indices[i], nextNew);
+        if (indices[i] == nextNew) {
+            nextNew++;
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(MeshOptimizer, VertexFetchDropsUnreferencedVertices) {
+    std::vector<glm::vec3> vertices = {glm::vec3(0.0f), glm::vec3(1.0f), glm::vec3(2.0f), glm::vec3(3.0f),
+                                       glm::vec3(4.0f)};
+    std::vector<uint16_t> indices = {4, 2, 0, 0, 2, 4};
+    optimizeVertexFetch(vertices, indices);
+
+    ASSERT_EQ(vertices.size(), 3u);
+    EXPECT_EQ(vertices[0], glm::vec3(4.0f));
+    EXPECT_EQ(vertices[1], glm::vec3(2.0f));
+    EXPECT_EQ(vertices[2], glm::vec3(0.0f));
+    EXPECT_EQ(indices, (std::vector<uint16_t>{0, 1, 2, 2, 1, 0}));
+}
+// --------------------------------------------------------------------------------
+
+TEST(MeshOptimizer, RejectsInvalidInput) {
+    std::vector<glm::vec3> positions(3, glm::vec3(0.0f));
+    std::vector<uint16_t> partial = {0, 1};
+    std::vector<uint16_t> outOfRange = {0, 1, 3};
+    EXPECT_THROW(analyzeVertexCache(partial, positions.size()), std::invalid_argument);
+    EXPECT_THROW(optimizeVertexCache(partial, positions.size()), std::invalid_argument);
+    EXPECT_THROW(optimizeVertexCache(outOfRange, positions.size()), std::invalid_argument);
+    EXPECT_THROW(optimizeOverdraw(partial, positions), std::invalid_argument);
+    EXPECT_THROW(optimizeOverdraw(outOfRange, positions), std::invalid_argument);
+    EXPECT_THROW(buildVertexFetchRemap(partial, positions.size()), std::invalid_argument);
+    EXPECT_THROW(buildVertexFetchRemap(outOfRange, positions.size()), std::invalid_argument);
+}
+// ================================================================================
+// ================================================================================
+// eof
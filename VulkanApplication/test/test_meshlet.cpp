@@ -0,0 +1,179 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_meshlet.cpp
+// - Purpose: Checks that buildMeshlets keeps every meshlet within its vertex and
+//            triangle limits, covers the index list and bounds its triangles.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "../include/meshlet.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Builds a grid of side x side vertices on the z = 0 plane, two triangles per cell.
+ */
+static void makeGrid(uint16_t side, std::vector<uint16_t>& indices, std::vector<glm::vec3>& positions) {
+    for (uint16_t y = 0; y < side; y++) {
+        for (uint16_t x = 0; x < side; x++) {
+            positions.push_back(glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0f));
+        }
+    }
+    for (uint16_t y = 0; y + 1 < side; y++) {
+        for (uint16_t x = 0; x + 1 < side; x++) {
+            uint16_t corner = static_cast<uint16_t>(y * side + x);
+            uint16_t right = static_cast<uint16_t>(corner + 1);
+            uint16_t up = static_cast<uint16_t>(corner + side);
+            uint16_t diagonal = static_cast<uint16_t>(up + 1);
+            uint16_t quad[6] = {corner, right, diagonal, diagonal, up, corner};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Builds triangles of random vertices, the worst case for vertex reuse, with some
+ *        degenerate triangles that repeat a vertex.
+ */
+static void makeSoup(size_t triangleCount, uint32_t seed, std::vector<uint16_t>& indices,
+                     std::vector<glm::vec3>& positions) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+    positions.resize(300);
+    for (glm::vec3& position : positions) {
+        position = glm::vec3(coordinate(generator), coordinate(generator), coordinate(generator));
+    }
+    std::uniform_int_distribution<uint32_t> vertex(0, static_cast<uint32_t>(positions.size() - 1));
+    for (size_t i = 0; i < 3 * triangleCount; i++) {
+        indices.push_back(static_cast<uint16_t>(vertex(generator)));
+    }
+    for (size_t i = 0; i < indices.size(); i += 15) {
+        indices[i + 1] = indices[i];
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Checks the limits, coverage, vertex counts and bounding spheres of meshlets.
+ */
+static void expectValidMeshlets(const std::vector<Meshlet>& meshlets, const std::vector<uint16_t>& indices,
+                                const std::vector<glm::vec3>& positions, uint32_t maxVertices,
+                                uint32_t maxTriangles) {
+    EXPECT_TRUE(validateMeshlets(meshlets.data(), meshlets.size(), static_cast<uint32_t>(indices.size())));
+
+    uint32_t nextIndex = 0;
+    for (size_t m = 0; m < meshlets.size(); m++) {
+        const Meshlet& meshlet = meshlets[m];
+        SCOPED_TRACE("meshlet " + std::to_string(m) + " of " + std::to_string(meshlets.size()));
+        EXPECT_EQ(meshlet.firstIndex, nextIndex);
+        EXPECT_LE(meshlet.indexCount / 3, maxTriangles);
+        nextIndex = meshlet.firstIndex + meshlet.indexCount;
+
+        std::unordered_set<uint16_t> unique;
+        for (uint32_t i = meshlet.firstIndex; i < nextIndex && i < indices.size(); i++) {
+            unique.insert(indices[i]);
+            float distance = glm::length(positions[indices[i]] - glm::vec3(meshlet.sphere));
+            EXPECT_LE(distance, meshlet.sphere.w * 1.0001f + 1e-5f);
+        }
+        EXPECT_EQ(meshlet.vertexCount, unique.size());
+        EXPECT_LE(meshlet.vertexCount, maxVertices);
+    }
+    EXPECT_EQ(nextIndex, indices.size()) << "meshlets must cover the whole index list";
+}
+// ================================================================================
+// ================================================================================
+
+TEST(Meshlets, GridStaysWithinTheDefaultLimits) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeGrid(40, indices, positions);
+    std::vector<Meshlet> meshlets = buildMeshlets(indices, positions);
+    ASSERT_GT(meshlets.size(), 1u);
+    expectValidMeshlets(meshlets, indices, positions, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+}
+// --------------------------------------------------------------------------------
+
+TEST(Meshlets, TriangleSoupStaysWithinEveryLimit) {
+    // Random triangles share few vertices, so the vertex limit closes most meshlets
+    struct Limits { uint32_t vertices; uint32_t triangles; };
+    for (Limits limits : {Limits{MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES}, Limits{3, 1}, Limits{4, 124},
+                          Limits{64, 2}, Limits{17, 9}}) {
+        std::vector<uint16_t> indices;
+        std::vector<glm::vec3> positions;
+        makeSoup(500, limits.vertices, indices, positions);
+        SCOPED_TRACE(std::to_string(limits.vertices) + " vertices, " + std::to_string(limits.triangles) +
+                     " triangles");
+        std::vector<Meshlet> meshlets = buildMeshlets(indices, positions, limits.vertices, limits.triangles);
+        expectValidMeshlets(meshlets, indices, positions, limits.vertices, limits.triangles);
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(Meshlets, OneTrianglePerMeshletAtTheSmallestLimits) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeGrid(4, indices, positions);
+    std::vector<Meshlet> meshlets = buildMeshlets(indices, positions, 3, 1);
+    EXPECT_EQ(meshlets.size(), indices.size() / 3);
+}
+// --------------------------------------------------------------------------------
+
+TEST(Meshlets, FlatMeshletsGetANarrowCone) {
+    std::vector<uint16_t> indices;
+    std::vector<glm::vec3> positions;
+    makeGrid(12, indices, positions);
+    for (const Meshlet& meshlet : buildMeshlets(indices, positions)) {
+        EXPECT_NEAR(meshlet.cone.z, 1.0f, 1e-5f);
+        EXPECT_NEAR(meshlet.cone.w, 0.0f, 1e-3f);
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(Meshlets, EmptyIndexListHasNoMeshlets) {
+    EXPECT_TRUE(buildMeshlets({}, {glm::vec3(0.0f)}).empty());
+}
+// --------------------------------------------------------------------------------
+
+TEST(Meshlets, RejectsInvalidInput) {
+    std::vector<glm::vec3> positions(3, glm::vec3(0.0f));
+    EXPECT_THROW(buildMeshlets({0, 1, 2}, positions, 2, 124), std::invalid_argument);
+    EXPECT_THROW(buildMeshlets({0, 1, 2}, positions, 64, 0), std::invalid_argument);
+    EXPECT_THROW(buildMeshlets({0, 1}, positions), std::invalid_argument);
+    EXPECT_THROW(buildMeshlets({0, 1, 3}, positions), std::invalid_argument);
+}
+// --------------------------------------------------------------------------------
+
+TEST(Meshlets, ValidateRejectsRangesOutsideTheMesh) {
+    Meshlet meshlet{};
+    meshlet.firstIndex = 3;
+    meshlet.indexCount = 6;
+    EXPECT_TRUE(validateMeshlets(&meshlet, 1, 9));
+    EXPECT_FALSE(validateMeshlets(&meshlet, 1, 8));   // Reads past the mesh
+    meshlet.indexCount = 0;
+    EXPECT_FALSE(validateMeshlets(&meshlet, 1, 9));   // Empty
+    meshlet.indexCount = 4;
+    EXPECT_FALSE(validateMeshlets(&meshlet, 1, 9));   // Partial triangle
+    meshlet.firstIndex = 1;
+    meshlet.indexCount = 3;
+    EXPECT_FALSE(validateMeshlets(&meshlet, 1, 9));   // Starts inside a triangle
+    meshlet.firstIndex = 0xfffffffd;
+    meshlet.indexCount = 6;
+    EXPECT_FALSE(validateMeshlets(&meshlet, 1, 9));   // Must not wrap around
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,235 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_vertex_formats.cpp
+// - Purpose: Checks the half float, normalized integer and octahedral encoders
+//            behind the quantized vertex layouts, including their edge cases.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "../include/vertex_formats.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Returns the angle in degrees between two vectors.
+ *
+ * atan2 stays accurate for nearly parallel vectors, where acos of the dot product
+ * loses every digit to float rounding.
+ */
+static float angleDegrees(const glm::vec3& a, const glm::vec3& b) {
+    return std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b)) * 180.0f / 3.14159265f;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Encodes a normal into two snorm16 components and decodes it back.
+ */
+static glm::vec3 roundTripOctahedral16(const glm::vec3& normal) {
+    glm::vec2 encoded = encodeOctahedral(normal);
+    return decodeOctahedral(glm::vec2(static_cast<float>(packSnorm16(encoded.x)) / 32767.0f,
+                                      static_cast<float>(packSnorm16(encoded.y)) / 32767.0f));
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Encodes a normal into two snorm8 components and decodes it back.
+ */
+static glm::vec3 roundTripOctahedral8(const glm::vec3& normal) {
+    glm::vec2 encoded = encodeOctahedral(normal);
+    return decodeOctahedral(glm::vec2(static_cast<float>(packSnorm8(encoded.x)) / 127.0f,
+                                      static_cast<float>(packSnorm8(encoded.y)) / 127.0f));
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Spreads unit directions over the whole sphere, both hemispheres included.
+ */
+static std::vector<glm::vec3> sphereDirections(int stacks, int slices) {
+    const float pi = 3.14159265f;
+    std::vector<glm::vec3> directions;
+    for (int i = 0; i <= stacks; i++) {
+        float polar = pi * static_cast<float>(i) / static_cast<float>(stacks);
+        for (int j = 0; j < slices; j++) {
+            float azimuth = 2.0f * pi * static_cast<float>(j) / static_cast<float>(slices);
+            directions.push_back(glm::vec3(std::sin(polar) * std::cos(azimuth), std::sin(polar) * std::sin(azimuth),
+                                           std::cos(polar)));
+        }
+    }
+    return directions;
+}
+// ================================================================================
+// ================================================================================
+
+TEST(VertexFormats, HalfRoundTripsExactValues) {
+    const float values[] = {0.0f, 1.0f, -1.0f, 0.5f, -2.0f, 0.333251953125f, 1024.0f, 65504.0f, -65504.0f};
+    for (float value : values) {
+        EXPECT_EQ(unpackHalf(packHalf(value)), value) << value;
+    }
+    EXPECT_EQ(packHalf(1.0f), 0x3c00);
+    EXPECT_EQ(packHalf(-2.0f), 0xc000);
+    EXPECT_EQ(packHalf(65504.0f), 0x7bff);
+    EXPECT_EQ(packHalf(-0.0f), 0x8000);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, HalfRoundsToNearestEven) {
+    // 1 + 2^-11 sits halfway between 1 and the next half, so it rounds to the even 1
+    EXPECT_EQ(packHalf(1.0f + std::ldexp(1.0f, -11)), 0x3c00);
+    // 1 + 3 * 2^-11 sits halfway between the odd 0x3c01 and the even 0x3c02, and rounds up
+    EXPECT_EQ(packHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)), 0x3c02);
+    // Anything past halfway rounds up
+    EXPECT_EQ(packHalf(1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20)), 0x3c01);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, HalfKeepsInfinityAndNan) {
+    const float infinity = std::numeric_limits<float>::infinity();
+    EXPECT_EQ(packHalf(infinity), 0x7c00);
+    EXPECT_EQ(packHalf(-infinity), 0xfc00);
+    EXPECT_EQ(unpackHalf(0x7c00), infinity);
+    EXPECT_EQ(unpackHalf(0xfc00), -infinity);
+
+    uint16_t nan = packHalf(std::numeric_limits<float>::quiet_NaN());
+    EXPECT_EQ(nan & 0x7c00, 0x7c00);
+    EXPECT_NE(nan & 0x03ff, 0) << "a NaN must not collapse into infinity";
+    EXPECT_TRUE(std::isnan(unpackHalf(nan)));
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, HalfOverflowsToInfinity) {
+    // 65520 is halfway between the largest half and 2^16, and rounds up to infinity
+    EXPECT_EQ(packHalf(65519.0f), 0x7bff);
+    EXPECT_EQ(packHalf(65520.0f), 0x7c00);
+    EXPECT_EQ(packHalf(1.0e6f), 0x7c00);
+    EXPECT_EQ(packHalf(-1.0e6f), 0xfc00);
+    EXPECT_EQ(packHalf(std::numeric_limits<float>::max()), 0x7c00);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, HalfHandlesSubnormals) {
+    const float smallest = std::ldexp(1.0f, -24);
+    const float largestSubnormal = std::ldexp(1023.0f, -24);
+    EXPECT_EQ(packHalf(smallest), 0x0001);
+    EXPECT_EQ(packHalf(-smallest), 0x8001);
+    EXPECT_EQ(packHalf(largestSubnormal), 0x03ff);
+    EXPECT_EQ(unpackHalf(0x0001), smallest);
+    EXPECT_EQ(unpackHalf(0x03ff), largestSubnormal);
+    EXPECT_EQ(unpackHalf(0x8200), -std::ldexp(512.0f, -24));
+
+    // Every subnormal half survives a round trip through float
+    for (uint16_t bits = 1; bits < 0x400; bits++) {
+        ASSERT_EQ(packHalf(unpackHalf(bits)), bits);
+    }
+
+    // Half of the smallest subnormal is a tie that rounds to even zero, more rounds up
+    EXPECT_EQ(packHalf(std::ldexp(1.0f, -25)), 0x0000);
+    EXPECT_EQ(packHalf(std::ldexp(1.5f, -25)), 0x0001);
+    EXPECT_EQ(packHalf(std::ldexp(1.0f, -30)), 0x0000);
+    EXPECT_EQ(packHalf(-std::ldexp(1.0f, -30)), 0x8000);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, SnormAndUnormClampOutOfRangeValues) {
+    EXPECT_EQ(packSnorm16(1.0f), 32767);
+    EXPECT_EQ(packSnorm16(-1.0f), -32767);
+    EXPECT_EQ(packSnorm16(0.0f), 0);
+    EXPECT_EQ(packSnorm16(0.5f), 16384);
+    EXPECT_EQ(packSnorm16(2.0f), 32767);
+    EXPECT_EQ(packSnorm16(-2.0f), -32767);
+    EXPECT_EQ(packSnorm16(std::numeric_limits<float>::infinity()), 32767);
+
+    EXPECT_EQ(packSnorm8(1.0f), 127);
+    EXPECT_EQ(packSnorm8(-1.0f), -127);
+    EXPECT_EQ(packSnorm8(1.5f), 127);
+    EXPECT_EQ(packSnorm8(-1.5f), -127);
+
+    EXPECT_EQ(packUnorm8(0.0f), 0);
+    EXPECT_EQ(packUnorm8(1.0f), 255);
+    EXPECT_EQ(packUnorm8(0.5f), 128);
+    EXPECT_EQ(packUnorm8(-0.25f), 0);
+    EXPECT_EQ(packUnorm8(3.0f), 255);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, SnormRoundTripsWithinHalfAStep) {
+    for (int i = -100; i <= 100; i++) {
+        float value = static_cast<float>(i) / 100.0f;
+        EXPECT_NEAR(static_cast<float>(packSnorm16(value)) / 32767.0f, value, 0.5f / 32767.0f) << value;
+        EXPECT_NEAR(static_cast<float>(packSnorm8(value)) / 127.0f, value, 0.5f / 127.0f) << value;
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, OctahedralMapsThePolesExactly) {
+    const glm::vec3 axes[] = {glm::vec3(0.0f, 0.0f, 1.0f),  glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+                              glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),  glm::vec3(0.0f, -1.0f, 0.0f)};
+    for (const glm::vec3& axis : axes) {
+        EXPECT_EQ(decodeOctahedral(encodeOctahedral(axis)), axis);
+        EXPECT_EQ(roundTripOctahedral16(axis), axis);
+        EXPECT_EQ(roundTripOctahedral8(axis), axis);
+    }
+
+    // The south pole lands on a corner of the square, the north pole in its center
+    EXPECT_EQ(encodeOctahedral(glm::vec3(0.0f, 0.0f, 1.0f)), glm::vec2(0.0f, 0.0f));
+    EXPECT_EQ(encodeOctahedral(glm::vec3(0.0f, 0.0f, -1.0f)), glm::vec2(1.0f, 1.0f));
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, OctahedralFoldsTheLowerHemisphere) {
+    // Directions below the equator fold outside the inner diamond, those above stay inside
+    for (const glm::vec3& direction : sphereDirections(16, 24)) {
+        glm::vec2 encoded = encodeOctahedral(direction);
+        EXPECT_LE(std::fabs(encoded.x), 1.0f);
+        EXPECT_LE(std::fabs(encoded.y), 1.0f);
+        float l1 = std::fabs(encoded.x) + std::fabs(encoded.y);
+        if (direction.z < -1.0e-4f) {
+            EXPECT_GE(l1, 1.0f - 1.0e-5f) << direction.x << ", " << direction.y << ", " << direction.z;
+        } else if (direction.z > 1.0e-4f) {
+            EXPECT_LE(l1, 1.0f + 1.0e-5f) << direction.x << ", " << direction.y << ", " << direction.z;
+        }
+        EXPECT_LT(angleDegrees(decodeOctahedral(encoded), direction), 0.001f);
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, OctahedralQuantizationStaysWithinTheAngularBound) {
+    float worst16 = 0.0f;
+    float worst8 = 0.0f;
+    for (const glm::vec3& direction : sphereDirections(90, 180)) {
+        worst16 = std::max(worst16, angleDegrees(roundTripOctahedral16(direction), direction));
+        worst8 = std::max(worst8, angleDegrees(roundTripOctahedral8(direction), direction));
+    }
+    EXPECT_LT(worst16, 0.01f);
+    EXPECT_LT(worst8, 1.0f);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, OctahedralZeroVectorDecodesToTheNorthPole) {
+    EXPECT_EQ(encodeOctahedral(glm::vec3(0.0f)), glm::vec2(0.0f, 0.0f));
+    EXPECT_EQ(decodeOctahedral(encodeOctahedral(glm::vec3(0.0f))), glm::vec3(0.0f, 0.0f, 1.0f));
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormats, SnormPositionsMustLieInTheUnitSquare) {
+    std::vector<Vertex> inside = {{{-1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}}, {{0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}}};
+    EXPECT_NO_THROW(validateSnormPositions(inside));
+
+    std::vector<Vertex> outside = inside;
+    outside.push_back({{1.5f, 0.0f}, {0.0f, 0.0f, 1.0f}});
+    EXPECT_THROW(validateSnormPositions(outside), std::invalid_argument);
+}
+// ================================================================================
+// ================================================================================
+// eof
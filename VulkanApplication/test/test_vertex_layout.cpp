@@ -0,0 +1,175 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_vertex_layout.cpp
+// - Purpose: Checks that the generated binding and attribute descriptions agree
+//            with the memory layout of the vertex structs they describe.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include "../include/vertex_formats.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief A vertex whose matrix sits between two other members, so locations must chain past it.
+ */
+struct ChainedVertex {
+    glm::vec3 normal;
+    glm::mat4 transform;
+    glm::mat3 basis;
+    glm::vec2 uv;
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Returns the number of bytes one attribute location of a format reads.
+ */
+static uint32_t formatSize(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8_SNORM:
+            return 2;
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R8G8B8A8_UNORM:
+            return 4;
+        case VK_FORMAT_R32G32_SFLOAT:
+            return 8;
+        case VK_FORMAT_R32G32B32_SFLOAT:
+            return 12;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return 16;
+        default:
+            ADD_FAILURE() << "unexpected format " << format;
+            return 0;
+    }
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Checks that every attribute of a layout reads its binding and stays inside the stride.
+ */
+template <typename VertexT>
+static void expectAttributesInsideStride(uint32_t binding) {
+    constexpr VkVertexInputBindingDescription description = VertexT::getBindingDescription();
+    EXPECT_EQ(description.binding, binding);
+    EXPECT_EQ(description.stride, sizeof(VertexT));
+    for (const VkVertexInputAttributeDescription& attribute : VertexT::getAttributeDescriptions()) {
+        EXPECT_EQ(attribute.binding, binding) << "location " << attribute.location;
+        EXPECT_LE(attribute.offset + formatSize(attribute.format), description.stride)
+            << "location " << attribute.location;
+    }
+}
+// ================================================================================
+// ================================================================================
+
+TEST(VertexLayout, VertexMatchesItsMembers) {
+    constexpr auto attributes = Vertex::getAttributeDescriptions();
+    static_assert(attributes.size() == 2, "Vertex has one location per member");
+    static_assert(attributes[0].location == 0 && attributes[1].location == 1, "Vertex starts at location 0");
+    static_assert(attributes[0].offset == offsetof(Vertex, pos), "pos offset");
+    static_assert(attributes[1].offset == offsetof(Vertex, color), "color offset");
+
+    EXPECT_EQ(attributes[0].format, VK_FORMAT_R32G32_SFLOAT);
+    EXPECT_EQ(attributes[1].format, VK_FORMAT_R32G32B32_SFLOAT);
+    EXPECT_EQ(Vertex::getBindingDescription().inputRate, VK_VERTEX_INPUT_RATE_VERTEX);
+    expectAttributesInsideStride<Vertex>(0);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexLayout, InstanceTransformSpansFourLocations) {
+    constexpr auto attributes = InstanceData::getAttributeDescriptions();
+    static_assert(attributes.size() == 5, "The transform takes four locations and the color one");
+
+    for (uint32_t column = 0; column < 4; column++) {
+        EXPECT_EQ(attributes[column].location, 2 + column) << "the explicit location 2 starts the matrix";
+        EXPECT_EQ(attributes[column].format, VK_FORMAT_R32G32B32A32_SFLOAT);
+        EXPECT_EQ(attributes[column].offset, offsetof(InstanceData, transform) + column * sizeof(glm::vec4));
+    }
+    EXPECT_EQ(attributes[4].location, 6u) << "the color follows the last column";
+    EXPECT_EQ(attributes[4].format, VK_FORMAT_R32G32B32A32_SFLOAT);
+    EXPECT_EQ(attributes[4].offset, offsetof(InstanceData, color));
+
+    EXPECT_EQ(InstanceData::getBindingDescription().inputRate, VK_VERTEX_INPUT_RATE_INSTANCE);
+    expectAttributesInsideStride<InstanceData>(1);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexLayout, QuantizedNormalUsesItsExplicitLocation) {
+    using NormalVertex = QuantizedVertex<PositionFormat::Snorm16, ColorFormat::Unorm8, NormalFormat::Octahedral8>;
+    using Storage = QuantizedVertexStorage<PositionFormat::Snorm16, ColorFormat::Unorm8, NormalFormat::Octahedral8>;
+    constexpr auto attributes = NormalVertex::getAttributeDescriptions();
+    static_assert(attributes.size() == 3, "Position, color and normal take one location each");
+    static_assert(attributes[2].location == NORMAL_ATTRIBUTE_LOCATION, "The normal skips to its own location");
+
+    EXPECT_EQ(attributes[0].location, 0u);
+    EXPECT_EQ(attributes[0].format, VK_FORMAT_R16G16_SNORM);
+    EXPECT_EQ(attributes[0].offset, offsetof(Storage, pos));
+    EXPECT_EQ(attributes[1].location, 1u);
+    EXPECT_EQ(attributes[1].format, VK_FORMAT_R8G8B8A8_UNORM);
+    EXPECT_EQ(attributes[1].offset, offsetof(Storage, color));
+    EXPECT_EQ(attributes[2].format, VK_FORMAT_R8G8_SNORM);
+    EXPECT_EQ(attributes[2].offset, offsetof(Storage, normal));
+    expectAttributesInsideStride<NormalVertex>(0);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexLayout, ShippedQuantizedLayoutsMatchTheirStorage) {
+    constexpr auto full = FullVertex::getAttributeDescriptions();
+    constexpr auto half = HalfVertex::getAttributeDescriptions();
+    constexpr auto snorm = Snorm16Vertex::getAttributeDescriptions();
+    static_assert(full.size() == 2 && half.size() == 2 && snorm.size() == 2, "No shipped layout has a normal");
+
+    EXPECT_EQ(full[0].format, VK_FORMAT_R32G32_SFLOAT);
+    EXPECT_EQ(full[1].format, VK_FORMAT_R32G32B32_SFLOAT);
+    EXPECT_EQ(half[0].format, VK_FORMAT_R16G16_SFLOAT);
+    EXPECT_EQ(half[1].format, VK_FORMAT_R8G8B8A8_UNORM);
+    EXPECT_EQ(snorm[0].format, VK_FORMAT_R16G16_SNORM);
+    EXPECT_EQ(snorm[1].format, VK_FORMAT_R8G8B8A8_UNORM);
+    for (const auto* attributes : {&full, &half, &snorm}) {
+        EXPECT_EQ((*attributes)[0].location, 0u);
+        EXPECT_EQ((*attributes)[0].offset, 0u);
+        EXPECT_EQ((*attributes)[1].location, 1u);
+    }
+    EXPECT_EQ(half[1].offset, sizeof(Half2));
+    EXPECT_EQ(snorm[1].offset, sizeof(Snorm16x2));
+
+    expectAttributesInsideStride<FullVertex>(0);
+    expectAttributesInsideStride<HalfVertex>(0);
+    expectAttributesInsideStride<Snorm16Vertex>(0);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexLayout, LocationsChainPastMatrices) {
+    constexpr auto attributes = makeAttributeDescriptions(3, VERTEX_MEMBER_AT(ChainedVertex, normal, 4),
+                                                          VERTEX_MEMBER(ChainedVertex, transform),
+                                                          VERTEX_MEMBER(ChainedVertex, basis),
+                                                          VERTEX_MEMBER(ChainedVertex, uv));
+    static_assert(attributes.size() == 1 + 4 + 3 + 1, "Matrices take one location per column");
+
+    const uint32_t expectedLocations[] = {4, 5, 6, 7, 8, 9, 10, 11, 12};
+    for (size_t i = 0; i < attributes.size(); i++) {
+        EXPECT_EQ(attributes[i].location, expectedLocations[i]) << "attribute " << i;
+        EXPECT_EQ(attributes[i].binding, 3u) << "attribute " << i;
+    }
+    for (uint32_t column = 0; column < 4; column++) {
+        EXPECT_EQ(attributes[1 + column].offset, offsetof(ChainedVertex, transform) + column * sizeof(glm::vec4));
+    }
+    for (uint32_t column = 0; column < 3; column++) {
+        EXPECT_EQ(attributes[5 + column].format, VK_FORMAT_R32G32B32_SFLOAT);
+        EXPECT_EQ(attributes[5 + column].offset, offsetof(ChainedVertex, basis) + column * sizeof(glm::vec3));
+    }
+    EXPECT_EQ(attributes[8].offset, offsetof(ChainedVertex, uv));
+    EXPECT_EQ(makeBindingDescription<ChainedVertex>(3).stride, sizeof(ChainedVertex));
+}
+// ================================================================================
+// ================================================================================
+// eof
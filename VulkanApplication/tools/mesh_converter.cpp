@@ -0,0 +1,353 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh_converter.cpp
+// - Purpose: Offline converter from Wavefront OBJ to the binary mesh format read
+//            by MappedMeshFile.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "../include/mesh_file.hpp"
+#include "../include/mesh_optimizer.hpp"
+#include "../include/meshlet.hpp"
+#include "../include/vertex_formats.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct ObjMesh
+ * @brief Triangulated, de-duplicated geometry read from an OBJ file.
+ */
+struct ObjMesh {
+    std::vector<Vertex> vertices;   /**< One vertex per unique position and normal pair. */
+    std::vector<uint16_t> indices;  /**< Triangle list. */
+    std::vector<Meshlet> meshlets;  /**< Clusters of the triangle list, built after optimization. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Converts a one based, possibly negative, OBJ index to a zero based index.
+ *
+ * @return The zero based index, or -1 if the index is missing or out of range.
+ */
+static long resolveObjIndex(long index, size_t count) {
+    if (index > 0 && static_cast<size_t>(index) <= count) {
+        return index - 1;
+    }
+    if (index < 0 && static_cast<size_t>(-index) <= count) {
+        return static_cast<long>(count) + index;
+    }
+    return -1;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Parses the positions, vertex colors, normals and faces of an OBJ file.
+ *
+ * The application renders 2D vertices, so z is dropped. The color of a vertex is
+ * its OBJ vertex color when present, the absolute value of its normal when the
+ * face references one, and white otherwise. Polygons are triangulated as fans.
+ *
+ * @param text The contents of the OBJ file.
+ * @return The triangulated mesh.
+ * @throws std::runtime_error If a face is malformed or the mesh needs 32 bit indices.
+ */
+static ObjMesh parseObj(const std::string& text) {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> colors;
+    std::vector<bool> hasColor;
+    std::vector<glm::vec3> normals;
+    std::unordered_map<uint64_t, uint16_t> uniqueVertices;
+    ObjMesh mesh;
+
+    const char* cursor = text.c_str();
+    const char* end = cursor + text.size();
+    size_t lineNumber = 0;
+    std::vector<uint16_t> polygon;
+
+    while (cursor < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        lineNumber++;
+
+        if (cursor[0] == 'v' && cursor[1] == ' ') {
+            char* next = const_cast<char*>(cursor + 2);
+            float values[6];
+            int count = 0;
+            while (count < 6) {
+                char* parsed = next;
+                values[count] = std::strtof(next, &parsed);
+                if (parsed == next || parsed > lineEnd) {
+                    break;
+                }
+                next = parsed;
+                count++;
+            }
+            if (count < 3) {
+                throw std::runtime_error("Line " + std::to_string(lineNumber) + ": vertex needs three coordinates!");
+            }
+            positions.emplace_back(values[0], values[1], values[2]);
+            hasColor.push_back(count == 6);
+            colors.emplace_back(count == 6 ? glm::vec3(values[3], values[4], values[5]) : glm::vec3(1.0f));
+        } else if (cursor[0] == 'v' && cursor[1] == 'n' && cursor[2] == ' ') {
+            char* next = const_cast<char*>(cursor + 3);
+            float x = std::strtof(next, &next);
+            float y = std::strtof(next, &next);
+            float z = std::strtof(next, &next);
+            normals.emplace_back(x, y, z);
+        } else if (cursor[0] == 'f' && cursor[1] == ' ') {
+            polygon.clear();
+            char* next = const_cast<char*>(cursor + 2);
+            while (next < lineEnd) {
+                char* parsed = next;
+                long positionIndex = std::strtol(next, &parsed, 10);
+                if (parsed == next || parsed > lineEnd) {
+                    break;
+                }
+                next = parsed;
+
+                // Skip the texture coordinate and read the normal of v/vt/vn or v//vn
+                long normalIndex = 0;
+                if (*next == '/') {
+                    next++;
+                    if (*next != '/') {
+                        std::strtol(next, &next, 10);
+                    }
+                    if (*next == '/') {
+                        next++;
+                        normalIndex = std::strtol(next, &next, 10);
+                    }
+                }
+
+                long position = resolveObjIndex(positionIndex, positions.size());
+                long normal = normalIndex != 0 ? resolveObjIndex(normalIndex, normals.size()) : -1;
+                if (position < 0 || (normalIndex != 0 && normal < 0)) {
+                    throw std::runtime_error("Line " + std::to_string(lineNumber) + ": face index out of range!");
+                }
+
+                uint64_t key = (static_cast<uint64_t>(position) << 32) | static_cast<uint32_t>(normal + 1);
+                auto it = uniqueVertices.find(key);
+                if (it == uniqueVertices.end()) {
+                    if (mesh.vertices.size() > UINT16_MAX) {
+                        throw std::runtime_error("Mesh has more than 65536 unique vertices, which 16 bit "
+                                                 "indices cannot address!");
+                    }
+                    Vertex vertex;
+                    vertex.pos = glm::vec2(positions[position]);
+                    if (hasColor[position] || normal < 0) {
+                        vertex.color = colors[position];
+                    } else {
+                        vertex.color = glm::abs(normals[normal]);
+                    }
+                    it = uniqueVertices.emplace(key, static_cast<uint16_t>(mesh.vertices.size())).first;
+                    mesh.vertices.push_back(vertex);
+                }
+                polygon.push_back(it->second);
+            }
+
+            if (polygon.size() < 3) {
+                throw std::runtime_error("Line " + std::to_string(lineNumber) + ": face needs three vertices!");
+            }
+            for (size_t i = 1; i + 1 < polygon.size(); i++) {
+                mesh.indices.push_back(polygon[0]);
+                mesh.indices.push_back(polygon[i]);
+                mesh.indices.push_back(polygon[i + 1]);
+            }
+        }
+        cursor = lineEnd + 1;
+    }
+
+    if (mesh.indices.empty()) {
+        throw std::runtime_error("OBJ file contains no faces!");
+    }
+    return mesh;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Centers the mesh on the origin and scales it into [-1, 1].
+ *
+ * @param vertices The vertices to normalize in place.
+ * @return The scale that restores the original size, to be folded into the instance transform.
+ */
+static float normalizePositions(std::vector<Vertex>& vertices) {
+    glm::vec2 minPos = vertices[0].pos;
+    glm::vec2 maxPos = vertices[0].pos;
+    for (const Vertex& vertex : vertices) {
+        minPos = glm::min(minPos, vertex.pos);
+        maxPos = glm::max(maxPos, vertex.pos);
+    }
+    glm::vec2 center = 0.5f * (minPos + maxPos);
+    float extent = glm::max(maxPos.x - minPos.x, maxPos.y - minPos.y) * 0.5f;
+    float scale = extent > 0.0f ? extent : 1.0f;
+    for (Vertex& vertex : vertices) {
+        vertex.pos = (vertex.pos - center) / scale;
+    }
+    return scale;
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Computes the bounding sphere the same way MeshRegistry does for float vertices.
+ */
+static glm::vec4 computeBounds(const std::vector<Vertex>& vertices) {
+    glm::vec2 minPos = vertices[0].pos;
+    glm::vec2 maxPos = vertices[0].pos;
+    for (const Vertex& vertex : vertices) {
+        minPos = glm::min(minPos, vertex.pos);
+        maxPos = glm::max(maxPos, vertex.pos);
+    }
+    glm::vec2 center = 0.5f * (minPos + maxPos);
+    float radius = 0.0f;
+    for (const Vertex& vertex : vertices) {
+        radius = glm::max(radius, glm::length(vertex.pos - center));
+    }
+    return glm::vec4(center, 0.0f, radius);
+}
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Encodes the mesh in a vertex layout and writes it to disk.
+ *
+ * @tparam VertexT A QuantizedVertex instantiation.
+ * @return The number of bytes written.
+ */
+template <typename VertexT>
+static size_t writeAs(const std::string& filename, const ObjMesh& mesh) {
+    std::vector<VertexT> encoded = convertVertices<VertexT>(mesh.vertices);
+    constexpr auto attributes = VertexT::getAttributeDescriptions();
+
+    MeshFileContents contents;
+    contents.vertexStride = sizeof(VertexT);
+    contents.attributes = toMeshFileAttributes(attributes.data(), attributes.size());
+    contents.vertexData = encoded.data();
+    contents.vertexCount = static_cast<uint32_t>(encoded.size());
+    contents.indexData = mesh.indices.data();
+    contents.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    contents.meshletData = mesh.meshlets.data();
+    contents.meshletSize = mesh.meshlets.size() * sizeof(Meshlet);
+    contents.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+    contents.hasBounds = true;
+    contents.bounds = computeBounds(mesh.vertices);
+    return writeMeshFile(filename, contents);
+}
+// --------------------------------------------------------------------------------
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <input.obj> <output.vmesh> [--format float32|half|snorm16] [--normalize]"
+              << " [--overdraw] [--no-optimize]\n"
+              << "  --format       Vertex layout to store, must match the VERTEX_FORMAT of the application\n"
+              << "  --normalize    Center the mesh and scale it into [-1, 1], required by snorm16\n"
+              << "  --overdraw     Also order triangle clusters front to back for overdraw\n"
+              << "  --no-optimize  Keep the triangle and vertex order of the OBJ file\n";
+}
+// --------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string inputFile = argv[1];
+    std::string outputFile = argv[2];
+    std::string format = "float32";
+    bool normalize = false;
+    bool optimize = true;
+    bool overdraw = false;
+    for (int i = 3; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (argument == "--normalize") {
+            normalize = true;
+        } else if (argument == "--overdraw") {
+            overdraw = true;
+        } else if (argument == "--no-optimize") {
+            optimize = false;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (format != "float32" && format != "half" && format != "snorm16") {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::ifstream input(inputFile, std::ios::binary);
+        if (!input.is_open()) {
+            throw std::runtime_error("Failed to open " + inputFile + "!");
+        }
+        std::ostringstream buffer;
+        buffer << input.rdbuf();
+        std::string text = buffer.str();
+        ObjMesh mesh = parseObj(text);
+        auto parsed = std::chrono::high_resolution_clock::now();
+
+        if (normalize) {
+            float scale = normalizePositions(mesh.vertices);
+            std::cout << "Normalized positions, scale instances by " << scale << " to restore the original size\n";
+        }
+
+        if (optimize) {
+            MeshOptimizationReport report = optimizeMesh(mesh.vertices, mesh.indices, overdraw);
+            std::cout << std::fixed << std::setprecision(3)
+                      << "ACMR " << report.before.acmr << " -> " << report.after.acmr
+                      << ", ATVR " << report.before.atvr << " -> " << report.after.atvr
+                      << (overdraw ? (report.overdrawApplied ? ", overdraw order applied\n"
+                                                             : ", overdraw order rejected\n")
+                                   : "\n");
+        }
+        mesh.meshlets = buildMeshlets(mesh.indices, positionsOf(mesh.vertices));
+
+        size_t written = 0;
+        if (format == "half") {
+            written = writeAs<HalfVertex>(outputFile, mesh);
+        } else if (format == "snorm16") {
+            written = writeAs<Snorm16Vertex>(outputFile, mesh);
+        } else {
+            written = writeAs<FullVertex>(outputFile, mesh);
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+
+        double parseSeconds = std::chrono::duration<double>(parsed - start).count();
+        double totalSeconds = std::chrono::duration<double>(stop - start).count();
+        std::cout << std::fixed << std::setprecision(1)
+                  << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3 << " triangles, "
+                  << mesh.meshlets.size() << " meshlets\n"
+                  << "Parsed " << text.size() / 1.0e6 << " MB of OBJ at " << text.size() / 1.0e6 / parseSeconds
+                  << " MB/s\n"
+                  << "Wrote " << written / 1.0e6 << " MB to " << outputFile << " in "
+                  << totalSeconds * 1.0e3 << " ms\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,163 @@
+// ================================================================================
+// ================================================================================
+// - File:    vertex_formats.cpp
+// - Purpose: This file contains the scalar encoders used by the quantized vertex
+//            layouts.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 16, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/vertex_formats.hpp"
+
+#include <cmath>
+#include <cstring>  // memcpy
+#include <stdexcept>
+#include <string>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Returns 1 for non-negative values and -1 otherwise, so zero never collapses a fold.
+ */
+static float signNotZero(float value) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+// ================================================================================
+// ================================================================================
+
+
+uint16_t packHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t floatExponent = (bits >> 23) & 0xffu;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    // Infinity stays infinity and NaN stays a quiet NaN
+    if (floatExponent == 0xffu) {
+        return static_cast<uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x200u : 0u));
+    }
+
+    int32_t exponent = static_cast<int32_t>(floatExponent) - 127 + 15;
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+
+    if (exponent <= 0) {
+        // The result is subnormal, or rounds to zero when even the implicit bit is shifted out
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway = 1u << (shift - 1u);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // A carry out of the mantissa correctly bumps the exponent, up to infinity
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+        half++;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+// --------------------------------------------------------------------------------
+
+float unpackHalf(uint16_t bits) {
+    uint32_t sign = static_cast<uint32_t>(bits & 0x8000u) << 16;
+    uint32_t exponent = (bits >> 10) & 0x1fu;
+    uint32_t mantissa = bits & 0x3ffu;
+
+    uint32_t result;
+    if (exponent == 0x1fu) {
+        result = sign | 0x7f800000u | (mantissa << 13);
+    } else if (exponent != 0) {
+        result = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        result = sign;
+    } else {
+        // Normalize the subnormal half into a normal float
+        exponent = 127 - 15 + 1;
+        while ((mantissa & 0x400u) == 0) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        result = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+    }
+
+    float value;
+    memcpy(&value, &result, sizeof(value));
+    return value;
+}
+// --------------------------------------------------------------------------------
+
+int16_t packSnorm16(float value) {
+    float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<int16_t>(std::lround(clamped * 32767.0f));
+}
+// --------------------------------------------------------------------------------
+
+int8_t packSnorm8(float value) {
+    float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<int8_t>(std::lround(clamped * 127.0f));
+}
+// --------------------------------------------------------------------------------
+
+uint8_t packUnorm8(float value) {
+    float clamped = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<uint8_t>(std::lround(clamped * 255.0f));
+}
+// --------------------------------------------------------------------------------
+
+glm::vec2 encodeOctahedral(const glm::vec3& normal) {
+    float l1 = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    if (l1 == 0.0f) {
+        return glm::vec2(0.0f, 0.0f);
+    }
+
+    glm::vec2 projected(normal.x / l1, normal.y / l1);
+    if (normal.z < 0.0f) {
+        // Fold the lower hemisphere over the diagonals of the square
+        return glm::vec2((1.0f - std::fabs(projected.y)) * signNotZero(projected.x),
+                         (1.0f - std::fabs(projected.x)) * signNotZero(projected.y));
+    }
+    return projected;
+}
+// --------------------------------------------------------------------------------
+
+glm::vec3 decodeOctahedral(const glm::vec2& encoded) {
+    glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::fabs(encoded.x) - std::fabs(encoded.y));
+    if (normal.z < 0.0f) {
+        float x = normal.x;
+        normal.x = (1.0f - std::fabs(normal.y)) * signNotZero(x);
+        normal.y = (1.0f - std::fabs(x)) * signNotZero(normal.y);
+    }
+    return glm::normalize(normal);
+}
+// --------------------------------------------------------------------------------
+
+void validateSnormPositions(const std::vector<Vertex>& vertices) {
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const glm::vec2& pos = vertices[i].pos;
+        if (std::fabs(pos.x) > 1.0f || std::fabs(pos.y) > 1.0f) {
+            throw std::invalid_argument("Vertex " + std::to_string(i) +
+                                        " lies outside the [-1, 1] range of snorm16 positions!");
+        }
+    }
+}
+// ================================================================================
+// ================================================================================
+// eof